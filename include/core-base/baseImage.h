@@ -507,6 +507,11 @@ namespace ml {
 			return m_width*m_height;
 		}
 
+		//! Returns the number of bytes held by the image
+		size_t memoryFootprint() const {
+			return sizeof(*this) + (m_data ? (size_t)m_width * m_height * sizeof(T) : 0);
+		}
+
 		//! Returns the image data (linearized array)
 		const T* getData() const {
 			return m_data;
@@ -937,6 +942,7 @@ namespace ml {
 		void create(unsigned int width, unsigned int height) {
 			m_width = width;
 			m_height = height;
+			MLIB_MEMORY_SCOPE(MEMORY_IMAGE);
 			m_data = new T[m_height * m_width];
 		}
 
@@ -75,6 +75,7 @@ namespace ml {
 				m_dimZ = depth;
 
 				size_t dataSize = getNumUInts();
+				MLIB_MEMORY_SCOPE(MEMORY_GRID);
 				m_data = new unsigned int[dataSize];
 			}
 		}
@@ -210,6 +211,11 @@ namespace ml {
 			return m_dimX*m_dimY*m_dimZ;
 		}
 
+		//! bytes held by the grid
+		size_t memoryFootprint() const {
+			return sizeof(*this) + (m_data ? getNumUInts() * sizeof(unsigned int) : 0);
+		}
+
 		inline bool isValidCoordinate(size_t x, size_t y, size_t z) const
 		{
 			return (x < m_dimX && y < m_dimY && z < m_dimZ);
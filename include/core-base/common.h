@@ -30,6 +30,11 @@
 #define _USE_MATH_DEFINES
 #endif
 
+//SSE2 is available on all x64 targets; enables the SIMD code paths
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MLIB_SSE
+#endif
+
 #include <cmath>
 #include <cstring>
 #include <exception>
@@ -44,6 +49,10 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <deque>
 #include <map>
 #include <unordered_set>
 #include <unordered_map>
@@ -59,6 +68,10 @@
 #include <random>
 #include <iomanip>
 
+#ifdef MLIB_SSE
+#include <emmintrin.h>
+#endif
+
 
 namespace boost {
 namespace serialization {
@@ -84,6 +97,13 @@ namespace ml
 #define NOEXCEPT
 #endif
 
+//! thread-local storage for trivial types (thread_local is not available on all supported compilers)
+#ifdef _WIN32
+#define MLIB_THREAD_LOCAL __declspec(thread)
+#else
+#define MLIB_THREAD_LOCAL __thread
+#endif
+
 class MLibException : public std::exception {
 public:
 	MLibException(const std::string& what) : std::exception() {
@@ -37,14 +37,50 @@ namespace ml {
 			return grid;
 		}
 
-		void generateFromBinaryGrid(const BinaryGrid3& grid, FloatType trunc = std::numeric_limits<FloatType>::infinity()) {
+		//! exact Euclidean distances (in voxels) to the set voxels of grid; voxels farther than trunc are set to infinity.
+		//! With signedDistance, grid is a solid voxelization (e.g., TriMesh::voxelize with solid = true) and the distances are to the
+		//! boundary halfway between inside and outside voxel centers: positive outside, negative inside (-infinity beyond trunc)
+		void generateFromBinaryGrid(const BinaryGrid3& grid, FloatType trunc = std::numeric_limits<FloatType>::infinity(), bool signedDistance = false) {
 			this->allocate(grid.getDimX(), grid.getDimY(), grid.getDimZ());
 
 			m_truncation = trunc;
 
-			//the simple variant appears to be much faster
-			generateFromBinaryGridSimple(grid, trunc);
-			//generateFromBinaryGridQueue(grid);
+			if (signedDistance) generateSignedFromSolidGrid(grid, trunc);
+			else generateFromBinaryGridExact(grid, trunc);
+		}
+
+		//! exact distances to a mesh (in voxels, up to trunc) using a closest point query, e.g., of TriMeshAcceleratorBVH; replaces voxelizing the mesh
+		//! and calling generateFromBinaryGrid; worldToVoxel maps mesh to voxel coordinates (voxel centers at integer coordinates, as in TriMesh::voxelize)
+		//! and must be a similarity transform; signed distances (negative inside) require a closed mesh; the field must be allocated
+		template<class Accelerator>
+		void generateFromMesh(const Accelerator& accel, const Matrix4x4<FloatType>& worldToVoxel, FloatType trunc = std::numeric_limits<FloatType>::infinity(), bool signedDistance = false) {
+			if (this->getNumElements() == 0) throw MLIB_EXCEPTION("distance field is not allocated");
+
+			m_truncation = trunc;
+			const Matrix4x4<FloatType> voxelToWorld = worldToVoxel.getInverse();
+			const FloatType voxelSize = (voxelToWorld * vec3<FloatType>((FloatType)1, (FloatType)0, (FloatType)0) - voxelToWorld * vec3<FloatType>::origin).length();
+
+			//the sign of voxels beyond the truncation is only known after an unbounded search
+			const FloatType maxDist = (signedDistance || trunc == std::numeric_limits<FloatType>::infinity()) ? std::numeric_limits<FloatType>::max() : trunc * voxelSize;
+
+			size_t numZeroVoxels = 0;
+#ifdef MLIB_OPENMP
+#pragma omp parallel for reduction(+:numZeroVoxels)
+#endif
+			for (int z = 0; z < (int)this->getDimZ(); z++) {
+				for (size_t y = 0; y < this->getDimY(); y++) {
+					for (size_t x = 0; x < this->getDimX(); x++) {
+						const vec3<FloatType> p = voxelToWorld * vec3<FloatType>((FloatType)x, (FloatType)y, (FloatType)z);
+						const auto cp = accel.closestPoint(p, signedDistance, maxDist);
+						FloatType d = cp.isValid() ? cp.distance / voxelSize : trunc;
+						if (d > trunc) d = trunc;
+						else if (d < -trunc) d = -trunc;
+						(*this)(x, y, (size_t)z) = d;
+						if (std::abs(d) <= (FloatType)0.5) numZeroVoxels++;
+					}
+				}
+			}
+			m_numZeroVoxels = numZeroVoxels;
 		}
 
 		//! computes the distance when projecting all grid points into the distance field (returns distance and valid comparisons)
@@ -70,9 +106,9 @@ namespace ml {
 			bbBox.setMax(math::min(bbBox.getMax() + 1, vec3i(grid.getDimensions())));
 
 
-			for (size_t z = bbBox.getMinZ(); z < bbBox.getMaxZ(); z++) {
-				for (size_t y = bbBox.getMinY(); y < bbBox.getMaxY(); y++) {
-					for (size_t x = bbBox.getMinZ(); x < bbBox.getMaxX(); x++) {
+			for (size_t z = bbBox.getMinZ(); z < (size_t)bbBox.getMaxZ(); z++) {
+				for (size_t y = bbBox.getMinY(); y < (size_t)bbBox.getMaxY(); y++) {
+					for (size_t x = bbBox.getMinX(); x < (size_t)bbBox.getMaxX(); x++) {
 						vec3<FloatType> p = gridToDF * vec3<FloatType>((FloatType)x, (FloatType)y, (FloatType)z);
 						vec3ul pi(math::round(p));
 						if (this->isValidCoordinate(pi.x, pi.y, pi.z)) {
@@ -199,6 +235,125 @@ namespace ml {
 
 	private:
 
+		//! squared distance transform along a line of n values with the given stride (Felzenszwalb and Huttenlocher, "Distance Transforms
+		//! of Sampled Functions"): f[i] = min_j f[j] + (i - j)^2 as the lower envelope of the parabolas rooted at the finite f[j]; results
+		//! above maxSq become infinity (they can only grow in later passes); negative values are fixed sources: they act as zeros and are
+		//! not overwritten; values, sites and boundaries are scratch space of n (n + 1) entries
+		static void transformLine(FloatType* f, size_t n, size_t stride, double maxSq, double* values, int* sites, double* boundaries) {
+			const double inf = std::numeric_limits<double>::infinity();
+			int k = -1;
+			for (int q = 0; q < (int)n; q++) {
+				values[q] = std::max((double)f[q * stride], 0.0);
+				if (values[q] == inf) continue;
+				double s = -inf;
+				while (k >= 0) {
+					const int v = sites[k];
+					s = ((values[q] + (double)q * q) - (values[v] + (double)v * v)) / (2.0 * (q - v));
+					if (s > boundaries[k]) break;
+					k--;
+				}
+				if (k < 0) s = -inf;
+				k++;
+				sites[k] = q;
+				boundaries[k] = s;
+			}
+			if (k < 0) return;	//no finite value: all stay infinite
+			boundaries[k + 1] = inf;
+
+			int j = 0;
+			for (int q = 0; q < (int)n; q++) {
+				while (boundaries[j + 1] < (double)q) j++;
+				if (f[q * stride] < (FloatType)0) continue;
+				const double d = (double)(q - sites[j]) * (q - sites[j]) + values[sites[j]];
+				f[q * stride] = d > maxSq ? std::numeric_limits<FloatType>::infinity() : (FloatType)d;
+			}
+		}
+
+		//! squared distances to the voxels with a zero (or a negative value, see transformLine) in this field, in place; all others must be
+		//! infinity; the squared distances are integers, which float represents exactly up to 2^24; one pass along x, y and z each, parallel over the lines
+		void squaredDistanceTransform(double maxSq) {
+			const size_t dim[3] = { this->getDimX(), this->getDimY(), this->getDimZ() };
+			const size_t stride[3] = { 1, dim[0], dim[0] * dim[1] };
+			for (int axis = 0; axis < 3; axis++) {
+				//lines along axis are indexed by the other two coordinates (a, b)
+				const int axisA = axis == 0 ? 1 : 0;
+				const int axisB = axis == 2 ? 1 : 2;
+				const size_t n = dim[axis];
+#ifdef MLIB_OPENMP
+#pragma omp parallel
+#endif
+				{
+					std::vector<double> values(n);
+					std::vector<int> sites(n);
+					std::vector<double> boundaries(n + 1);
+#ifdef MLIB_OPENMP
+#pragma omp for
+#endif
+					for (int b = 0; b < (int)dim[axisB]; b++) {
+						for (size_t a = 0; a < dim[axisA]; a++) {
+							FloatType* line = this->getData() + a * stride[axisA] + b * stride[axisB];
+							transformLine(line, n, stride[axis], maxSq, values.data(), sites.data(), boundaries.data());
+						}
+					}
+				}
+			}
+		}
+
+		void generateFromBinaryGridExact(const BinaryGrid3& grid, FloatType trunc) {
+			const FloatType inf = std::numeric_limits<FloatType>::infinity();
+			m_numZeroVoxels = 0;
+			for (size_t z = 0; z < grid.getDimZ(); z++) {
+				for (size_t y = 0; y < grid.getDimY(); y++) {
+					for (size_t x = 0; x < grid.getDimX(); x++) {
+						const bool set = grid.isVoxelSet(x, y, z);
+						(*this)(x, y, z) = set ? (FloatType)0 : inf;
+						if (set) m_numZeroVoxels++;
+					}
+				}
+			}
+
+			squaredDistanceTransform((double)trunc * (double)trunc);
+
+			for (size_t i = 0; i < this->getNumElements(); i++) {
+				this->getData()[i] = std::sqrt(this->getData()[i]);
+			}
+		}
+
+		//! outside voxels get the distance to the nearest inside voxel minus half a voxel, inside voxels the negated distance to the nearest outside voxel minus half a voxel;
+		//! the squared outside distances are kept negated during the inside pass, where they serve as its sources
+		void generateSignedFromSolidGrid(const BinaryGrid3& solid, FloatType trunc) {
+			const FloatType inf = std::numeric_limits<FloatType>::infinity();
+			const double maxDist = (double)trunc + 0.5;
+			for (size_t z = 0; z < solid.getDimZ(); z++) {
+				for (size_t y = 0; y < solid.getDimY(); y++) {
+					for (size_t x = 0; x < solid.getDimX(); x++) {
+						(*this)(x, y, z) = solid.isVoxelSet(x, y, z) ? (FloatType)0 : inf;
+					}
+				}
+			}
+			squaredDistanceTransform(maxDist * maxDist);
+
+			for (size_t z = 0; z < solid.getDimZ(); z++) {
+				for (size_t y = 0; y < solid.getDimY(); y++) {
+					for (size_t x = 0; x < solid.getDimX(); x++) {
+						FloatType& v = (*this)(x, y, z);
+						v = solid.isVoxelSet(x, y, z) ? inf : -v;
+					}
+				}
+			}
+			squaredDistanceTransform(maxDist * maxDist);
+
+			m_numZeroVoxels = 0;
+			for (size_t i = 0; i < this->getNumElements(); i++) {
+				FloatType& v = this->getData()[i];
+				FloatType d = std::sqrt(std::abs(v)) - (FloatType)0.5;
+				if (d > trunc) d = inf;
+				v = v < (FloatType)0 ? d : -d;
+				if (std::abs(v) <= (FloatType)0.5) m_numZeroVoxels++;
+			}
+		}
+
+		//! approximate distances by chamfer sweeps over the 3x3x3 neighborhood (generateFromBinaryGridExact is exact and faster)
 		void generateFromBinaryGridSimple(const BinaryGrid3& grid, FloatType trunc) {
 
 			FloatType kernel[3][3][3];
@@ -15,6 +15,7 @@ namespace ml
 	{
 		m_dimX = dimX;
 		m_dimY = dimY;
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
 		m_data = new T[dimX * dimY];
 	}
 
@@ -22,6 +23,7 @@ namespace ml
 	{
 		m_dimX = dimX;
 		m_dimY = dimY;
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
 		m_data = new T[dimX * dimY];
 		setValues(value);
 	}
@@ -32,6 +34,7 @@ namespace ml
 		m_dimY = grid.m_dimY;
 		
 		const size_t totalEntries = getNumElements();
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
 		m_data = new T[totalEntries];
 		for (size_t i = 0; i < totalEntries; i++)
 			m_data[i] = grid.m_data[i];
@@ -48,6 +51,7 @@ namespace ml
 	{
 		m_dimX = dimX;
 		m_dimY = dimY;
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
 		m_data = new T[dimX * dimY];
 		fill(fillFunction);
 	}
@@ -64,6 +68,7 @@ namespace ml
 		m_dimY = grid.m_dimY;
 
 		const size_t totalEntries = m_dimX * m_dimY;
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
 		m_data = new T[totalEntries];
 		for (size_t i = 0; i < totalEntries; i++)
 			m_data[i] = grid.m_data[i];
@@ -87,6 +92,7 @@ namespace ml
 			m_dimX = dimX;
 			m_dimY = dimY;
 			SAFE_DELETE_ARRAY(m_data);
+			MLIB_MEMORY_SCOPE(MEMORY_GRID);
 			m_data = new T[dimX * dimY];
 		}
 	}
@@ -70,6 +70,11 @@ namespace ml
 			return m_dimX * m_dimY;
 		}
 
+		//! bytes held by the grid
+		size_t memoryFootprint() const {
+			return sizeof(*this) + (m_data ? getNumElements() * sizeof(T) : 0);
+		}
+
 		inline bool isSquare() const	{
 			return (m_dimX == m_dimY);
 		}
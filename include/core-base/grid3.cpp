@@ -5,72 +5,82 @@
 namespace ml
 {
 
-	template <class T> Grid3<T>::Grid3()
+	template <class T, class Layout> Grid3<T, Layout>::Grid3()
 	{
 		m_dimX = m_dimY = m_dimZ = 0;
 		m_data = nullptr;
 	}
 
-	template <class T> Grid3<T>::Grid3(size_t dimX, size_t dimY, size_t dimZ)
+	template <class T, class Layout> Grid3<T, Layout>::Grid3(size_t dimX, size_t dimY, size_t dimZ)
 	{
 		m_dimX = dimX;
 		m_dimY = dimY;
 		m_dimZ = dimZ;
-		m_data = new T[dimX * dimY * dimZ];
+		m_layout.init(dimX, dimY, dimZ);
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
+		m_data = new T[m_layout.getStorageSize()];
 	}
 
-	template <class T> Grid3<T>::Grid3(size_t dimX, size_t dimY, size_t dimZ, const T& value)
+	template <class T, class Layout> Grid3<T, Layout>::Grid3(size_t dimX, size_t dimY, size_t dimZ, const T& value)
 	{
 		m_dimX = dimX;
 		m_dimY = dimY;
 		m_dimZ = dimZ;
-		m_data = new T[dimX * dimY * dimZ];
+		m_layout.init(dimX, dimY, dimZ);
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
+		m_data = new T[m_layout.getStorageSize()];
 		setValues(value);
 	}
 
-	template <class T> Grid3<T>::Grid3(const Grid3<T>& grid)
+	template <class T, class Layout> Grid3<T, Layout>::Grid3(const Grid3<T, Layout>& grid)
 	{
 		m_dimX = grid.m_dimX;
 		m_dimY = grid.m_dimY;
 		m_dimZ = grid.m_dimZ;
+		m_layout = grid.m_layout;
 
-		const size_t totalEntries = getNumElements();
+		const size_t totalEntries = getNumStorageElements();
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
 		m_data = new T[totalEntries];
 		for (size_t i = 0; i < totalEntries; i++) {
 			m_data[i] = grid.m_data[i];
 		}
 	}
 
-	template <class T> Grid3<T>::Grid3(Grid3<T> &&grid)
+	template <class T, class Layout> Grid3<T, Layout>::Grid3(Grid3<T, Layout> &&grid)
 	{
 		m_dimX = m_dimY = m_dimZ = 0;
 		m_data = nullptr;
 		swap(*this, grid);
 	}
 
-	template <class T> Grid3<T>::Grid3(size_t dimX, size_t dimY, size_t dimZ, const std::function< T(size_t, size_t, size_t) > &fillFunction)
+	template <class T, class Layout> Grid3<T, Layout>::Grid3(size_t dimX, size_t dimY, size_t dimZ, const std::function< T(size_t, size_t, size_t) > &fillFunction)
 	{
 		m_dimX = dimX;
 		m_dimY = dimY;
-		m_dimY = dimZ;
-		m_data = new T[dimX * dimY * dimZ];
+		m_dimZ = dimZ;
+		m_layout.init(dimX, dimY, dimZ);
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
+		m_data = new T[m_layout.getStorageSize()];
 		fill(fillFunction);
 	}
 
-	template <class T> Grid3<T>::~Grid3()
+	template <class T, class Layout> Grid3<T, Layout>::~Grid3()
 	{
 		SAFE_DELETE_ARRAY(m_data);
 	}
 
 
-	template <class T> Grid3<T>& Grid3<T>::operator=(const Grid3<T> &grid)
+	template <class T, class Layout> Grid3<T, Layout>& Grid3<T, Layout>::operator=(const Grid3<T, Layout> &grid)
 	{
 		SAFE_DELETE_ARRAY(m_data);
 		m_dimX = grid.m_dimX;
 		m_dimY = grid.m_dimY;
 		m_dimZ = grid.m_dimZ;
+		m_layout = grid.m_layout;
 
-		const size_t totalEntries = getNumElements();
+		const size_t totalEntries = getNumStorageElements();
+		MLIB_MEMORY_SCOPE(MEMORY_GRID);
 		m_data = new T[totalEntries];
 		for (size_t i = 0; i < totalEntries; i++) {
 			m_data[i] = grid.m_data[i];
@@ -79,13 +89,13 @@ namespace ml
 		return *this;
 	}
 
-	template <class T> Grid3<T>& Grid3<T>::operator=(Grid3<T> &&grid)
+	template <class T, class Layout> Grid3<T, Layout>& Grid3<T, Layout>::operator=(Grid3<T, Layout> &&grid)
 	{
 		swap(*this, grid);
 		return *this;
 	}
 
-	template <class T> void Grid3<T>::allocate(size_t dimX, size_t dimY, size_t dimZ)
+	template <class T, class Layout> void Grid3<T, Layout>::allocate(size_t dimX, size_t dimY, size_t dimZ)
 	{
 		if (dimX == 0 || dimY == 0 || dimZ == 0) {
 			SAFE_DELETE_ARRAY(m_data);
@@ -94,24 +104,26 @@ namespace ml
 			m_dimX = dimX;
 			m_dimY = dimY;
 			m_dimZ = dimZ;
+			m_layout.init(dimX, dimY, dimZ);
 			SAFE_DELETE_ARRAY(m_data);
-			m_data = new T[dimX * dimY * dimZ];
+			MLIB_MEMORY_SCOPE(MEMORY_GRID);
+			m_data = new T[m_layout.getStorageSize()];
 		}
 	}
 
-	template <class T> void Grid3<T>::allocate(size_t dimX, size_t dimY, size_t dimZ, const T& value)
+	template <class T, class Layout> void Grid3<T, Layout>::allocate(size_t dimX, size_t dimY, size_t dimZ, const T& value)
 	{
 		allocate(dimX, dimY, dimZ);
 		setValues(value);
 	}
 
-	template <class T> void Grid3<T>::setValues(const T &value)
+	template <class T, class Layout> void Grid3<T, Layout>::setValues(const T &value)
 	{
-		const size_t totalEntries = getNumElements();
+		const size_t totalEntries = getNumStorageElements();
 		for (size_t i = 0; i < totalEntries; i++) m_data[i] = value;
 	}
 
-	template <class T> void Grid3<T>::fill(const std::function<T(size_t x, size_t y, size_t z)> &fillFunction)
+	template <class T, class Layout> void Grid3<T, Layout>::fill(const std::function<T(size_t x, size_t y, size_t z)> &fillFunction)
 	{
 		for (size_t z = 0; z < m_dimZ; z++)
 			for (size_t y = 0; y < m_dimY; y++)
@@ -121,7 +133,7 @@ namespace ml
 
 
 
-	template <class T> vec3ul Grid3<T>::getMaxIndex() const
+	template <class T, class Layout> vec3ul Grid3<T, Layout>::getMaxIndex() const
 	{
 		vec3ul maxIndex(0, 0, 0);
 		const T *maxValue = m_data;
@@ -139,13 +151,13 @@ namespace ml
 		return maxIndex;
 	}
 
-	template <class T> const T& Grid3<T>::getMaxValue() const
+	template <class T, class Layout> const T& Grid3<T, Layout>::getMaxValue() const
 	{
 		vec3ul index = getMaxIndex();
 		return (*this)(index);
 	}
 
-	template <class T> vec3ul Grid3<T>::getMinIndex() const
+	template <class T, class Layout> vec3ul Grid3<T, Layout>::getMinIndex() const
 	{
 		vec3ul minIndex(0, 0, 0);
 		const T *minValue = &m_data[0];
@@ -163,7 +175,7 @@ namespace ml
 		return minIndex;
 	}
 
-	template <class T> const T& Grid3<T>::getMinValue() const
+	template <class T, class Layout> const T& Grid3<T, Layout>::getMinValue() const
 	{
 		vec3ul index = getMinIndex();
 		return (*this)(index);
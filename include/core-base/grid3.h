@@ -5,7 +5,8 @@
 namespace ml
 {
 
-	template <class T> class Grid3
+	//! dense grid of dimX * dimY * dimZ cells; the memory layout (see grid3Layout.h) is Grid3LayoutLinear by default
+	template <class T, class Layout = Grid3LayoutLinear> class Grid3
 	{
 	public:
 		Grid3();
@@ -14,8 +15,8 @@ namespace ml
 		Grid3(const vec3ul& dim) : Grid3(dim.x, dim.y, dim.z) {}
 		Grid3(const vec3ul& dim, const T& value) : Grid3(dim.x, dim.y, dim.z, value) {}
 
-		Grid3(const Grid3<T> &grid);
-		Grid3(Grid3<T> &&grid);
+		Grid3(const Grid3 &grid);
+		Grid3(Grid3 &&grid);
 		Grid3(size_t dimX, size_t dimY, size_t dimZ, const std::function< T(size_t x, size_t y, size_t z) > &fillFunction);
 
 		~Grid3();
@@ -25,11 +26,12 @@ namespace ml
 			std::swap(a.m_dimX, b.m_dimX);
 			std::swap(a.m_dimY, b.m_dimY);
 			std::swap(a.m_dimZ, b.m_dimZ);
+			std::swap(a.m_layout, b.m_layout);
 			std::swap(a.m_data, b.m_data);
 		}
 
-		Grid3<T>& operator=(const Grid3<T>& grid);
-		Grid3<T>& operator=(Grid3<T>&& grid);
+		Grid3& operator=(const Grid3& grid);
+		Grid3& operator=(Grid3&& grid);
 
 		void allocate(size_t dimX, size_t dimY, size_t dimZ);
 		void allocate(size_t dimX, size_t dimY, size_t dimZ, const T &value);
@@ -41,12 +43,12 @@ namespace ml
 		//
 		inline T& operator() (size_t x, size_t y, size_t z)	{
 			MLIB_ASSERT(x < getDimX() && y < getDimY() && z < getDimZ());
-			return m_data[getDimX()*getDimY()*z + getDimX()*y + x];
+			return m_data[m_layout.getIndex(x, y, z)];
 		}
 
 		inline const T& operator() (size_t x, size_t y, size_t z) const	{
 			MLIB_ASSERT(x < getDimX() && y < getDimY() && z < getDimZ());
-			return m_data[getDimX()*getDimY()*z + getDimX()*y + x];
+			return m_data[m_layout.getIndex(x, y, z)];
 		}
 
 		inline T& operator() (const vec3ul& coord)	{
@@ -74,10 +76,23 @@ namespace ml
 		size_t getNumElements() const {
 			return m_dimX * m_dimY * m_dimZ;
 		}
+		//! elements of getData(), including the padding of tiled and Morton layouts
+		size_t getNumStorageElements() const {
+			return m_layout.getStorageSize();
+		}
+		const Layout& getLayout() const {
+			return m_layout;
+		}
+
+		//! bytes held by the grid
+		size_t memoryFootprint() const {
+			return sizeof(*this) + (m_data ? getNumStorageElements() * sizeof(T) : 0) + m_layout.memoryFootprint();
+		}
 
 		inline bool isSquare() const	{
 			return (m_dimX == m_dimY && m_dimY == m_dimZ);
 		}
+		//! the cells in the order of the layout (x fastest, then y, then z for Grid3LayoutLinear)
 		inline T* getData()	{
 			return m_data;
 		}
@@ -85,36 +100,36 @@ namespace ml
 			return m_data;
 		}
 
-		inline Grid3<T>& operator += (const Grid3<T>& right)
+		inline Grid3& operator += (const Grid3& right)
 		{
 			MLIB_ASSERT(getDimensions() == right.getDimensions());
-			const size_t numElements = getNumElements();
+			const size_t numElements = getNumStorageElements();
 			for (size_t i = 0; i < numElements; i++) {
 				m_data[i] += right.m_data[i];
 			}
 			return *this;
 		}
-		inline Grid3<T>& operator += (T value)
+		inline Grid3& operator += (T value)
 		{
-			const size_t numElements = getNumElements();
+			const size_t numElements = getNumStorageElements();
 			for (size_t i = 0; i < numElements; i++) {
 				m_data[i] += value;
 			}
 			return *this;
 		}
-		inline Grid3<T>& operator *= (T value)
+		inline Grid3& operator *= (T value)
 		{
-			const size_t numElements = getNumElements();
+			const size_t numElements = getNumStorageElements();
 			for (size_t i = 0; i < numElements; i++) {
 				m_data[i] *= value;
 			}
 			return *this;
 		}
 
-		inline Grid3<T> operator * (T value)
+		inline Grid3 operator * (T value)
 		{
-			Grid3<T> result(m_dimX, m_dimY, m_dimZ);
-			const size_t numElements = getNumElements();
+			Grid3 result(m_dimX, m_dimY, m_dimZ);
+			const size_t numElements = getNumStorageElements();
 			for (size_t i = 0; i < numElements; i++) {
 				result.m_data[i] = m_data[i] * value;
 			}
@@ -195,7 +210,7 @@ namespace ml
 
 		struct iterator
 		{
-			iterator(Grid3<T> *_grid)
+			iterator(Grid3 *_grid)
 			{
 				x = 0;
 				y = 0;
@@ -253,12 +268,12 @@ namespace ml
 			size_t x, y, z;
 
 		private:
-			Grid3<T> *grid;
+			Grid3 *grid;
 		};
 
 		struct constIterator
 		{
-			constIterator(const Grid3<T> *_grid)
+			constIterator(const Grid3 *_grid)
 			{
 				x = 0;
 				y = 0;
@@ -316,7 +331,7 @@ namespace ml
 			size_t x, y, z;
 
 		private:
-			const Grid3<T> *grid;
+			const Grid3 *grid;
 		};
 
 
@@ -340,14 +355,98 @@ namespace ml
             return constIterator(NULL);
         }
 
+		//
+		// Grid3 blocks: boxes of the layout's block dimensions (clipped at the grid border) that are contiguous in memory.
+		// Visiting the cells block by block, e.g.,
+		//	for (const auto& block : grid.getBlocks())
+		//		for (size_t z = block.min.z; z < block.max.z; z++) ...
+		// or in parallel over getNumBlocks() with getBlock, keeps neighborhood operations local in the tiled and Morton layouts.
+		//
+		struct Block
+		{
+			vec3ul min;		//! first cell
+			vec3ul max;		//! one past the last cell
+		};
+
+		inline vec3ul getNumBlocksPerAxis() const {
+			if (getNumElements() == 0) return vec3ul(0, 0, 0);
+			const vec3ul blockDim = m_layout.getBlockDimensions();
+			return vec3ul((m_dimX + blockDim.x - 1) / blockDim.x, (m_dimY + blockDim.y - 1) / blockDim.y, (m_dimZ + blockDim.z - 1) / blockDim.z);
+		}
+		inline size_t getNumBlocks() const {
+			const vec3ul numBlocks = getNumBlocksPerAxis();
+			return numBlocks.x * numBlocks.y * numBlocks.z;
+		}
+		//! blocks are numbered x fastest, then y, then z
+		inline Block getBlock(size_t index) const {
+			const vec3ul numBlocks = getNumBlocksPerAxis();
+			const vec3ul blockDim = m_layout.getBlockDimensions();
+			Block block;
+			block.min = vec3ul(index % numBlocks.x * blockDim.x, index / numBlocks.x % numBlocks.y * blockDim.y, index / (numBlocks.x * numBlocks.y) * blockDim.z);
+			block.max = vec3ul(std::min(block.min.x + blockDim.x, m_dimX), std::min(block.min.y + blockDim.y, m_dimY), std::min(block.min.z + blockDim.z, m_dimZ));
+			return block;
+		}
+
+		struct blockIterator
+		{
+			blockIterator(const Grid3 *_grid, size_t _index) : grid(_grid), index(_index) {}
+			blockIterator& operator++()
+			{
+				index++;
+				return *this;
+			}
+			Block operator* () const
+			{
+				return grid->getBlock(index);
+			}
+			bool operator != (const blockIterator &i) const
+			{
+				return i.index != index;
+			}
+
+		private:
+			const Grid3 *grid;
+			size_t index;
+		};
+
+		struct BlockRange
+		{
+			BlockRange(const Grid3 *_grid) : grid(_grid) {}
+			blockIterator begin() const
+			{
+				return blockIterator(grid, 0);
+			}
+			blockIterator end() const
+			{
+				return blockIterator(grid, grid->getNumBlocks());
+			}
+
+		private:
+			const Grid3 *grid;
+		};
+
+		BlockRange getBlocks() const
+		{
+			return BlockRange(this);
+		}
+
 	protected:
 		T* m_data;
 		size_t m_dimX, m_dimY, m_dimZ;
+		Layout m_layout;
 	};
 
-	template <class T> inline bool operator == (const Grid3<T> &a, const Grid3<T> &b)
+	template <class T, class Layout> inline bool operator == (const Grid3<T, Layout> &a, const Grid3<T, Layout> &b)
 	{
 		if (a.getDimensions() != b.getDimensions()) return false;
+		if (a.getNumStorageElements() != a.getNumElements()) {
+			//the padding of tiled and Morton layouts is not compared
+			for (size_t z = 0; z < a.getDimZ(); z++)
+				for (size_t y = 0; y < a.getDimY(); y++)
+					for (size_t x = 0; x < a.getDimX(); x++)
+						if (a(x, y, z) != b(x, y, z))	return false;
+			return true;
+		}
 		const size_t totalEntries = a.getNumElements();
 		for (size_t i = 0; i < totalEntries; i++) {
 			if (a.getData()[i] != b.getData()[i])	return false;
@@ -355,14 +454,14 @@ namespace ml
 		return true;
 	}
 
-	template <class T> inline bool operator != (const Grid3<T> &a, const Grid3<T> &b)
+	template <class T, class Layout> inline bool operator != (const Grid3<T, Layout> &a, const Grid3<T, Layout> &b)
 	{
 		return !(a == b);
 	}
 
 	//! writes to a stream
-	template <class T>
-	inline std::ostream& operator<<(std::ostream& s, const Grid3<T>& g)
+	template <class T, class Layout>
+	inline std::ostream& operator<<(std::ostream& s, const Grid3<T, Layout>& g)
 	{
 		s << g.toString();
 		return s;
@@ -387,6 +486,13 @@ namespace ml
 		return s;
 	}
 
+	//! serialization of the other layouts (output); the cells are written in the linear order, so files do not depend on the layout
+	template<class BinaryDataBuffer, class BinaryDataCompressor, class T, class Layout>
+	inline BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& operator<<(BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& s, const Grid3<T, Layout>& g) {
+		const Grid3<T> linear(g.getDimX(), g.getDimY(), g.getDimZ(), [&](size_t x, size_t y, size_t z) { return g(x, y, z); });
+		return s << linear;
+	}
+
 	//! serialization (input)
 	template<class BinaryDataBuffer, class BinaryDataCompressor, class T>
 	inline BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& operator>>(BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& s, Grid3<T>& g) {
@@ -408,6 +514,16 @@ namespace ml
 		return s;
 	}
 
+	//! serialization of the other layouts (input)
+	template<class BinaryDataBuffer, class BinaryDataCompressor, class T, class Layout>
+	inline BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& operator>>(BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& s, Grid3<T, Layout>& g) {
+		Grid3<T> linear;
+		s >> linear;
+		g.allocate(linear.getDimX(), linear.getDimY(), linear.getDimZ());
+		g.fill([&](size_t x, size_t y, size_t z) { return linear(x, y, z); });
+		return s;
+	}
+
 	typedef Grid3<float> Grid3f;
 	typedef Grid3<double> Grid3d;
 	typedef Grid3<int> Grid3i;
@@ -0,0 +1,174 @@
+
+#ifndef CORE_BASE_GRID3LAYOUT_H_
+#define CORE_BASE_GRID3LAYOUT_H_
+
+namespace ml
+{
+
+	//
+	// memory layouts of Grid3: a layout maps the cell (x, y, z) to its index in the grid's storage. Neighborhood operations
+	// (e.g., 6- or 26-neighbor stencils) touch cells of three slices at once; in the linear layout these are dimX * dimY elements
+	// apart, while the tiled and Morton layouts keep small 3D blocks contiguous, so a stencil mostly stays within a few cache lines.
+	// The blocks of a layout (getBlockDimensions) are contiguous in memory; traversing a grid block by block (Grid3::getBlock)
+	// keeps the working set small in every layout. The tiled and Morton indices cost three table lookups and keep the compiler
+	// from vectorizing scanline loops, so whether they pay off depends on the access pattern (see the grid stencil benchmarks
+	// of test/testLinux).
+	//
+
+	//! x fastest, then y, then z (the default layout of Grid3)
+	class Grid3LayoutLinear
+	{
+	public:
+		static const bool IsLinear = true;
+
+		Grid3LayoutLinear() {
+			init(0, 0, 0);
+		}
+
+		void init(size_t dimX, size_t dimY, size_t dimZ) {
+			m_dimX = dimX;
+			m_dimY = dimY;
+			m_storageSize = dimX * dimY * dimZ;
+		}
+
+		inline size_t getIndex(size_t x, size_t y, size_t z) const {
+			return (m_dimY * z + y) * m_dimX + x;
+		}
+
+		//! number of elements of the storage (including padding)
+		size_t getStorageSize() const {
+			return m_storageSize;
+		}
+
+		//! a slice
+		vec3ul getBlockDimensions() const {
+			return vec3ul(m_dimX, m_dimY, 1);
+		}
+
+		//! heap bytes of the layout itself
+		size_t memoryFootprint() const {
+			return 0;
+		}
+
+	private:
+		size_t m_dimX, m_dimY;
+		size_t m_storageSize;
+	};
+
+	//! tiles of TileSize^3 cells (TileSize a power of two), x fastest within a tile and among the tiles; the dimensions are padded to multiples of TileSize.
+	//! The index is the sum of a table entry per axis.
+	template<UINT TileSize>
+	class Grid3LayoutTiled
+	{
+	public:
+		static const bool IsLinear = false;
+		static const UINT Shift = TileSize == 2 ? 1 : TileSize == 4 ? 2 : TileSize == 8 ? 3 : TileSize == 16 ? 4 : 0;
+		static const size_t Mask = TileSize - 1;
+
+		Grid3LayoutTiled() {
+			static_assert(Shift > 0, "tile size must be 2, 4, 8 or 16");
+			init(0, 0, 0);
+		}
+
+		void init(size_t dimX, size_t dimY, size_t dimZ) {
+			const size_t tilesX = (dimX + Mask) >> Shift;
+			const size_t tilesY = (dimY + Mask) >> Shift;
+			m_storageSize = (tilesX * tilesY * ((dimZ + Mask) >> Shift)) << (3 * Shift);
+
+			//the index is the sum of a term per axis
+			m_offsets[0].resize(dimX);
+			m_offsets[1].resize(dimY);
+			m_offsets[2].resize(dimZ);
+			for (size_t x = 0; x < dimX; x++) m_offsets[0][x] = ((x >> Shift) << (3 * Shift)) + (x & Mask);
+			for (size_t y = 0; y < dimY; y++) m_offsets[1][y] = ((y >> Shift) * tilesX << (3 * Shift)) + ((y & Mask) << Shift);
+			for (size_t z = 0; z < dimZ; z++) m_offsets[2][z] = ((z >> Shift) * tilesX * tilesY << (3 * Shift)) + ((z & Mask) << (2 * Shift));
+		}
+
+		inline size_t getIndex(size_t x, size_t y, size_t z) const {
+			return m_offsets[0][x] + m_offsets[1][y] + m_offsets[2][z];
+		}
+
+		size_t getStorageSize() const {
+			return m_storageSize;
+		}
+
+		vec3ul getBlockDimensions() const {
+			return vec3ul(TileSize, TileSize, TileSize);
+		}
+
+		size_t memoryFootprint() const {
+			return util::memoryFootprint(m_offsets[0]) + util::memoryFootprint(m_offsets[1]) + util::memoryFootprint(m_offsets[2]);
+		}
+
+	private:
+		std::vector<size_t> m_offsets[3];	//! per axis and coordinate: its term of the index
+		size_t m_storageSize;
+	};
+
+	//! Morton (Z-order) curve: the bits of x, y and z are interleaved, so every aligned block of 2^k cells per axis is contiguous. The dimensions
+	//! are padded to powers of two (each on its own; up to 8 times the cells in the worst case). The interleaved bits of each coordinate come
+	//! from a table, so an index costs three lookups.
+	class Grid3LayoutMorton
+	{
+	public:
+		static const bool IsLinear = false;
+
+		Grid3LayoutMorton() {
+			init(0, 0, 0);
+		}
+
+		void init(size_t dimX, size_t dimY, size_t dimZ) {
+			const size_t dim[3] = { dimX, dimY, dimZ };
+			UINT bits[3];
+			for (int axis = 0; axis < 3; axis++) {
+				bits[axis] = 0;
+				while (((size_t)1 << bits[axis]) < dim[axis]) bits[axis]++;
+				m_codes[axis].resize(dim[axis]);
+			}
+
+			//bit b of each coordinate goes to the next free bit of the code (axes that ran out of bits are skipped)
+			for (int axis = 0; axis < 3; axis++) {
+				for (size_t c = 0; c < dim[axis]; c++) {
+					size_t code = 0;
+					UINT codeBit = 0;
+					for (UINT b = 0; b < std::max(bits[0], std::max(bits[1], bits[2])); b++) {
+						for (int a = 0; a < 3; a++) {
+							if (b >= bits[a]) continue;
+							if (a == axis && ((c >> b) & 1)) code |= (size_t)1 << codeBit;
+							codeBit++;
+						}
+					}
+					m_codes[axis][c] = code;
+				}
+			}
+			m_storageSize = dimX * dimY * dimZ == 0 ? 0 : (size_t)1 << (bits[0] + bits[1] + bits[2]);
+		}
+
+		inline size_t getIndex(size_t x, size_t y, size_t z) const {
+			return m_codes[0][x] | m_codes[1][y] | m_codes[2][z];
+		}
+
+		size_t getStorageSize() const {
+			return m_storageSize;
+		}
+
+		//! aligned 8^3 blocks are contiguous (as are all aligned power of two blocks)
+		vec3ul getBlockDimensions() const {
+			return vec3ul(8, 8, 8);
+		}
+
+		size_t memoryFootprint() const {
+			return util::memoryFootprint(m_codes[0]) + util::memoryFootprint(m_codes[1]) + util::memoryFootprint(m_codes[2]);
+		}
+
+	private:
+		std::vector<size_t> m_codes[3];		//! per axis and coordinate: its bits of the index
+		size_t m_storageSize;
+	};
+
+	typedef Grid3LayoutTiled<4> Grid3LayoutTiled4;
+	typedef Grid3LayoutTiled<8> Grid3LayoutTiled8;
+
+}  // namespace ml
+
+#endif  // CORE_BASE_GRID3LAYOUT_H_
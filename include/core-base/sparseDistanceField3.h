@@ -0,0 +1,200 @@
+#ifndef CORE_BASE_SPARSE_DISTANCE_FIELD3_H_
+#define CORE_BASE_SPARSE_DISTANCE_FIELD3_H_
+
+#include <core-base/distanceField3.h>
+
+namespace ml {
+
+	//! narrow-band distance field: only bricks of 8^3 voxels that hold a distance within the truncation band are stored (found through a hash
+	//! map of brick coordinates); all other voxels read as the truncation value, so the sign of voxels far from the surface is not kept
+	template<class FloatType>
+	class SparseDistanceField3 {
+	public:
+		static const int BrickSize = 8;
+		static const int BrickVoxels = BrickSize * BrickSize * BrickSize;
+
+		SparseDistanceField3() : m_dim(0, 0, 0), m_truncation((FloatType)1) {}
+		SparseDistanceField3(const vec3ul& dim, FloatType truncation) : m_dim(dim), m_truncation(truncation) {}
+		SparseDistanceField3(const DistanceField3<FloatType>& dense) {
+			fromDense(dense);
+		}
+
+		//! keeps the bricks of dense that have a voxel with |distance| < truncation (by default the truncation of dense)
+		void fromDense(const DistanceField3<FloatType>& dense, FloatType truncation = -1) {
+			MLIB_MEMORY_SCOPE(MEMORY_GRID);
+			clear();
+			m_dim = dense.getDimensions();
+			m_truncation = truncation >= 0 ? truncation : dense.getTruncation();
+
+			const vec3i brickDim = getBrickDimensions();
+			for (int bz = 0; bz < brickDim.z; bz++) {
+				for (int by = 0; by < brickDim.y; by++) {
+					for (int bx = 0; bx < brickDim.x; bx++) {
+						const vec3i begin(bx * BrickSize, by * BrickSize, bz * BrickSize);
+						const vec3i end(std::min(begin.x + BrickSize, (int)m_dim.x), std::min(begin.y + BrickSize, (int)m_dim.y), std::min(begin.z + BrickSize, (int)m_dim.z));
+						bool inBand = false;
+						for (int z = begin.z; z < end.z && !inBand; z++) {
+							for (int y = begin.y; y < end.y && !inBand; y++) {
+								for (int x = begin.x; x < end.x && !inBand; x++) {
+									if (std::abs(dense(x, y, z)) < m_truncation) inBand = true;
+								}
+							}
+						}
+						if (!inBand) continue;
+
+						FloatType* brick = allocateBrick(vec3i(bx, by, bz));
+						for (int z = begin.z; z < end.z; z++) {
+							for (int y = begin.y; y < end.y; y++) {
+								for (int x = begin.x; x < end.x; x++) {
+									brick[getVoxelIndex(x, y, z)] = clampToBand(dense(x, y, z));
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		//! dense field of the same dimensions; voxels outside the bricks get the truncation value
+		DistanceField3<FloatType> toDense() const {
+			DistanceField3<FloatType> dense(m_dim);
+			dense.setTruncation(m_truncation, false);
+			dense.setValues(m_truncation);
+			for (const auto& entry : m_brickIndex) {
+				const FloatType* brick = &m_values[(size_t)entry.second * BrickVoxels];
+				const vec3i begin = entry.first * BrickSize;
+				const vec3i end(std::min(begin.x + BrickSize, (int)m_dim.x), std::min(begin.y + BrickSize, (int)m_dim.y), std::min(begin.z + BrickSize, (int)m_dim.z));
+				for (int z = begin.z; z < end.z; z++) {
+					for (int y = begin.y; y < end.y; y++) {
+						for (int x = begin.x; x < end.x; x++) {
+							dense(x, y, z) = brick[getVoxelIndex(x, y, z)];
+						}
+					}
+				}
+			}
+			return dense;
+		}
+
+		void clear() {
+			m_brickIndex.clear();
+			m_values.clear();
+		}
+
+		const vec3ul& getDimensions() const {
+			return m_dim;
+		}
+		FloatType getTruncation() const {
+			return m_truncation;
+		}
+		size_t getNumBricks() const {
+			return m_brickIndex.size();
+		}
+		//! number of bricks covering the dimensions in each direction
+		vec3i getBrickDimensions() const {
+			return vec3i((int)(m_dim.x + BrickSize - 1) / BrickSize, (int)(m_dim.y + BrickSize - 1) / BrickSize, (int)(m_dim.z + BrickSize - 1) / BrickSize);
+		}
+
+		bool isValidCoordinate(int x, int y, int z) const {
+			return x >= 0 && y >= 0 && z >= 0 && (size_t)x < m_dim.x && (size_t)y < m_dim.y && (size_t)z < m_dim.z;
+		}
+		bool isBrickAllocated(int x, int y, int z) const {
+			return findBrick(x, y, z) != nullptr;
+		}
+
+		//! distance at a voxel (the truncation value outside the bricks)
+		FloatType operator()(int x, int y, int z) const {
+			MLIB_ASSERT(isValidCoordinate(x, y, z));
+			const FloatType* brick = findBrick(x, y, z);
+			return brick ? brick[getVoxelIndex(x, y, z)] : m_truncation;
+		}
+		FloatType operator()(const vec3i& v) const {
+			return (*this)(v.x, v.y, v.z);
+		}
+
+		//! sets the distance of a voxel (clamped to the truncation band); allocates its brick if the distance is within the band
+		void setVoxel(int x, int y, int z, FloatType d) {
+			MLIB_ASSERT(isValidCoordinate(x, y, z));
+			FloatType* brick = findBrick(x, y, z);
+			if (brick == nullptr) {
+				if (std::abs(d) >= m_truncation) return;
+				MLIB_MEMORY_SCOPE(MEMORY_GRID);
+				brick = allocateBrick(vec3i(x / BrickSize, y / BrickSize, z / BrickSize));
+			}
+			brick[getVoxelIndex(x, y, z)] = clampToBand(d);
+		}
+
+		//! same sampling as DistanceField3::trilinearInterpolationSimpleFastFast; the eight voxels are read from one brick if they share it
+		FloatType trilinearInterpolationSimpleFastFast(const vec3<FloatType>& pos) const {
+			const vec3<FloatType> posDual = pos - vec3<FloatType>((FloatType)0.5, (FloatType)0.5, (FloatType)0.5);
+			const vec3<FloatType> weight = math::frac(pos);
+
+			const int x0 = clampRound(posDual.x, m_dim.x), x1 = clampRound(posDual.x + 1, m_dim.x);
+			const int y0 = clampRound(posDual.y, m_dim.y), y1 = clampRound(posDual.y + 1, m_dim.y);
+			const int z0 = clampRound(posDual.z, m_dim.z), z1 = clampRound(posDual.z + 1, m_dim.z);
+
+			FloatType v[8];
+			if (x0 / BrickSize == x1 / BrickSize && y0 / BrickSize == y1 / BrickSize && z0 / BrickSize == z1 / BrickSize) {
+				const FloatType* brick = findBrick(x0, y0, z0);
+				if (brick == nullptr) return m_truncation;
+				v[0] = brick[getVoxelIndex(x0, y0, z0)];	v[1] = brick[getVoxelIndex(x1, y0, z0)];
+				v[2] = brick[getVoxelIndex(x0, y1, z0)];	v[3] = brick[getVoxelIndex(x1, y1, z0)];
+				v[4] = brick[getVoxelIndex(x0, y0, z1)];	v[5] = brick[getVoxelIndex(x1, y0, z1)];
+				v[6] = brick[getVoxelIndex(x0, y1, z1)];	v[7] = brick[getVoxelIndex(x1, y1, z1)];
+			}
+			else {
+				v[0] = (*this)(x0, y0, z0);	v[1] = (*this)(x1, y0, z0);
+				v[2] = (*this)(x0, y1, z0);	v[3] = (*this)(x1, y1, z0);
+				v[4] = (*this)(x0, y0, z1);	v[5] = (*this)(x1, y0, z1);
+				v[6] = (*this)(x0, y1, z1);	v[7] = (*this)(x1, y1, z1);
+			}
+
+			const FloatType one = (FloatType)1;
+			return (one - weight.z) * ((one - weight.y) * ((one - weight.x) * v[0] + weight.x * v[1]) + weight.y * ((one - weight.x) * v[2] + weight.x * v[3]))
+				+ weight.z * ((one - weight.y) * ((one - weight.x) * v[4] + weight.x * v[5]) + weight.y * ((one - weight.x) * v[6] + weight.x * v[7]));
+		}
+
+		//! bytes held by the field (estimated for the hash map)
+		size_t memoryFootprint() const {
+			return sizeof(*this) + util::memoryFootprint(m_brickIndex) + util::memoryFootprint(m_values);
+		}
+
+	private:
+		static int getVoxelIndex(int x, int y, int z) {
+			return ((z % BrickSize) * BrickSize + (y % BrickSize)) * BrickSize + (x % BrickSize);
+		}
+
+		static int clampRound(FloatType f, size_t dim) {
+			return math::round(math::clamp(f, (FloatType)0, (FloatType)dim - 1));
+		}
+
+		FloatType clampToBand(FloatType d) const {
+			return math::clamp(d, -m_truncation, m_truncation);
+		}
+
+		const FloatType* findBrick(int x, int y, int z) const {
+			const auto it = m_brickIndex.find(vec3i(x / BrickSize, y / BrickSize, z / BrickSize));
+			return it == m_brickIndex.end() ? nullptr : &m_values[(size_t)it->second * BrickVoxels];
+		}
+		FloatType* findBrick(int x, int y, int z) {
+			return const_cast<FloatType*>(static_cast<const SparseDistanceField3*>(this)->findBrick(x, y, z));
+		}
+
+		//! new brick filled with the truncation value
+		FloatType* allocateBrick(const vec3i& brickCoord) {
+			const UINT index = (UINT)m_brickIndex.size();
+			m_brickIndex[brickCoord] = index;
+			m_values.resize(m_values.size() + BrickVoxels, m_truncation);
+			return &m_values[(size_t)index * BrickVoxels];
+		}
+
+		vec3ul m_dim;
+		FloatType m_truncation;
+		std::unordered_map<vec3i, UINT, std::hash<vec3i>> m_brickIndex;	//! brick coordinates (voxel coordinates / BrickSize) -> brick index
+		std::vector<FloatType> m_values;	//! BrickVoxels per brick, x fastest within a brick
+	};
+
+	typedef SparseDistanceField3<float> SparseDistanceField3f;
+	typedef SparseDistanceField3<double> SparseDistanceField3d;
+}
+
+#endif // CORE_BASE_SPARSE_DISTANCE_FIELD3_H_
@@ -108,9 +108,9 @@ public:
 
 		FloatType txmin, txmax, tymin, tymax, tzmin, tzmax;
 
-        auto sign = r.getSign();
-        auto origin = r.getOrigin();
-        auto invDir = r.getInverseDirection();
+        const vec3i& sign = r.getSign();
+        const vec3<FloatType>& origin = r.getOrigin();
+        const vec3<FloatType>& invDir = r.getInverseDirection();
 
         txmin = (parameters[sign.x * 3] - origin.x) * invDir.x;
         txmax = (parameters[3 - sign.x * 3] - origin.x) * invDir.x;
@@ -235,6 +235,21 @@ public:
 		return vec3<FloatType>(maxX - minX, maxY - minY, maxZ - minZ);
 	}
 
+	//! returns the surface area of the box (0 for an uninitialized box)
+	FloatType getSurfaceArea() const {
+		if (!isValid()) return (FloatType)0;
+		vec3<FloatType> e = getExtent();
+		return (FloatType)2 * (e.x*e.y + e.y*e.z + e.z*e.x);
+	}
+
+	//! squared distance from p to the box (0 if p is inside)
+	FloatType getDistanceSq(const vec3<FloatType>& p) const {
+		const FloatType dx = std::max(std::max(minX - p.x, p.x - maxX), (FloatType)0);
+		const FloatType dy = std::max(std::max(minY - p.y, p.y - maxY), (FloatType)0);
+		const FloatType dz = std::max(std::max(minZ - p.z, p.z - maxZ), (FloatType)0);
+		return dx*dx + dy*dy + dz*dz;
+	}
+
 	vec3<FloatType> getMin() const {
 		return vec3<FloatType>(minX, minY, minZ);
 	}
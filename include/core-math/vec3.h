@@ -462,102 +462,110 @@ namespace math {
         return ((v1 - v0) ^ (v2 - v0)).getNormalized();
     }
 
+    //! closest point to p on the triangle (t0, t1, t2); u and v are the barycentric weights of t1 and t2
     template<class T>
-    inline float trianglePointDistSq(const vec3<T>& t0, const vec3<T>& t1, const vec3<T>& t2, const vec3<T>& p) {
+    inline vec3<T> triangleClosestPoint(const vec3<T>& t0, const vec3<T>& t1, const vec3<T>& t2, const vec3<T>& p, T& u, T& v) {
         const vec3<T> edge0 = t1 - t0;
         const vec3<T> edge1 = t2 - t0;
         const vec3<T> v0 = t0 - p;
 
-        float a = edge0 | edge0;
-        float b = edge0 | edge1;
-        float c = edge1 | edge1;
-        float d = edge0 | v0;
-        float e = edge1 | v0;
+        T a = edge0 | edge0;
+        T b = edge0 | edge1;
+        T c = edge1 | edge1;
+        T d = edge0 | v0;
+        T e = edge1 | v0;
 
-        float det = a*c - b*b;
-        float s = b*e - c*d;
-        float t = b*d - a*e;
+        T det = a*c - b*b;
+        T s = b*e - c*d;
+        T t = b*d - a*e;
 
         if (s + t < det)
         {
-            if (s < 0.f)
+            if (s < (T)0)
             {
-                if (t < 0.f)
+                if (t < (T)0)
                 {
-                    if (d < 0.f)
+                    if (d < (T)0)
                     {
-                        s = clamp(-d / a, 0.f, 1.f);
-                        t = 0.f;
+                        s = clamp(-d / a, (T)0, (T)1);
+                        t = (T)0;
                     }
                     else
                     {
-                        s = 0.f;
-                        t = clamp(-e / c, 0.f, 1.f);
+                        s = (T)0;
+                        t = clamp(-e / c, (T)0, (T)1);
                     }
                 }
                 else
                 {
-                    s = 0.f;
-                    t = clamp(-e / c, 0.f, 1.f);
+                    s = (T)0;
+                    t = clamp(-e / c, (T)0, (T)1);
                 }
             }
-            else if (t < 0.f)
+            else if (t < (T)0)
             {
-                s = clamp(-d / a, 0.f, 1.f);
-                t = 0.f;
+                s = clamp(-d / a, (T)0, (T)1);
+                t = (T)0;
             }
             else
             {
-                float invDet = 1.f / det;
+                T invDet = (T)1 / det;
                 s *= invDet;
                 t *= invDet;
             }
         }
         else
         {
-            if (s < 0.f)
+            if (s < (T)0)
             {
-                float tmp0 = b + d;
-                float tmp1 = c + e;
+                T tmp0 = b + d;
+                T tmp1 = c + e;
                 if (tmp1 > tmp0)
                 {
-                    float numer = tmp1 - tmp0;
-                    float denom = a - 2 * b + c;
-                    s = clamp(numer / denom, 0.f, 1.f);
-                    t = 1 - s;
+                    T numer = tmp1 - tmp0;
+                    T denom = a - (T)2 * b + c;
+                    s = clamp(numer / denom, (T)0, (T)1);
+                    t = (T)1 - s;
                 }
                 else
                 {
-                    t = clamp(-e / c, 0.f, 1.f);
-                    s = 0.f;
+                    t = clamp(-e / c, (T)0, (T)1);
+                    s = (T)0;
                 }
             }
-            else if (t < 0.f)
+            else if (t < (T)0)
             {
                 if (a + d > b + e)
                 {
-                    float numer = c + e - b - d;
-                    float denom = a - 2 * b + c;
-                    s = clamp(numer / denom, 0.f, 1.f);
-                    t = 1 - s;
+                    T numer = c + e - b - d;
+                    T denom = a - (T)2 * b + c;
+                    s = clamp(numer / denom, (T)0, (T)1);
+                    t = (T)1 - s;
                 }
                 else
                 {
-                    s = clamp(-e / c, 0.f, 1.f);
-                    t = 0.f;
+                    s = clamp(-d / a, (T)0, (T)1);
+                    t = (T)0;
                 }
             }
             else
             {
-                float numer = c + e - b - d;
-                float denom = a - 2 * b + c;
-                s = clamp(numer / denom, 0.f, 1.f);
-                t = 1.f - s;
+                T numer = c + e - b - d;
+                T denom = a - (T)2 * b + c;
+                s = clamp(numer / denom, (T)0, (T)1);
+                t = (T)1 - s;
             }
         }
 
-        const vec3f pos = t0 + s * edge0 + t * edge1;
-        return vec3f::distSq(pos, p);
+        u = s;
+        v = t;
+        return t0 + s * edge0 + t * edge1;
+    }
+
+    template<class T>
+    inline float trianglePointDistSq(const vec3<T>& t0, const vec3<T>& t1, const vec3<T>& t2, const vec3<T>& p) {
+        T u, v;
+        return (float)vec3<T>::distSq(triangleClosestPoint(t0, t1, t2, p, u, v), p);
     }
 
     template<class T>
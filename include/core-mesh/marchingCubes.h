@@ -0,0 +1,467 @@
+#ifndef _COREMESH_MARCHINGCUBES_H_
+#define _COREMESH_MARCHINGCUBES_H_
+
+namespace ml {
+
+//
+// marching cubes (Lorensen and Cline) on Grid3 / DistanceField3 values, with voxel centers at integer coordinates.
+// The grid is cut into slabs of SlabSize cube layers that are extracted in parallel (MLIB_OPENMP). Within a slab every grid
+// edge gets its vertex once through edge caches of two planes; vertices on the plane between two slabs belong to the upper
+// slab and are looked up in its cache, so no vertices are merged afterwards. The triangle table resolves ambiguous faces by
+// separating the corners below the iso value; since that only depends on the face, neighboring cubes agree and the surface has no holes.
+//
+
+template<class FloatType>
+class MarchingCubes
+{
+public:
+	typedef typename TriMesh<FloatType>::Vertex Vertex;
+
+	static const UINT SlabSize = 8;
+
+	//! iso-surface of values, mapped by voxelToWorld; cubes with a non-finite corner (e.g., beyond the truncation of a DistanceField3)
+	//! are skipped. Triangles face toward larger values (out of a signed distance field).
+	static TriMesh<FloatType> extract(const Grid3<FloatType>& values, FloatType isoValue = 0, const Matrix4x4<FloatType>& voxelToWorld = Matrix4x4<FloatType>::identity())
+	{
+		return extract(values, isoValue, voxelToWorld, [](size_t, size_t, size_t) { return vec4<FloatType>::origin; }, false);
+	}
+
+	//! same as above with vertex colors interpolated from colors (of the same dimensions as values)
+	static TriMesh<FloatType> extract(const Grid3<FloatType>& values, const Grid3<vec4<FloatType>>& colors, FloatType isoValue = 0, const Matrix4x4<FloatType>& voxelToWorld = Matrix4x4<FloatType>::identity())
+	{
+		MLIB_ASSERT(colors.getDimensions() == values.getDimensions());
+		return extract(values, isoValue, voxelToWorld, [&](size_t x, size_t y, size_t z) { return colors(x, y, z); }, true);
+	}
+	static TriMesh<FloatType> extract(const Grid3<FloatType>& values, const Grid3<vec3uc>& colors, FloatType isoValue = 0, const Matrix4x4<FloatType>& voxelToWorld = Matrix4x4<FloatType>::identity())
+	{
+		MLIB_ASSERT(colors.getDimensions() == values.getDimensions());
+		return extract(values, isoValue, voxelToWorld, [&](size_t x, size_t y, size_t z) {
+			const vec3uc& c = colors(x, y, z);
+			return vec4<FloatType>((FloatType)c.x / 255, (FloatType)c.y / 255, (FloatType)c.z / 255, (FloatType)1);
+		}, true);
+	}
+
+private:
+	static const UINT NoVertex = 0xffffffff;
+
+	//! vertices and triangles of a slab; vertex indices are local to the slab
+	struct Slab
+	{
+		std::vector<Vertex> vertices;
+		std::vector<UINT> topPlaneEdges;	//! per vertex: cache key if it lies on the plane shared with the next slab, NoVertex otherwise
+		std::vector<vec3ui> triangles;
+		std::vector<UINT> bottomPlane;		//! edge cache of the first plane (looked up by the previous slab)
+		std::vector<UINT> globalIndices;	//! per vertex, after all slabs are extracted
+		UINT ownedVertexCount;
+	};
+
+	template<class ColorFunction>
+	static TriMesh<FloatType> extract(const Grid3<FloatType>& values, FloatType isoValue, const Matrix4x4<FloatType>& voxelToWorld, const ColorFunction& colorAt, bool hasColors)
+	{
+		if (values.getDimX() < 2 || values.getDimY() < 2 || values.getDimZ() < 2) return TriMesh<FloatType>();
+		const size_t layerCount = values.getDimZ() - 1;
+		std::vector<Slab> slabs((layerCount + SlabSize - 1) / SlabSize);
+
+#ifdef MLIB_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (int s = 0; s < (int)slabs.size(); s++) {
+			extractSlab(values, isoValue, voxelToWorld, colorAt, (size_t)s * SlabSize, std::min((size_t)(s + 1) * SlabSize, layerCount), slabs[s]);
+		}
+
+		//vertices on the plane between two slabs belong to the upper slab if it created them (it skips cubes with non-finite corners)
+		for (size_t s = 0; s < slabs.size(); s++) {
+			Slab& slab = slabs[s];
+			slab.globalIndices.assign(slab.vertices.size(), NoVertex);
+			slab.ownedVertexCount = 0;
+			for (size_t i = 0; i < slab.vertices.size(); i++) {
+				const UINT key = slab.topPlaneEdges[i];
+				if (key == NoVertex || slabs[s + 1].bottomPlane[key] == NoVertex) slab.globalIndices[i] = slab.ownedVertexCount++;
+			}
+		}
+		std::vector<UINT> vertexOffsets(slabs.size() + 1, 0), triangleOffsets(slabs.size() + 1, 0);
+		for (size_t s = 0; s < slabs.size(); s++) {
+			vertexOffsets[s + 1] = vertexOffsets[s] + slabs[s].ownedVertexCount;
+			triangleOffsets[s + 1] = triangleOffsets[s] + (UINT)slabs[s].triangles.size();
+		}
+		for (size_t s = 0; s < slabs.size(); s++) {
+			for (UINT& index : slabs[s].globalIndices) {
+				if (index != NoVertex) index += vertexOffsets[s];
+			}
+		}
+
+		std::vector<Vertex> vertices(vertexOffsets.back());
+		std::vector<vec3ui> triangles(triangleOffsets.back());
+#ifdef MLIB_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (int s = 0; s < (int)slabs.size(); s++) {
+			const Slab& slab = slabs[s];
+			std::vector<UINT> indices(slab.globalIndices);
+			for (size_t i = 0; i < slab.vertices.size(); i++) {
+				if (indices[i] == NoVertex) {
+					const Slab& next = slabs[s + 1];
+					indices[i] = next.globalIndices[next.bottomPlane[slab.topPlaneEdges[i]]];
+				}
+				else {
+					vertices[indices[i]] = slab.vertices[i];
+				}
+			}
+			for (size_t t = 0; t < slab.triangles.size(); t++) {
+				const vec3ui& tri = slab.triangles[t];
+				triangles[triangleOffsets[s] + t] = vec3ui(indices[tri.x], indices[tri.y], indices[tri.z]);
+			}
+		}
+
+		return TriMesh<FloatType>(vertices, triangles, true, true, false, hasColors);
+	}
+
+	//! triangles of the cube layers [zBegin, zEnd)
+	template<class ColorFunction>
+	static void extractSlab(const Grid3<FloatType>& values, FloatType isoValue, const Matrix4x4<FloatType>& voxelToWorld, const ColorFunction& colorAt,
+		size_t zBegin, size_t zEnd, Slab& slab)
+	{
+		const size_t dimX = values.getDimX(), dimY = values.getDimY();
+		const bool hasNextSlab = zEnd + 1 < values.getDimZ();
+
+		//x and y edges of the lower and the upper plane of a layer (key (y * dimX + x) * 2 + axis) and z edges between them (key y * dimX + x)
+		std::vector<UINT> lowerPlane(dimX * dimY * 2, NoVertex), upperPlane(dimX * dimY * 2, NoVertex), zEdges(dimX * dimY, NoVertex);
+
+		//creates the vertex of the edge from (x, y, z) along axis (or returns the existing one)
+		auto getVertex = [&](UINT& cached, size_t x, size_t y, size_t z, int axis, UINT topPlaneKey) {
+			if (cached != NoVertex) return cached;
+			const size_t x1 = x + (axis == 0), y1 = y + (axis == 1), z1 = z + (axis == 2);
+			const FloatType v0 = values(x, y, z), v1 = values(x1, y1, z1);
+			const FloatType t = (isoValue - v0) / (v1 - v0);
+			Vertex v;
+			v.position = voxelToWorld * vec3<FloatType>((FloatType)x + t * (FloatType)(x1 - x), (FloatType)y + t * (FloatType)(y1 - y), (FloatType)z + t * (FloatType)(z1 - z));
+			v.normal = vec3<FloatType>::origin;
+			v.color = colorAt(x, y, z) * ((FloatType)1 - t) + colorAt(x1, y1, z1) * t;
+			v.texCoord = vec2<FloatType>::origin;
+			cached = (UINT)slab.vertices.size();
+			slab.vertices.push_back(v);
+			slab.topPlaneEdges.push_back(topPlaneKey);
+			return cached;
+		};
+
+		static const int cornerOffsets[8][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } };
+		//per cube edge: offset of its start corner and axis
+		static const int edgeStarts[12][4] = {
+			{ 0, 0, 0, 0 }, { 1, 0, 0, 1 }, { 0, 1, 0, 0 }, { 0, 0, 0, 1 },
+			{ 0, 0, 1, 0 }, { 1, 0, 1, 1 }, { 0, 1, 1, 0 }, { 0, 0, 1, 1 },
+			{ 0, 0, 0, 2 }, { 1, 0, 0, 2 }, { 1, 1, 0, 2 }, { 0, 1, 0, 2 } };
+
+		for (size_t z = zBegin; z < zEnd; z++) {
+			const bool upperIsShared = z + 1 == zEnd && hasNextSlab;
+			for (size_t y = 0; y + 1 < dimY; y++) {
+				for (size_t x = 0; x + 1 < dimX; x++) {
+					UINT cubeIndex = 0;
+					bool finite = true;
+					for (int c = 0; c < 8; c++) {
+						const FloatType v = values(x + cornerOffsets[c][0], y + cornerOffsets[c][1], z + cornerOffsets[c][2]);
+						if (!std::isfinite(v)) finite = false;
+						if (v < isoValue) cubeIndex |= 1 << c;
+					}
+					if (!finite || cubeIndex == 0 || cubeIndex == 255) continue;
+
+					const signed char* cubeTriangles = s_triangleTable[cubeIndex];
+					UINT edgeVertices[12];
+					for (int i = 0; cubeTriangles[i] != -1; i++) {
+						const int e = cubeTriangles[i];
+						const size_t ex = x + edgeStarts[e][0], ey = y + edgeStarts[e][1], ez = z + edgeStarts[e][2];
+						const int axis = edgeStarts[e][3];
+						if (axis == 2) {
+							edgeVertices[e] = getVertex(zEdges[ey * dimX + ex], ex, ey, ez, axis, NoVertex);
+						}
+						else {
+							const UINT key = (UINT)((ey * dimX + ex) * 2 + axis);
+							const bool upper = ez != z;
+							edgeVertices[e] = getVertex(upper ? upperPlane[key] : lowerPlane[key], ex, ey, ez, axis, upper && upperIsShared ? key : NoVertex);
+						}
+					}
+					for (int i = 0; cubeTriangles[i] != -1; i += 3) {
+						slab.triangles.push_back(vec3ui(edgeVertices[cubeTriangles[i]], edgeVertices[cubeTriangles[i + 1]], edgeVertices[cubeTriangles[i + 2]]));
+					}
+				}
+			}
+
+			if (z == zBegin) slab.bottomPlane = lowerPlane;
+			std::swap(lowerPlane, upperPlane);
+			std::fill(upperPlane.begin(), upperPlane.end(), NoVertex);
+			std::fill(zEdges.begin(), zEdges.end(), NoVertex);
+		}
+	}
+
+	//! per cube configuration (bit c set if corner c is below the iso value) up to five triangles of cube edges, terminated by -1
+	static const signed char s_triangleTable[256][16];
+};
+
+template<class FloatType> const UINT MarchingCubes<FloatType>::SlabSize;
+template<class FloatType> const UINT MarchingCubes<FloatType>::NoVertex;
+
+template<class FloatType>
+const signed char MarchingCubes<FloatType>::s_triangleTable[256][16] = {
+	{ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 9, 2, 9, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 2, 11, 1, 11, 8, 1, 8, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 11, 1, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 10, 0, 10, 11, 0, 11, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 11, 0, 11, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 9, 10, 8, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 7, 1, 7, 4, 1, 4, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 4, 1, 10, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 2, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 7, 2, 7, 4, 2, 4, 9, 2, 9, 10, -1, -1, -1, -1 },
+	{ 2, 11, 3, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 7, 0, 7, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 2, 11, 1, 11, 7, 1, 7, 4, 1, 4, 9, -1, -1, -1, -1 },
+	{ 1, 10, 11, 1, 11, 3, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 10, 0, 10, 11, 0, 11, 7, 0, 7, 4, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 11, 0, 11, 3, 4, 8, 7, -1, -1, -1, -1 },
+	{ 4, 9, 10, 4, 10, 11, 4, 11, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 4, 5, 0, 5, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 4, 1, 4, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 4, 5, 0, 5, 10, 0, 10, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 4, 2, 4, 5, 2, 5, 10, -1, -1, -1, -1 },
+	{ 2, 11, 3, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 8, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 4, 5, 0, 5, 1, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 2, 11, 1, 11, 8, 1, 8, 4, 1, 4, 5, -1, -1, -1, -1 },
+	{ 1, 10, 11, 1, 11, 3, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 10, 0, 10, 11, 0, 11, 8, 4, 5, 9, -1, -1, -1, -1 },
+	{ 0, 4, 5, 0, 5, 10, 0, 10, 11, 0, 11, 3, -1, -1, -1, -1 },
+	{ 4, 5, 10, 4, 10, 11, 4, 11, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 9, 8, 5, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 5, 0, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 8, 7, 0, 7, 5, 0, 5, 1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 7, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 5, 9, 8, 5, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 5, 0, 5, 9, 1, 10, 2, -1, -1, -1, -1 },
+	{ 0, 8, 7, 0, 7, 5, 0, 5, 10, 0, 10, 2, -1, -1, -1, -1 },
+	{ 2, 3, 7, 2, 7, 5, 2, 5, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, 5, 9, 8, 5, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 7, 0, 7, 5, 0, 5, 9, -1, -1, -1, -1 },
+	{ 0, 8, 7, 0, 7, 5, 0, 5, 1, 2, 11, 3, -1, -1, -1, -1 },
+	{ 1, 2, 11, 1, 11, 7, 1, 7, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 11, 1, 11, 3, 5, 9, 8, 5, 8, 7, -1, -1, -1, -1 },
+	{ 0, 1, 10, 0, 10, 11, 0, 11, 7, 0, 7, 5, 0, 5, 9, -1 },
+	{ 0, 8, 7, 0, 7, 5, 0, 5, 10, 0, 10, 11, 0, 11, 3, -1 },
+	{ 5, 10, 11, 5, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 9, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 5, 6, 1, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 5, 6, 1, 6, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 5, 0, 5, 6, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 9, 2, 9, 5, 2, 5, 6, -1, -1, -1, -1 },
+	{ 2, 11, 3, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 2, 11, 1, 11, 8, 1, 8, 9, 5, 6, 10, -1, -1, -1, -1 },
+	{ 1, 5, 6, 1, 6, 11, 1, 11, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 5, 0, 5, 6, 0, 6, 11, 0, 11, 8, -1, -1, -1, -1 },
+	{ 0, 9, 5, 0, 5, 6, 0, 6, 11, 0, 11, 3, -1, -1, -1, -1 },
+	{ 5, 6, 11, 5, 11, 8, 5, 8, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 7, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 4, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 7, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 7, 1, 7, 4, 1, 4, 9, 5, 6, 10, -1, -1, -1, -1 },
+	{ 1, 5, 6, 1, 6, 2, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 4, 1, 5, 6, 1, 6, 2, -1, -1, -1, -1 },
+	{ 0, 9, 5, 0, 5, 6, 0, 6, 2, 4, 8, 7, -1, -1, -1, -1 },
+	{ 2, 3, 7, 2, 7, 4, 2, 4, 9, 2, 9, 5, 2, 5, 6, -1 },
+	{ 2, 11, 3, 4, 8, 7, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 7, 0, 7, 4, 5, 6, 10, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, 4, 8, 7, 5, 6, 10, -1, -1, -1, -1 },
+	{ 1, 2, 11, 1, 11, 7, 1, 7, 4, 1, 4, 9, 5, 6, 10, -1 },
+	{ 1, 5, 6, 1, 6, 11, 1, 11, 3, 4, 8, 7, -1, -1, -1, -1 },
+	{ 0, 1, 5, 0, 5, 6, 0, 6, 11, 0, 11, 7, 0, 7, 4, -1 },
+	{ 0, 9, 5, 0, 5, 6, 0, 6, 11, 0, 11, 3, 4, 8, 7, -1 },
+	{ 4, 9, 5, 4, 5, 6, 4, 6, 11, 4, 11, 7, -1, -1, -1, -1 },
+	{ 4, 6, 10, 4, 10, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 4, 6, 10, 4, 10, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 4, 6, 0, 6, 10, 0, 10, 1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 4, 1, 4, 6, 1, 6, 10, -1, -1, -1, -1 },
+	{ 1, 9, 4, 1, 4, 6, 1, 6, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 9, 4, 1, 4, 6, 1, 6, 2, -1, -1, -1, -1 },
+	{ 0, 4, 6, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 4, 2, 4, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, 4, 6, 10, 4, 10, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 8, 4, 6, 10, 4, 10, 9, -1, -1, -1, -1 },
+	{ 0, 4, 6, 0, 6, 10, 0, 10, 1, 2, 11, 3, -1, -1, -1, -1 },
+	{ 1, 2, 11, 1, 11, 8, 1, 8, 4, 1, 4, 6, 1, 6, 10, -1 },
+	{ 1, 9, 4, 1, 4, 6, 1, 6, 11, 1, 11, 3, -1, -1, -1, -1 },
+	{ 0, 1, 9, 0, 9, 4, 0, 4, 6, 0, 6, 11, 0, 11, 8, -1 },
+	{ 0, 4, 6, 0, 6, 11, 0, 11, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 6, 11, 4, 11, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 10, 9, 6, 9, 8, 6, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 6, 0, 6, 10, 0, 10, 9, -1, -1, -1, -1 },
+	{ 0, 8, 7, 0, 7, 6, 0, 6, 10, 0, 10, 1, -1, -1, -1, -1 },
+	{ 1, 3, 7, 1, 7, 6, 1, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 9, 8, 1, 8, 7, 1, 7, 6, 1, 6, 2, -1, -1, -1, -1 },
+	{ 0, 3, 7, 0, 7, 6, 0, 6, 2, 0, 2, 1, 0, 1, 9, -1 },
+	{ 0, 8, 7, 0, 7, 6, 0, 6, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 7, 2, 7, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, 6, 10, 9, 6, 9, 8, 6, 8, 7, -1, -1, -1, -1 },
+	{ 0, 2, 11, 0, 11, 7, 0, 7, 6, 0, 6, 10, 0, 10, 9, -1 },
+	{ 0, 8, 7, 0, 7, 6, 0, 6, 10, 0, 10, 1, 2, 11, 3, -1 },
+	{ 1, 2, 11, 1, 11, 7, 1, 7, 6, 1, 6, 10, -1, -1, -1, -1 },
+	{ 1, 9, 8, 1, 8, 7, 1, 7, 6, 1, 6, 11, 1, 11, 3, -1 },
+	{ 0, 1, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 8, 7, 0, 7, 6, 0, 6, 11, 0, 11, 3, -1, -1, -1, -1 },
+	{ 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 2, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 9, 2, 9, 10, 6, 7, 11, -1, -1, -1, -1 },
+	{ 2, 6, 7, 2, 7, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 6, 0, 6, 7, 0, 7, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 6, 7, 2, 7, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 2, 6, 1, 6, 7, 1, 7, 8, 1, 8, 9, -1, -1, -1, -1 },
+	{ 1, 10, 6, 1, 6, 7, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 10, 0, 10, 6, 0, 6, 7, 0, 7, 8, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 6, 0, 6, 7, 0, 7, 3, -1, -1, -1, -1 },
+	{ 6, 7, 8, 6, 8, 9, 6, 9, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 11, 4, 11, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 6, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 11, 4, 11, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 11, 1, 11, 6, 1, 6, 4, 1, 4, 9, -1, -1, -1, -1 },
+	{ 1, 10, 2, 4, 8, 11, 4, 11, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 6, 0, 6, 4, 1, 10, 2, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 2, 4, 8, 11, 4, 11, 6, -1, -1, -1, -1 },
+	{ 2, 3, 11, 2, 11, 6, 2, 6, 4, 2, 4, 9, 2, 9, 10, -1 },
+	{ 2, 6, 4, 2, 4, 8, 2, 8, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 6, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 6, 4, 2, 4, 8, 2, 8, 3, -1, -1, -1, -1 },
+	{ 1, 2, 6, 1, 6, 4, 1, 4, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 6, 1, 6, 4, 1, 4, 8, 1, 8, 3, -1, -1, -1, -1 },
+	{ 0, 1, 10, 0, 10, 6, 0, 6, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 10, 0, 10, 6, 0, 6, 4, 0, 4, 8, 0, 8, 3, -1 },
+	{ 4, 9, 10, 4, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 4, 5, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 4, 5, 0, 5, 1, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 4, 1, 4, 5, 6, 7, 11, -1, -1, -1, -1 },
+	{ 1, 10, 2, 4, 5, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, 4, 5, 9, 6, 7, 11, -1, -1, -1, -1 },
+	{ 0, 4, 5, 0, 5, 10, 0, 10, 2, 6, 7, 11, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 4, 2, 4, 5, 2, 5, 10, 6, 7, 11, -1 },
+	{ 2, 6, 7, 2, 7, 3, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 6, 0, 6, 7, 0, 7, 8, 4, 5, 9, -1, -1, -1, -1 },
+	{ 0, 4, 5, 0, 5, 1, 2, 6, 7, 2, 7, 3, -1, -1, -1, -1 },
+	{ 1, 2, 6, 1, 6, 7, 1, 7, 8, 1, 8, 4, 1, 4, 5, -1 },
+	{ 1, 10, 6, 1, 6, 7, 1, 7, 3, 4, 5, 9, -1, -1, -1, -1 },
+	{ 0, 1, 10, 0, 10, 6, 0, 6, 7, 0, 7, 8, 4, 5, 9, -1 },
+	{ 0, 4, 5, 0, 5, 10, 0, 10, 6, 0, 6, 7, 0, 7, 3, -1 },
+	{ 4, 5, 10, 4, 10, 6, 4, 6, 7, 4, 7, 8, -1, -1, -1, -1 },
+	{ 5, 9, 8, 5, 8, 11, 5, 11, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1 },
+	{ 0, 8, 11, 0, 11, 6, 0, 6, 5, 0, 5, 1, -1, -1, -1, -1 },
+	{ 1, 3, 11, 1, 11, 6, 1, 6, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 5, 9, 8, 5, 8, 11, 5, 11, 6, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 6, 0, 6, 5, 0, 5, 9, 1, 10, 2, -1 },
+	{ 0, 8, 11, 0, 11, 6, 0, 6, 5, 0, 5, 10, 0, 10, 2, -1 },
+	{ 2, 3, 11, 2, 11, 6, 2, 6, 5, 2, 5, 10, -1, -1, -1, -1 },
+	{ 2, 6, 5, 2, 5, 9, 2, 9, 8, 2, 8, 3, -1, -1, -1, -1 },
+	{ 0, 2, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 8, 3, 0, 3, 2, 0, 2, 6, 0, 6, 5, 0, 5, 1, -1 },
+	{ 1, 2, 6, 1, 6, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 6, 1, 6, 5, 1, 5, 9, 1, 9, 8, 1, 8, 3, -1 },
+	{ 0, 1, 10, 0, 10, 6, 0, 6, 5, 0, 5, 9, -1, -1, -1, -1 },
+	{ 0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 7, 11, 5, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 5, 7, 11, 5, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 5, 7, 11, 5, 11, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 9, 5, 7, 11, 5, 11, 10, -1, -1, -1, -1 },
+	{ 1, 5, 7, 1, 7, 11, 1, 11, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 5, 7, 1, 7, 11, 1, 11, 2, -1, -1, -1, -1 },
+	{ 0, 9, 5, 0, 5, 7, 0, 7, 11, 0, 11, 2, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 9, 2, 9, 5, 2, 5, 7, 2, 7, 11, -1 },
+	{ 2, 10, 5, 2, 5, 7, 2, 7, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 10, 0, 10, 5, 0, 5, 7, 0, 7, 8, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 10, 5, 2, 5, 7, 2, 7, 3, -1, -1, -1, -1 },
+	{ 1, 2, 10, 1, 10, 5, 1, 5, 7, 1, 7, 8, 1, 8, 9, -1 },
+	{ 1, 5, 7, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 5, 0, 5, 7, 0, 7, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 5, 0, 5, 7, 0, 7, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 7, 8, 5, 8, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 11, 4, 11, 10, 4, 10, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 10, 0, 10, 5, 0, 5, 4, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 11, 4, 11, 10, 4, 10, 5, -1, -1, -1, -1 },
+	{ 1, 3, 11, 1, 11, 10, 1, 10, 5, 1, 5, 4, 1, 4, 9, -1 },
+	{ 1, 5, 4, 1, 4, 8, 1, 8, 11, 1, 11, 2, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 2, 0, 2, 1, 0, 1, 5, 0, 5, 4, -1 },
+	{ 0, 9, 5, 0, 5, 4, 0, 4, 8, 0, 8, 11, 0, 11, 2, -1 },
+	{ 2, 3, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 10, 5, 2, 5, 4, 2, 4, 8, 2, 8, 3, -1, -1, -1, -1 },
+	{ 0, 2, 10, 0, 10, 5, 0, 5, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 10, 5, 2, 5, 4, 2, 4, 8, 2, 8, 3, -1 },
+	{ 1, 2, 10, 1, 10, 5, 1, 5, 4, 1, 4, 9, -1, -1, -1, -1 },
+	{ 1, 5, 4, 1, 4, 8, 1, 8, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 5, 0, 5, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 5, 0, 5, 4, 0, 4, 8, 0, 8, 3, -1, -1, -1, -1 },
+	{ 4, 9, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 7, 11, 4, 11, 10, 4, 10, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 4, 7, 11, 4, 11, 10, 4, 10, 9, -1, -1, -1, -1 },
+	{ 0, 4, 7, 0, 7, 11, 0, 11, 10, 0, 10, 1, -1, -1, -1, -1 },
+	{ 1, 3, 8, 1, 8, 4, 1, 4, 7, 1, 7, 11, 1, 11, 10, -1 },
+	{ 1, 9, 4, 1, 4, 7, 1, 7, 11, 1, 11, 2, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 9, 4, 1, 4, 7, 1, 7, 11, 1, 11, 2, -1 },
+	{ 0, 4, 7, 0, 7, 11, 0, 11, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 8, 2, 8, 4, 2, 4, 7, 2, 7, 11, -1, -1, -1, -1 },
+	{ 2, 10, 9, 2, 9, 4, 2, 4, 7, 2, 7, 3, -1, -1, -1, -1 },
+	{ 0, 2, 10, 0, 10, 9, 0, 9, 4, 0, 4, 7, 0, 7, 8, -1 },
+	{ 0, 4, 7, 0, 7, 3, 0, 3, 2, 0, 2, 10, 0, 10, 1, -1 },
+	{ 1, 2, 10, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 9, 4, 1, 4, 7, 1, 7, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 9, 0, 9, 4, 0, 4, 7, 0, 7, 8, -1, -1, -1, -1 },
+	{ 0, 4, 7, 0, 7, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 11, 10, 8, 10, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 10, 0, 10, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 8, 11, 0, 11, 10, 0, 10, 1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 3, 11, 1, 11, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 9, 8, 1, 8, 11, 1, 11, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 11, 0, 11, 2, 0, 2, 1, 0, 1, 9, -1, -1, -1, -1 },
+	{ 0, 8, 11, 0, 11, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 10, 9, 2, 9, 8, 2, 8, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 2, 10, 0, 10, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 8, 3, 0, 3, 2, 0, 2, 10, 0, 10, 1, -1, -1, -1, -1 },
+	{ 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 9, 8, 1, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 }
+};
+
+typedef MarchingCubes<float> MarchingCubesf;
+typedef MarchingCubes<double> MarchingCubesd;
+
+} // namespace ml
+
+#endif // _COREMESH_MARCHINGCUBES_H_
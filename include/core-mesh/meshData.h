@@ -196,6 +196,11 @@ public:
 			m_Faces.clear();
 		}
 
+		//! heap bytes of the indices and faces
+		size_t memoryFootprint() const {
+			return util::memoryFootprint(m_Indices) + util::memoryFootprint(m_Faces);
+		}
+
 		//! resizes the index vector with the same valence
 		void resize(size_t numFaces, unsigned int faceValence = 3) {
 			if (size() != 0)	throw MLIB_EXCEPTION("not supported yet");
@@ -544,6 +549,18 @@ public:
 	bool hasNormalIndices() const { return m_FaceIndicesNormals.size() > 0; }
 	bool hasTexCoordsIndices() const { return m_FaceIndicesTextureCoords.size() > 0; }
 
+	//! bytes held by the mesh
+	size_t memoryFootprint() const {
+		size_t bytes = sizeof(*this) + util::memoryFootprint(m_Vertices) + util::memoryFootprint(m_Normals) +
+			util::memoryFootprint(m_TextureCoords) + util::memoryFootprint(m_Colors) + util::memoryFootprint(m_materialFile);
+		bytes += m_FaceIndicesVertices.memoryFootprint() + m_FaceIndicesNormals.memoryFootprint() +
+			m_FaceIndicesTextureCoords.memoryFootprint() + m_FaceIndicesColors.memoryFootprint();
+		bytes += util::memoryFootprint(m_indicesByMaterial) + util::memoryFootprint(m_indicesByGroup);
+		for (const GroupIndex& g : m_indicesByMaterial) bytes += util::memoryFootprint(g.name);
+		for (const GroupIndex& g : m_indicesByGroup) bytes += util::memoryFootprint(g.name);
+		return bytes;
+	}
+
 	//! todo check this
 	bool isEmpty() const {
 		return m_Vertices.size() == 0 && m_FaceIndicesVertices.size() == 0;
@@ -16,6 +16,8 @@ public:
 	}
 
 	static void loadFromFile(const std::string& filename, MeshData<FloatType>& mesh, bool bIgnoreNans = false) {
+		MLIB_PROFILE_ZONE("MeshIO::loadFromFile");
+		MLIB_MEMORY_SCOPE(MEMORY_MESH);
 		mesh.clear();
 		std::string extension = util::getFileExtension(filename);
 
@@ -37,6 +39,7 @@ public:
 	}
 
 	static void saveToFile(const std::string& filename, const MeshData<FloatType>& mesh) {
+		MLIB_PROFILE_ZONE("MeshIO::saveToFile");
 
 		if (mesh.isEmpty()) {		
 			MLIB_WARNING("empty mesh: " + filename);
@@ -7,7 +7,7 @@ namespace ml {
 	template<class FloatType>
 	TriMesh<FloatType>::TriMesh(const MeshData<FloatType>& meshData)
 	{
-		
+		MLIB_MEMORY_SCOPE(MEMORY_MESH);
 		m_vertices.resize(meshData.m_Vertices.size());
 
 		m_bHasNormals = meshData.m_Normals.size() > 0;
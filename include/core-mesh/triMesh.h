@@ -112,6 +112,11 @@ namespace ml {
 				return m_Center;
 			}
 
+			//! recomputes the cached center after the vertex positions changed
+			void updateCenter() {
+				m_Center = (v0->position + v1->position + v2->position)/(FloatType)3.0;
+			}
+
 			const Vertex& getV0() const {
 				return *v0;
 			}
@@ -385,6 +390,9 @@ namespace ml {
 		std::vector<Vertex>& getVertices() { return m_vertices; }
 		std::vector<vec3ui>& getIndices() { return m_indices; }
 
+		//! bytes held by the mesh
+		size_t memoryFootprint() const { return sizeof(*this) + util::memoryFootprint(m_vertices) + util::memoryFootprint(m_indices); }
+
 		void computeMeshData(MeshData<FloatType>& meshData) const {
 
 			meshData.clear();
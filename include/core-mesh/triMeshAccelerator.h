@@ -25,24 +25,8 @@ public:
 	}
 
 	void build(const std::vector<const TriMesh<FloatType>* >& triMeshes, bool storeLocalCopy = false) {
-		destroy();
-		std::vector<const std::vector<typename TriMesh<FloatType>::Vertex>*> vertices(triMeshes.size());
-		std::vector<const std::vector<vec3ui>*> indices(triMeshes.size());
-
-		if (storeLocalCopy) {
-			m_VerticesCopy.resize(triMeshes.size());
-			for (size_t i = 0; i < triMeshes.size(); i++) {
-				m_VerticesCopy[i] = triMeshes[i]->getVertices();
-				vertices[i] = &m_VerticesCopy[i];
-				indices[i] = &triMeshes[i]->getIndices();
-			}
-		} else {
-			for (size_t i = 0; i < triMeshes.size(); i++) {
-				vertices[i] = &triMeshes[i]->getVertices();
-				indices[i] = &triMeshes[i]->getIndices();
-			}
-		}
-		createTrianglePointers(vertices, indices);
+		MLIB_MEMORY_SCOPE(MEMORY_ACCELERATOR);
+		bindMeshes(triMeshes, storeLocalCopy);
 
 		buildInternal();	//construct the acceleration structure
 	}
@@ -55,6 +39,7 @@ public:
 
 	//! constructs the acceleration structure; always generates an internal copy
 	void build(const std::vector<std::pair<const TriMesh<FloatType>*, Matrix4x4<FloatType>>>& triMeshPairs) {
+		MLIB_MEMORY_SCOPE(MEMORY_ACCELERATOR);
 		destroy();
 
 		std::vector<const std::vector<typename TriMesh<FloatType>::Vertex>*> vertices(triMeshPairs.size());
@@ -71,15 +56,73 @@ public:
 			indices[i] = &triMeshPairs[i].first->getIndices();
 		}
 		createTrianglePointers(vertices, indices);
+		computeBoundingBox();
 
 		buildInternal();	//construct the acceleration structure
 	}
 
+	//! updates the structure after vertex positions (but not the topology) changed; meshes that were built without a local copy
+	//! are referenced directly, so calling refit() after modifying them suffices
+	void refit() {
+		MLIB_MEMORY_SCOPE(MEMORY_ACCELERATOR);
+		for (auto& tri : m_Triangles) {
+			tri.updateCenter();
+		}
+		computeBoundingBox();
+		refitInternal();
+	}
+
+	void refit(const TriMesh<FloatType>& mesh) {
+		std::vector<const TriMesh<FloatType>* > meshes;
+		meshes.push_back(&mesh);
+		refit(meshes);
+	}
+
+	//! copies the new vertex positions into the local copy (if the structure was built with one) and refits; the meshes must match the ones passed to build
+	void refit(const std::vector<const TriMesh<FloatType>* >& triMeshes) {
+		if (!m_VerticesCopy.empty()) {
+			if (m_VerticesCopy.size() != triMeshes.size()) throw MLIB_EXCEPTION("number of meshes changed; call build instead");
+			for (size_t i = 0; i < triMeshes.size(); i++) {
+				const auto& vertices = triMeshes[i]->getVertices();
+				if (vertices.size() != m_VerticesCopy[i].size()) throw MLIB_EXCEPTION("number of vertices changed; call build instead");
+				for (size_t j = 0; j < vertices.size(); j++) {
+					m_VerticesCopy[i][j].position = vertices[j].position;
+				}
+			}
+		}
+		refit();
+	}
+
+	//! same as above for structures built from transformed meshes
+	void refit(const std::vector<std::pair<const TriMesh<FloatType>*, Matrix4x4<FloatType>>>& triMeshPairs) {
+		if (m_VerticesCopy.size() != triMeshPairs.size()) throw MLIB_EXCEPTION("number of meshes changed; call build instead");
+		for (size_t i = 0; i < triMeshPairs.size(); i++) {
+			const auto& vertices = triMeshPairs[i].first->getVertices();
+			if (vertices.size() != m_VerticesCopy[i].size()) throw MLIB_EXCEPTION("number of vertices changed; call build instead");
+			for (size_t j = 0; j < vertices.size(); j++) {
+				m_VerticesCopy[i][j].position = triMeshPairs[i].second * vertices[j].position;
+			}
+		}
+		refit();
+	}
+
 	size_t triangleCount() const
 	{
 		return m_Triangles.size();
 	}
 
+	//! bounding box of all triangles (in the space of the meshes passed to build)
+	const BoundingBox3<FloatType>& getBoundingBox() const
+	{
+		return m_BoundingBox;
+	}
+
+	//! bytes held by the structure; meshes that were built without a local copy are referenced and not included
+	virtual size_t memoryFootprint() const
+	{
+		return sizeof(*this) + getSharedMemoryFootprint();
+	}
+
 protected:
 
 	//template <class FloatType = FloatType> using Vertex = typename TriMesh<FloatType>::Vertex;
@@ -88,6 +131,61 @@ protected:
 	std::vector<std::vector< typename TriMesh<FloatType>::Vertex> >	m_VerticesCopy;
 	std::vector<typename TriMesh<FloatType>::Triangle>				m_Triangles;
 	std::vector<typename TriMesh<FloatType>::Triangle*>				m_TrianglePointers;
+	BoundingBox3<FloatType>											m_BoundingBox;
+
+	//! heap bytes of the triangles and local vertex copies (for the memoryFootprint of derived classes)
+	size_t getSharedMemoryFootprint() const
+	{
+		return util::memoryFootprint(m_VerticesCopy) + util::memoryFootprint(m_Triangles) + util::memoryFootprint(m_TrianglePointers);
+	}
+
+	//! references the meshes (or copies of their vertices) without building the structure
+	void bindMeshes(const std::vector<const TriMesh<FloatType>* >& triMeshes, bool storeLocalCopy) {
+		destroy();
+		std::vector<const std::vector<typename TriMesh<FloatType>::Vertex>*> vertices(triMeshes.size());
+		std::vector<const std::vector<vec3ui>*> indices(triMeshes.size());
+
+		if (storeLocalCopy) {
+			m_VerticesCopy.resize(triMeshes.size());
+			for (size_t i = 0; i < triMeshes.size(); i++) {
+				m_VerticesCopy[i] = triMeshes[i]->getVertices();
+				vertices[i] = &m_VerticesCopy[i];
+				indices[i] = &triMeshes[i]->getIndices();
+			}
+		} else {
+			for (size_t i = 0; i < triMeshes.size(); i++) {
+				vertices[i] = &triMeshes[i]->getVertices();
+				indices[i] = &triMeshes[i]->getIndices();
+			}
+		}
+		createTrianglePointers(vertices, indices);
+		computeBoundingBox();
+	}
+
+	//! takes over per-mesh vertex arrays in which every three consecutive vertices form a triangle (kept as local copy) without building the structure
+	void bindTriangleSoups(std::vector<std::vector<typename TriMesh<FloatType>::Vertex>>& soups) {
+		destroy();
+		m_VerticesCopy.swap(soups);
+
+		std::vector<std::vector<vec3ui>> indexStorage(m_VerticesCopy.size());
+		std::vector<const std::vector<typename TriMesh<FloatType>::Vertex>*> vertices(m_VerticesCopy.size());
+		std::vector<const std::vector<vec3ui>*> indices(m_VerticesCopy.size());
+		for (size_t i = 0; i < m_VerticesCopy.size(); i++) {
+			for (unsigned int j = 0; j + 2 < (unsigned int)m_VerticesCopy[i].size(); j += 3) {
+				indexStorage[i].push_back(vec3ui(j, j + 1, j + 2));
+			}
+			vertices[i] = &m_VerticesCopy[i];
+			indices[i] = &indexStorage[i];
+		}
+		createTrianglePointers(vertices, indices);
+		computeBoundingBox();
+	}
+
+	void destroy() {
+		m_Triangles.clear();
+		m_TrianglePointers.clear();
+		m_VerticesCopy.clear();
+	}
 
 private:
 
@@ -122,10 +220,11 @@ private:
 		}
 	}
 
-	void destroy() {
-		m_Triangles.clear();
-		m_TrianglePointers.clear();
-		m_VerticesCopy.clear();
+	void computeBoundingBox() {
+		m_BoundingBox.reset();
+		for (const auto& tri : m_Triangles) {
+			tri.includeInBoundingBox(m_BoundingBox);
+		}
 	}
 
 	//////////////////////////////////////////////////////////////////////////
@@ -134,6 +233,11 @@ private:
 
 	//! given protected data above filed, the data structure is constructed
 	virtual void buildInternal() = 0;
+
+	//! the vertex positions of the triangles changed; structures that support refitting override this, by default the structure is rebuilt
+	virtual void refitInternal() {
+		buildInternal();
+	}
 };
 
 } // namespace ml
@@ -7,18 +7,17 @@ namespace ml {
 
 template <class FloatType>
 struct TriangleBVHNode {
-	TriangleBVHNode() : rChild(0), lChild(0), leafTri(0) {}
-	~TriangleBVHNode() {
-		SAFE_DELETE(rChild);
-		SAFE_DELETE(lChild);
-	}
+	//! nodes do not own their children; they live in a node array filled by TriangleBVHBuilder
+	TriangleBVHNode() : leafTris(0), numLeafTris(0), splitAxis(0), lChild(0), rChild(0) {}
 
 	//wait for vs 2013
 	//template<class T>
 	//using Triangle = TriMesh::Triangle<T>;
 
 	BoundingBox3<FloatType> boundingBox;
-	const typename TriMesh<FloatType>::Triangle* leafTri;
+	typename TriMesh<FloatType>::Triangle* const* leafTris;	//! first triangle of a leaf (points into the accelerator's triangle pointers)
+	unsigned int numLeafTris;								//! number of triangles of a leaf
+	unsigned int splitAxis;									//! axis the children were split along (the left child holds the smaller centroids)
 
 
 	TriangleBVHNode<FloatType> *lChild;
@@ -28,7 +27,9 @@ struct TriangleBVHNode {
 		boundingBox.reset();
 		
 		if (!lChild && !rChild) {
-			leafTri->includeInBoundingBox(boundingBox);
+			for (unsigned int i = 0; i < numLeafTris; i++) {
+				leafTris[i]->includeInBoundingBox(boundingBox);
+			}
 		} else {
 			if (lChild)	{
 				lChild->computeBoundingBox();
@@ -41,102 +42,240 @@ struct TriangleBVHNode {
 		}
 	}
 
-	void splitMidPoint(typename std::vector<typename TriMesh<FloatType>::Triangle*>::iterator& begin, typename std::vector<typename TriMesh<FloatType>::Triangle*>::iterator& end) {
-		if (end - begin > 1) {
-			//determine longest axis
-			BoundingBox3<FloatType> bbox;
-			for (auto iter = begin; iter != end; iter++) {
-				bbox.include((*iter)->getCenter());
-			}
+	void setLeaf(typename std::vector<typename TriMesh<FloatType>::Triangle*>::iterator begin, typename std::vector<typename TriMesh<FloatType>::Triangle*>::iterator end) {
+		leafTris = &(*begin);
+		numLeafTris = (unsigned int)(end - begin);
+	}
 
-			FloatType maxExtent = bbox.getMaxExtent();
-			typename std::vector<typename TriMesh<FloatType>::Triangle*>::iterator midIter = begin + 1;
-			if (bbox.getExtentX() > bbox.getExtentY() && bbox.getExtentX() > bbox.getExtentZ())	{
-				//x
-				std::stable_sort(begin, end, cmpX);
-				FloatType middle = bbox.getMinX() + maxExtent / 2;
-				for (; midIter != end - 1; midIter++) {
-					if ((*midIter)->getCenter().x >= middle) break;
-				}
-			}
-			else if (bbox.getExtentY() > bbox.getExtentX() && bbox.getExtentY() > bbox.getExtentZ()) {
-				//y
-				std::stable_sort(begin, end, cmpY);
-				FloatType middle = bbox.getMinY() + maxExtent / 2;
-				for (; midIter != end - 1; midIter++) {
-					if ((*midIter)->getCenter().y >= middle) break;
+	//! scratch data of the binned SAH build (one entry per bin)
+	struct SAHBin {
+		BoundingBox3<FloatType> bounds;
+		size_t count;
+		FloatType rightArea;	//! surface area of this and all bins to the right
+		size_t rightCount;		//! number of triangles in this and all bins to the right
+	};
+
+	//! relative cost of traversing an inner node vs. intersecting a triangle (SAH cost model)
+	static FloatType getSAHTraversalCost() {
+		return (FloatType)1;
+	}
+
+	//! separating axis test between boxes of this tree and boxes of another tree placed by an affine transform (other -> this); the
+	//! transformed boxes are tested as oriented boxes (15 axes: the axes of both boxes and their cross products), and everything that
+	//! only depends on the transform, including its inverse, is computed once per query
+	struct TransformedBoxTest {
+		TransformedBoxTest(const Matrix4x4<FloatType>& _transform) : transform(_transform) {
+			assert(transform.isAffine());
+			const Matrix4x4<FloatType> invTransform = transform.getInverse();
+			for (unsigned int i = 0; i < 3; i++) {
+				for (unsigned int j = 0; j < 3; j++) {
+					absRotation[i][j] = std::abs(transform(i, j));
 				}
+				otherAxes[i] = vec3<FloatType>(invTransform(i, 0), invTransform(i, 1), invTransform(i, 2));
+				absOtherAxes[i] = vec3<FloatType>(std::abs(otherAxes[i].x), std::abs(otherAxes[i].y), std::abs(otherAxes[i].z));
 			}
-			else {
-				//z
-				std::stable_sort(begin, end, cmpZ);
-				FloatType middle = bbox.getMinZ() + maxExtent / 2;
-				for (; midIter != end - 1; midIter++) {
-					if ((*midIter)->getCenter().z >= middle) break;
+
+			//cross products of the axes; (nearly) parallel axes give no separating axis that is not already tested
+			numCrossAxes = 0;
+			for (unsigned int i = 0; i < 3; i++) {
+				vec3<FloatType> e = vec3<FloatType>::origin;
+				e[i] = (FloatType)1;
+				for (unsigned int j = 0; j < 3; j++) {
+					const vec3<FloatType> a(transform(0, j), transform(1, j), transform(2, j));
+					const vec3<FloatType> l = e ^ a;
+					if (l.lengthSq() <= (FloatType)1e-6 * a.lengthSq()) continue;
+					crossAxes[numCrossAxes] = l;
+					absCrossAxes[numCrossAxes] = vec3<FloatType>(std::abs(l.x), std::abs(l.y), std::abs(l.z));
+					for (unsigned int k = 0; k < 3; k++) {
+						crossOtherRadii[numCrossAxes][k] = std::abs(vec3<FloatType>(transform(0, k), transform(1, k), transform(2, k)) | l);
+					}
+					numCrossAxes++;
 				}
 			}
 
-			lChild = new TriangleBVHNode;
-			rChild = new TriangleBVHNode;
+			maxScale = (FloatType)0;
+			for (unsigned int i = 0; i < 3; i++) {
+				maxScale = std::max(maxScale, absRotation[i][0] + absRotation[i][1] + absRotation[i][2]);
+				otherAxisNorms[i] = absOtherAxes[i].x + absOtherAxes[i].y + absOtherAxes[i].z;
+			}
+			for (unsigned int k = 0; k < numCrossAxes; k++) {
+				crossAxisNorms[k] = absCrossAxes[k].x + absCrossAxes[k].y + absCrossAxes[k].z;
+			}
+		}
 
-			lChild->splitMidPoint(begin, midIter);
-			rChild->splitMidPoint(midIter, end);
+		//! false if there is a separating axis between box (in the space of this tree) and otherBox (in the space of the other tree); boxes
+		//! that only touch overlap, up to the rounding error of the center/extent form (which is added as a tolerance to stay conservative)
+		bool overlaps(const BoundingBox3<FloatType>& box, const BoundingBox3<FloatType>& otherBox) const {
+			const vec3<FloatType> extent = box.getExtent() * (FloatType)0.5;
+			const vec3<FloatType> otherExtent = otherBox.getExtent() * (FloatType)0.5;
+			const vec3<FloatType> center = box.getCenter();
+			const vec3<FloatType> otherCenter = transform.transformAffine(otherBox.getCenter());
+			const vec3<FloatType> d = otherCenter - center;
+			const FloatType tolerance = (FloatType)16 * std::numeric_limits<FloatType>::epsilon() *
+				(maxAbs(center) + maxAbs(otherCenter) + std::max(std::max(extent.x, extent.y), extent.z) + maxScale * std::max(std::max(otherExtent.x, otherExtent.y), otherExtent.z));
 
+			//axes of box
+			for (unsigned int i = 0; i < 3; i++) {
+				const FloatType r = absRotation[i][0] * otherExtent.x + absRotation[i][1] * otherExtent.y + absRotation[i][2] * otherExtent.z;
+				if (std::abs(d[i]) > extent[i] + r + tolerance) return false;
+			}
+			//face normals of the transformed box (the rows of the inverse also cover scaling and shearing)
+			for (unsigned int j = 0; j < 3; j++) {
+				if (std::abs(otherAxes[j] | d) > (absOtherAxes[j] | extent) + otherExtent[j] + otherAxisNorms[j] * tolerance) return false;
+			}
+			for (unsigned int k = 0; k < numCrossAxes; k++) {
+				if (std::abs(crossAxes[k] | d) > (absCrossAxes[k] | extent) + (crossOtherRadii[k] | otherExtent) + crossAxisNorms[k] * tolerance) return false;
+			}
+			return true;
 		}
-		else {
-			assert(end - begin == 1);
-			leafTri = *begin;	//found a leaf
+
+		static FloatType maxAbs(const vec3<FloatType>& v) {
+			return std::max(std::max(std::abs(v.x), std::abs(v.y)), std::abs(v.z));
 		}
-	}
 
-	void splitMedian(typename std::vector<typename TriMesh<FloatType>::Triangle*>::iterator& begin, typename std::vector<typename TriMesh<FloatType>::Triangle*>::iterator& end, unsigned int lastSortAxis) {
+		Matrix4x4<FloatType> transform;
+		FloatType absRotation[3][3];		//! absolute values of the linear part of transform
+		vec3<FloatType> otherAxes[3];		//! face normals of the transformed box (rows of the inverse transform)
+		vec3<FloatType> absOtherAxes[3];
+		vec3<FloatType> crossAxes[9];		//! cross products of the axes of this and the transformed box
+		vec3<FloatType> absCrossAxes[9];
+		vec3<FloatType> crossOtherRadii[9];	//! projections of the transformed box axes onto crossAxes
+		unsigned int numCrossAxes;
+		FloatType maxScale;					//! bounds the largest component of a transformed vector relative to the largest component of the vector
+		FloatType otherAxisNorms[3];		//! L1 norms of otherAxes and crossAxes, which scale the tolerance of the projections
+		FloatType crossAxisNorms[9];
+	};
 
-		if (end - begin > 1) {
-			if (lastSortAxis == 0)		std::stable_sort(begin, end, cmpX);
-			else if (lastSortAxis == 1)	std::stable_sort(begin, end, cmpY);
-			else						std::stable_sort(begin, end, cmpZ);
+	static unsigned int computeSAHBin(FloatType c, FloatType minC, FloatType scale, unsigned int numBins) {
+		const unsigned int b = (unsigned int)((c - minC) * scale);
+		return std::min(b, numBins - 1);
+	}
 
-			lChild = new TriangleBVHNode;
-			rChild = new TriangleBVHNode;
+	inline bool isLeaf() const {
+		return !(lChild || rChild);
+	}
 
-			const unsigned int newSortAxis = (lastSortAxis + 1) % 3;
-			lChild->splitMedian(begin, begin + ((end - begin) / 2), newSortAxis);
-			rChild->splitMedian(begin + ((end - begin) / 2), end, newSortAxis);
+	//! iterative front-to-back traversal: the child on the near side of the split plane is visited first and tmax shrinks with every hit,
+	//! so the slab test culls farther subtrees; stack must hold at least getTreeDepthRec() entries (t must be initialized to tmax)
+	const typename TriMesh<FloatType>::Triangle* intersect(const Ray<FloatType> &r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin, FloatType tmax, bool onlyFrontFaces, const TriangleBVHNode** stack, typename TriMeshRayAccelerator<FloatType>::TraversalStats* stats = nullptr) const {
+		const vec3i& sign = r.getSign();
+		const typename TriMesh<FloatType>::Triangle* hit = nullptr;
 
+		unsigned int stackSize = 0;
+		const TriangleBVHNode* node = this;
+		while (true) {
+			if (stats) stats->numNodeTests++;
+			if (node->boundingBox.intersect(r, tmin, tmax)) {
+				if (node->isLeaf()) {
+					if (stats) stats->numTriangleTests += node->numLeafTris;
+					for (unsigned int i = 0; i < node->numLeafTris; i++) {
+						if (node->leafTris[i]->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces))	{
+							tmax = t;
+							hit = node->leafTris[i];
+						}
+					}
+				} else {
+					if (sign[node->splitAxis]) {
+						stack[stackSize++] = node->lChild;
+						node = node->rChild;
+					} else {
+						stack[stackSize++] = node->rChild;
+						node = node->lChild;
+					}
+					continue;
+				}
+			}
+			if (stackSize == 0) break;
+			node = stack[--stackSize];
 		}
-		else {
-			assert(end - begin == 1);
-			leafTri = *begin;	//found a leaf
-		}
+		return hit;
 	}
 
-	inline bool isLeaf() const {
-		return !(lChild || rChild);
+	//! any-hit traversal; returns as soon as a triangle is hit within [tmin, tmax] (same stack requirements as intersect)
+	bool occluded(const Ray<FloatType> &r, FloatType tmin, FloatType tmax, bool onlyFrontFaces, const TriangleBVHNode** stack) const {
+		const vec3i& sign = r.getSign();
+		FloatType t, u, v;
+
+		unsigned int stackSize = 0;
+		const TriangleBVHNode* node = this;
+		while (true) {
+			if (node->boundingBox.intersect(r, tmin, tmax)) {
+				if (node->isLeaf()) {
+					for (unsigned int i = 0; i < node->numLeafTris; i++) {
+						if (node->leafTris[i]->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces)) return true;
+					}
+				} else {
+					if (sign[node->splitAxis]) {
+						stack[stackSize++] = node->lChild;
+						node = node->rChild;
+					} else {
+						stack[stackSize++] = node->rChild;
+						node = node->lChild;
+					}
+					continue;
+				}
+			}
+			if (stackSize == 0) break;
+			node = stack[--stackSize];
+		}
+		return false;
 	}
 
-	const typename TriMesh<FloatType>::Triangle* intersect(const Ray<FloatType> &r, FloatType& t, FloatType& u, FloatType& v, FloatType& tmin, FloatType& tmax, bool onlyFrontFaces = false) const {
-		if (t < tmin || t > tmax)	return nullptr;	//early out (warning t must be initialized)
-		if (boundingBox.intersect(r, tmin, tmax)) {
-			if (isLeaf()) {
-				if (leafTri->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces))	{
-					tmax = t;
-					return leafTri;
+	//! nearest-first closest point search: the child whose box is closer to p is visited first and boxes farther than the current
+	//! best distance are pruned; distSq must be initialized to the squared search radius; stack must hold getTreeDepthRec() entries
+	const typename TriMesh<FloatType>::Triangle* closestPoint(const vec3<FloatType>& p, FloatType& distSq, vec3<FloatType>& pos, FloatType& u, FloatType& v, std::pair<const TriangleBVHNode*, FloatType>* stack) const {
+		const typename TriMesh<FloatType>::Triangle* best = nullptr;
+
+		unsigned int stackSize = 0;
+		const TriangleBVHNode* node = this;
+		FloatType nodeDistSq = boundingBox.getDistanceSq(p);
+		while (true) {
+			if (nodeDistSq < distSq) {
+				if (node->isLeaf()) {
+					for (unsigned int i = 0; i < node->numLeafTris; i++) {
+						const typename TriMesh<FloatType>::Triangle* tri = node->leafTris[i];
+						FloatType triU, triV;
+						const vec3<FloatType> c = math::triangleClosestPoint(tri->getV0().position, tri->getV1().position, tri->getV2().position, p, triU, triV);
+						const FloatType d = vec3<FloatType>::distSq(c, p);
+						if (d < distSq) {
+							distSq = d;
+							pos = c;
+							u = triU;
+							v = triV;
+							best = tri;
+						}
+					}
+				} else {
+					const FloatType dl = node->lChild->boundingBox.getDistanceSq(p);
+					const FloatType dr = node->rChild->boundingBox.getDistanceSq(p);
+					if (dl <= dr) {
+						stack[stackSize++] = std::make_pair(node->rChild, dr);
+						node = node->lChild;
+						nodeDistSq = dl;
+					} else {
+						stack[stackSize++] = std::make_pair(node->lChild, dl);
+						node = node->rChild;
+						nodeDistSq = dr;
+					}
+					continue;
 				}
-			} else {
-				const typename TriMesh<FloatType>::Triangle* t0 = lChild->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces);
-				const typename TriMesh<FloatType>::Triangle* t1 = rChild->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces);
-				if (t1)	return t1;
-				if (t0)	return t0;
 			}
-		} 
-		return nullptr;
+			if (stackSize == 0) break;
+			stackSize--;
+			node = stack[stackSize].first;
+			nodeDistSq = stack[stackSize].second;
+		}
+		return best;
 	}
 
     // collisions with other Triangles
 	bool intersects(const typename TriMesh<FloatType>::Triangle* tri) const {
 		if (boundingBox.intersects(tri->getV0().position, tri->getV1().position, tri->getV2().position)) {
 			if (isLeaf()) {
-				return tri->intersects(*leafTri);
+				for (unsigned int i = 0; i < numLeafTris; i++) {
+					if (tri->intersects(*leafTris[i])) return true;
+				}
+				return false;
 			} else {
 				return lChild->intersects(tri) || rChild->intersects(tri);
 			}
@@ -153,7 +292,10 @@ struct TriangleBVHNode {
 
         if (boundingBox.intersects(triTrans.getV0().position, triTrans.getV1().position, triTrans.getV2().position)) {
             if (isLeaf()) {
-                return triTrans.intersects(*leafTri);
+                for (unsigned int i = 0; i < numLeafTris; i++) {
+                    if (triTrans.intersects(*leafTris[i])) return true;
+                }
+                return false;
             }
             else {
                 return lChild->intersects(&triTrans) || rChild->intersects(&triTrans);
@@ -168,7 +310,10 @@ struct TriangleBVHNode {
 	bool intersects(const TriangleBVHNode& other) const {
 		if (boundingBox.intersects(other.boundingBox)) {
 			if (isLeaf()) {
-				return other.intersects(leafTri);
+				for (unsigned int i = 0; i < numLeafTris; i++) {
+					if (other.intersects(leafTris[i])) return true;
+				}
+				return false;
 			} else {
 				return lChild->intersects(other) || rChild->intersects(other);
 			}
@@ -177,33 +322,68 @@ struct TriangleBVHNode {
 		}
 	}
 
-    bool intersects(const TriangleBVHNode& other, const Matrix4x4<FloatType>& transform) const {
-        if (boundingBox.intersects(other.boundingBox * transform)) { //TODO fix OBB
-            if (isLeaf()) {
-                return other.intersects(leafTri, transform.getInverse());
-            }
-            else {
-                return lChild->intersects(other, transform) || rChild->intersects(other, transform);
-            }
-        }
-        else {
-            return false;
-        }
-    }
+	//! simultaneous descent of both trees (the node with the larger box is split first); calls f(triangle of this tree, triangle of other)
+	//! for every intersecting pair and stops as soon as f returns false; returns false if it was stopped
+	template<class F>
+	bool forEachIntersectingPair(const TriangleBVHNode& other, F& f) const {
+		if (!boundingBox.intersects(other.boundingBox)) return true;
+		if (isLeaf() && other.isLeaf()) {
+			for (unsigned int i = 0; i < numLeafTris; i++) {
+				const typename TriMesh<FloatType>::Triangle* tri = leafTris[i];
+				if (!other.boundingBox.intersects(BoundingBox3<FloatType>(tri->getV0().position, tri->getV1().position, tri->getV2().position))) continue;
+				for (unsigned int j = 0; j < other.numLeafTris; j++) {
+					if (tri->intersects(*other.leafTris[j]) && !f(tri, other.leafTris[j])) return false;
+				}
+			}
+			return true;
+		}
+		if (other.isLeaf() || (!isLeaf() && boundingBox.getSurfaceArea() >= other.boundingBox.getSurfaceArea())) {
+			return lChild->forEachIntersectingPair(other, f) && rChild->forEachIntersectingPair(other, f);
+		} else {
+			return forEachIntersectingPair(*other.lChild, f) && forEachIntersectingPair(*other.rChild, f);
+		}
+	}
 
-    bool collisionBBoxOnly(const TriangleBVHNode& other, const Matrix4x4<FloatType>& transform) const {
-        if (boundingBox.intersects(other.boundingBox * transform)) { //TODO fix OBB
-            if (isLeaf()) {
-                return true;
-            }
-            else {
-                return lChild->collisionBBoxOnly(other, transform) || rChild->collisionBBoxOnly(other, transform);
-            }
-        }
-        else {
-            return false;
-        }
-    }
+	//! simultaneous descent of both trees, where the other tree is placed by test.transform (see forEachIntersectingPair above); the
+	//! triangles of the other tree's leaves are transformed into the space of this tree
+	template<class F>
+	bool forEachIntersectingPair(const TriangleBVHNode& other, const TransformedBoxTest& test, F& f) const {
+		if (!test.overlaps(boundingBox, other.boundingBox)) return true;
+		if (isLeaf() && other.isLeaf()) {
+			for (unsigned int j = 0; j < other.numLeafTris; j++) {
+				const typename TriMesh<FloatType>::Triangle* otherTri = other.leafTris[j];
+				const vec3<FloatType> p0 = test.transform.transformAffine(otherTri->getV0().position);
+				const vec3<FloatType> p1 = test.transform.transformAffine(otherTri->getV1().position);
+				const vec3<FloatType> p2 = test.transform.transformAffine(otherTri->getV2().position);
+				if (!boundingBox.intersects(BoundingBox3<FloatType>(p0, p1, p2))) continue;
+				for (unsigned int i = 0; i < numLeafTris; i++) {
+					const typename TriMesh<FloatType>::Triangle* tri = leafTris[i];
+					if (intersection::intersectTriangleTriangle(tri->getV0().position, tri->getV1().position, tri->getV2().position, p0, p1, p2) && !f(tri, otherTri)) return false;
+				}
+			}
+			return true;
+		}
+		if (other.isLeaf() || (!isLeaf() && boundingBox.getSurfaceArea() >= other.boundingBox.getSurfaceArea())) {
+			return lChild->forEachIntersectingPair(other, test, f) && rChild->forEachIntersectingPair(other, test, f);
+		} else {
+			return forEachIntersectingPair(*other.lChild, test, f) && forEachIntersectingPair(*other.rChild, test, f);
+		}
+	}
+
+	//! true if the box of a leaf of this tree overlaps the (transformed) root box of other
+	bool collisionBBoxOnly(const TriangleBVHNode& other, const TransformedBoxTest& test) const {
+		if (test.overlaps(boundingBox, other.boundingBox)) {
+			if (isLeaf()) {
+				return true;
+			}
+			else {
+				return lChild->collisionBBoxOnly(other, test) || rChild->collisionBBoxOnly(other, test);
+			}
+		}
+		else {
+			return false;
+		}
+	}
 
 
 
@@ -226,24 +406,429 @@ struct TriangleBVHNode {
 		if (lChild) numLeaves += lChild->getNumLeaves();
 		if (rChild) numLeaves += rChild->getNumLeaves();
 		if (!lChild && !rChild) {
-			assert(leafTri);
+			assert(leafTris);
 			numLeaves++;
 		}
 		return numLeaves;
 	}
 
+	//! expected cost of a random ray (SAH cost model; normalized by the root surface area)
+	FloatType computeSAHCostRec(FloatType invRootArea) const {
+		const FloatType relArea = boundingBox.getSurfaceArea() * invRootArea;
+		if (isLeaf()) return relArea * (FloatType)numLeafTris;
+		return relArea * getSAHTraversalCost() + lChild->computeSAHCostRec(invRootArea) + rChild->computeSAHCostRec(invRootArea);
+	}
+};
+
+//! Builds a TriangleBVHNode tree into a preallocated node array. Subtrees are spawned as tasks onto per-thread deques (idle threads steal the
+//! oldest, i.e., largest, tasks of others); the upper levels, where there are fewer subtrees than threads, use data-parallel bounds, binning and partitioning.
+template <class FloatType>
+class TriangleBVHBuilder
+{
+public:
+	typedef typename TriMesh<FloatType>::Triangle Triangle;
+	typedef typename TriangleBVHNode<FloatType>::SAHBin SAHBin;
+
+	enum SplitMode {
+		SPLIT_MEDIAN,	//! object median along alternating axes
+		SPLIT_MIDPOINT,	//! centroid midpoint of the longest axis
+		SPLIT_SAH		//! binned surface area heuristic (Wald 2007: On fast Construction of SAH-based Bounding Volume Hierarchies)
+	};
+
+	//! numThreads == 0 uses all hardware threads; numBins and maxLeafSize only affect SPLIT_SAH (the other modes create single triangle leaves)
+	TriangleBVHBuilder(SplitMode splitMode, unsigned int numThreads = 0, unsigned int numBins = 16, unsigned int maxLeafSize = 4) {
+		m_SplitMode = splitMode;
+		m_MaxThreads = numThreads > 0 ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+		m_NumThreads = 1;
+		m_NumBins = numBins;
+		m_MaxLeafSize = splitMode == SPLIT_SAH ? maxLeafSize : 1;
+		m_TaskGrain = 1024;
+		m_ParallelGrain = 1 << 16;
+	}
+
+	//! reorders tris and fills nodes; returns the root (nodes[0]), or nullptr if tris is empty; the bounding boxes are computed during the build
+	TriangleBVHNode<FloatType>* build(std::vector<Triangle*>& tris, std::vector<TriangleBVHNode<FloatType>>& nodes) {
+		nodes.clear();
+		if (tris.empty()) return nullptr;
 
-	static bool cmpX(typename TriMesh<FloatType>::Triangle *t0, typename TriMesh<FloatType>::Triangle *t1) {
-		return t0->getCenter().x < t1->getCenter().x;
+		//a binary tree over n triangles has at most 2n-1 nodes
+		nodes.resize(2 * tris.size() - 1);
+		m_Nodes = nodes.data();
+		m_NextNode = 1;
+		m_Tris = tris.data();
+		m_Scratch.resize(tris.size());
+
+		m_NumThreads = tris.size() < m_TaskGrain ? 1 : m_MaxThreads;
+		if (m_NumThreads == 1) {
+			initWorkers();
+			buildSubtree(0, m_Nodes, 0, tris.size(), 0);
+		} else {
+			initWorkers();
+			m_Done = false;
+			std::vector<std::thread> threads;
+			for (unsigned int i = 1; i < m_NumThreads; i++) {
+				threads.push_back(std::thread(&TriangleBVHBuilder::workerLoop, this, i));
+			}
+			spawn(0, [this, &tris](unsigned int worker) { buildSubtree(worker, m_Nodes, 0, tris.size(), 0); }, m_PendingSubtrees);
+			wait(0, m_PendingSubtrees);
+			m_Done = true;
+			for (auto& t : threads) t.join();
+		}
+
+		nodes.resize(m_NextNode);
+		m_Scratch.clear();
+		return &nodes[0];
+	}
+
+private:
+
+	struct Task {
+		std::function<void(unsigned int)> run;
+		std::atomic<size_t>* pending;	//! decremented once run has returned
+	};
+
+	//! deque of a single thread; the owner pushes and pops at the back, thieves take from the front
+	struct Worker {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+		std::vector<SAHBin> bins;
+	};
+
+	void initWorkers() {
+		m_Workers.clear();
+		for (unsigned int i = 0; i < m_NumThreads; i++) {
+			m_Workers.push_back(std::unique_ptr<Worker>(new Worker));
+			m_Workers.back()->bins.resize(m_NumBins);
+		}
+		m_PendingSubtrees = 0;
+	}
+
+	void spawn(unsigned int worker, const std::function<void(unsigned int)>& run, std::atomic<size_t>& pending) {
+		pending++;
+		Worker& w = *m_Workers[worker];
+		std::lock_guard<std::mutex> lock(w.mutex);
+		Task t;
+		t.run = run;
+		t.pending = &pending;
+		w.tasks.push_back(t);
+	}
+
+	bool getTask(unsigned int worker, Task& task) {
+		{
+			Worker& w = *m_Workers[worker];
+			std::lock_guard<std::mutex> lock(w.mutex);
+			if (!w.tasks.empty()) {
+				task = w.tasks.back();
+				w.tasks.pop_back();
+				return true;
+			}
+		}
+		for (unsigned int i = 1; i < m_NumThreads; i++) {
+			Worker& victim = *m_Workers[(worker + i) % m_NumThreads];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			if (!victim.tasks.empty()) {
+				task = victim.tasks.front();
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//! runs (own or stolen) tasks until pending drops to zero
+	void wait(unsigned int worker, std::atomic<size_t>& pending) {
+		Task task;
+		while (pending > 0) {
+			if (getTask(worker, task)) {
+				task.run(worker);
+				(*task.pending)--;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void workerLoop(unsigned int worker) {
+		Task task;
+		while (!m_Done) {
+			if (getTask(worker, task)) {
+				task.run(worker);
+				(*task.pending)--;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	//! splits [begin, end) into chunks, runs f(chunk, chunkBegin, chunkEnd) on all of them in parallel and returns the number of chunks
+	template<class F>
+	size_t parallelChunks(unsigned int worker, size_t begin, size_t end, const F& f) {
+		const size_t n = end - begin;
+		const size_t numChunks = std::max((size_t)1, std::min((size_t)m_NumThreads * 4, n / 4096));
+		std::atomic<size_t> pending(0);
+		for (size_t c = 1; c < numChunks; c++) {
+			spawn(worker, [&f, c, begin, n, numChunks](unsigned int) { f(c, begin + n * c / numChunks, begin + n * (c + 1) / numChunks); }, pending);
+		}
+		f(0, begin, begin + n / numChunks);
+		wait(worker, pending);
+		return numChunks;
+	}
+
+	bool useParallelPrimitives(size_t begin, size_t end) const {
+		return m_NumThreads > 1 && end - begin >= m_ParallelGrain;
+	}
+
+	//! moves the triangles satisfying pred to the front and returns the first one that does not; the parallel version keeps the relative order
+	template<class Pred>
+	size_t partition(unsigned int worker, size_t begin, size_t end, const Pred& pred) {
+		if (!useParallelPrimitives(begin, end)) {
+			return std::partition(m_Tris + begin, m_Tris + end, pred) - m_Tris;
+		}
+
+		std::vector<size_t> numLeft(m_NumThreads * 4 + 1, 0);
+		const size_t numChunks = parallelChunks(worker, begin, end, [&](size_t c, size_t cb, size_t ce) {
+			for (size_t i = cb; i < ce; i++) {
+				if (pred(m_Tris[i])) numLeft[c]++;
+			}
+		});
+
+		std::vector<size_t> leftOffset(numChunks), rightOffset(numChunks);
+		size_t totalLeft = 0;
+		for (size_t c = 0; c < numChunks; c++) {
+			leftOffset[c] = begin + totalLeft;
+			totalLeft += numLeft[c];
+		}
+		size_t right = begin + totalLeft;
+		for (size_t c = 0; c < numChunks; c++) {
+			rightOffset[c] = right;
+			right += (end - begin) * (c + 1) / numChunks - (end - begin) * c / numChunks - numLeft[c];
+		}
+
+		parallelChunks(worker, begin, end, [&](size_t c, size_t cb, size_t ce) {
+			size_t l = leftOffset[c], r = rightOffset[c];
+			for (size_t i = cb; i < ce; i++) {
+				if (pred(m_Tris[i]))	m_Scratch[l++] = m_Tris[i];
+				else					m_Scratch[r++] = m_Tris[i];
+			}
+		});
+		parallelChunks(worker, begin, end, [&](size_t, size_t cb, size_t ce) {
+			std::copy(m_Scratch.begin() + cb, m_Scratch.begin() + ce, m_Tris + cb);
+		});
+		return begin + totalLeft;
 	}
 
-	static bool cmpY(typename TriMesh<FloatType>::Triangle *t0, typename TriMesh<FloatType>::Triangle *t1) {
-		return t0->getCenter().y < t1->getCenter().y;
+	//! places the triangle with the mid-th smallest centroid coordinate at mid (as std::nth_element); large ranges use a quickselect over parallel partitions
+	void select(unsigned int worker, size_t begin, size_t mid, size_t end, unsigned int axis) {
+		while (useParallelPrimitives(begin, end)) {
+			//median of evenly spaced samples as pivot
+			FloatType samples[31];
+			for (size_t i = 0; i < 31; i++) {
+				samples[i] = m_Tris[begin + (end - begin) * (2 * i + 1) / 62]->getCenter()[axis];
+			}
+			std::nth_element(samples, samples + 15, samples + 31);
+			const FloatType pivot = samples[15];
+
+			const size_t lessEnd = partition(worker, begin, end, [axis, pivot](const Triangle* t) { return t->getCenter()[axis] < pivot; });
+			if (mid < lessEnd) {
+				end = lessEnd;
+				continue;
+			}
+			//the pivot itself is in [lessEnd, end), so each step shrinks the range
+			const size_t equalEnd = partition(worker, lessEnd, end, [axis, pivot](const Triangle* t) { return t->getCenter()[axis] == pivot; });
+			if (mid < equalEnd) return;
+			begin = equalEnd;
+		}
+		std::nth_element(m_Tris + begin, m_Tris + mid, m_Tris + end, [axis](const Triangle* t0, const Triangle* t1) {
+			return t0->getCenter()[axis] < t1->getCenter()[axis];
+		});
+	}
+
+	void computeBounds(unsigned int worker, size_t begin, size_t end, BoundingBox3<FloatType>& bbox, BoundingBox3<FloatType>& centroidBox) {
+		bbox.reset();
+		centroidBox.reset();
+		if (!useParallelPrimitives(begin, end)) {
+			for (size_t i = begin; i < end; i++) {
+				m_Tris[i]->includeInBoundingBox(bbox);
+				centroidBox.include(m_Tris[i]->getCenter());
+			}
+			return;
+		}
+
+		std::vector<BoundingBox3<FloatType>> chunkBoxes(m_NumThreads * 4), chunkCentroidBoxes(m_NumThreads * 4);
+		const size_t numChunks = parallelChunks(worker, begin, end, [&](size_t c, size_t cb, size_t ce) {
+			for (size_t i = cb; i < ce; i++) {
+				m_Tris[i]->includeInBoundingBox(chunkBoxes[c]);
+				chunkCentroidBoxes[c].include(m_Tris[i]->getCenter());
+			}
+		});
+		for (size_t c = 0; c < numChunks; c++) {
+			bbox.include(chunkBoxes[c]);
+			centroidBox.include(chunkCentroidBoxes[c]);
+		}
 	}
 
-	static bool cmpZ(typename TriMesh<FloatType>::Triangle *t0, typename TriMesh<FloatType>::Triangle *t1) {
-		return t0->getCenter().z < t1->getCenter().z;
+	//! fills bins (numBins entries) with the bounds and counts of the triangles along axis
+	void computeBins(unsigned int worker, size_t begin, size_t end, unsigned int axis, FloatType minC, FloatType scale, SAHBin* bins) {
+		for (unsigned int i = 0; i < m_NumBins; i++) {
+			bins[i].bounds.reset();
+			bins[i].count = 0;
+		}
+		if (!useParallelPrimitives(begin, end)) {
+			Triangle* const* tris = m_Tris;
+			const unsigned int numBins = m_NumBins;
+			for (size_t i = begin; i < end; i++) {
+				SAHBin& b = bins[TriangleBVHNode<FloatType>::computeSAHBin(tris[i]->getCenter()[axis], minC, scale, numBins)];
+				tris[i]->includeInBoundingBox(b.bounds);
+				b.count++;
+			}
+			return;
+		}
+
+		std::vector<SAHBin> chunkBins(m_NumThreads * 4 * m_NumBins);
+		for (auto& b : chunkBins) b.count = 0;
+		const size_t numChunks = parallelChunks(worker, begin, end, [&](size_t c, size_t cb, size_t ce) {
+			SAHBin* local = &chunkBins[c * m_NumBins];
+			for (size_t i = cb; i < ce; i++) {
+				SAHBin& b = local[TriangleBVHNode<FloatType>::computeSAHBin(m_Tris[i]->getCenter()[axis], minC, scale, m_NumBins)];
+				m_Tris[i]->includeInBoundingBox(b.bounds);
+				b.count++;
+			}
+		});
+		for (size_t c = 0; c < numChunks; c++) {
+			for (unsigned int i = 0; i < m_NumBins; i++) {
+				bins[i].bounds.include(chunkBins[c * m_NumBins + i].bounds);
+				bins[i].count += chunkBins[c * m_NumBins + i].count;
+			}
+		}
+	}
+
+	//! returns the end of the left child's range, or begin if node should become a leaf
+	size_t split(unsigned int worker, TriangleBVHNode<FloatType>* node, size_t begin, size_t end, unsigned int depth) {
+		const size_t numTris = end - begin;
+		BoundingBox3<FloatType> centroidBox;
+		computeBounds(worker, begin, end, node->boundingBox, centroidBox);
+		if (numTris <= 1) return begin;
+
+		if (m_SplitMode == SPLIT_MEDIAN) {
+			node->splitAxis = depth % 3;
+			select(worker, begin, begin + numTris / 2, end, node->splitAxis);
+			return begin + numTris / 2;
+		}
+
+		if (m_SplitMode == SPLIT_MIDPOINT) {
+			const vec3<FloatType> extent = centroidBox.getExtent();
+			unsigned int axis = 0;
+			if (extent.y > extent[axis]) axis = 1;
+			if (extent.z > extent[axis]) axis = 2;
+			node->splitAxis = axis;
+
+			const FloatType middle = centroidBox.getMin()[axis] + extent[axis] / 2;
+			const size_t mid = partition(worker, begin, end, [axis, middle](const Triangle* t) { return t->getCenter()[axis] < middle; });
+			if (mid != begin && mid != end) return mid;
+
+			//the centroids do not separate along the longest axis (its extent is zero or below the float resolution); split in the middle to keep the tree balanced
+			return begin + numTris / 2;
+		}
+
+		//find the cheapest split plane over all axes; the parallel binning runs other tasks on this thread while waiting, so it cannot use the thread's bins
+		std::vector<SAHBin> localBins;
+		SAHBin* bins = m_Workers[worker]->bins.data();
+		if (useParallelPrimitives(begin, end)) {
+			localBins.resize(m_NumBins);
+			bins = localBins.data();
+		}
+		int bestAxis = -1;
+		unsigned int bestSplit = 0;
+		FloatType bestCost = std::numeric_limits<FloatType>::max();
+		for (unsigned int axis = 0; axis < 3; axis++) {
+			const FloatType minC = centroidBox.getMin()[axis];
+			const FloatType extent = centroidBox.getMax()[axis] - minC;
+			if (extent <= (FloatType)0) continue;
+			computeBins(worker, begin, end, axis, minC, (FloatType)m_NumBins / extent, bins);
+
+			BoundingBox3<FloatType> accum;
+			size_t accumCount = 0;
+			for (unsigned int i = m_NumBins - 1; i > 0; i--) {
+				accum.include(bins[i].bounds);
+				accumCount += bins[i].count;
+				bins[i].rightArea = accum.getSurfaceArea();
+				bins[i].rightCount = accumCount;
+			}
+
+			accum.reset();
+			accumCount = 0;
+			for (unsigned int i = 0; i < m_NumBins - 1; i++) {
+				accum.include(bins[i].bounds);
+				accumCount += bins[i].count;
+				if (accumCount == 0 || bins[i + 1].rightCount == 0) continue;
+				const FloatType cost = accum.getSurfaceArea() * (FloatType)accumCount + bins[i + 1].rightArea * (FloatType)bins[i + 1].rightCount;
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = (int)axis;
+					bestSplit = i;
+				}
+			}
+		}
+
+		if (bestAxis == -1) {
+			//all centroids coincide; no spatial split possible
+			if (numTris <= m_MaxLeafSize) return begin;
+			return begin + numTris / 2;
+		}
+
+		const FloatType area = node->boundingBox.getSurfaceArea();
+		const FloatType splitCost = TriangleBVHNode<FloatType>::getSAHTraversalCost() + (area > (FloatType)0 ? bestCost / area : (FloatType)numTris);
+		if (numTris <= m_MaxLeafSize && (FloatType)numTris <= splitCost) return begin;
+
+		const unsigned int axis = (unsigned int)bestAxis;
+		const unsigned int numBins = m_NumBins;
+		node->splitAxis = axis;
+		const FloatType minC = centroidBox.getMin()[axis];
+		const FloatType scale = (FloatType)numBins / (centroidBox.getMax()[axis] - minC);
+		return partition(worker, begin, end, [=](const Triangle* t) {
+			return TriangleBVHNode<FloatType>::computeSAHBin(t->getCenter()[axis], minC, scale, numBins) <= bestSplit;
+		});
+	}
+
+	void buildSubtree(unsigned int worker, TriangleBVHNode<FloatType>* node, size_t begin, size_t end, unsigned int depth) {
+		const size_t mid = split(worker, node, begin, end, depth);
+		if (mid == begin) {
+			node->leafTris = m_Tris + begin;
+			node->numLeafTris = (unsigned int)(end - begin);
+			return;
+		}
+
+		const size_t children = m_NextNode.fetch_add(2);
+		node->lChild = &m_Nodes[children];
+		node->rChild = &m_Nodes[children + 1];
+
+		TriangleBVHNode<FloatType>* rChild = node->rChild;
+		if (m_NumThreads > 1 && end - mid >= m_TaskGrain) {
+			spawn(worker, [this, rChild, mid, end, depth](unsigned int w) { buildSubtree(w, rChild, mid, end, depth + 1); }, m_PendingSubtrees);
+		} else {
+			buildSubtree(worker, rChild, mid, end, depth + 1);
+		}
+		buildSubtree(worker, node->lChild, begin, mid, depth + 1);
 	}
+
+
+	//! private data
+	SplitMode		m_SplitMode;
+	unsigned int	m_MaxThreads;
+	unsigned int	m_NumThreads;	//! threads of the current build
+	unsigned int	m_NumBins;
+	unsigned int	m_MaxLeafSize;
+	size_t			m_TaskGrain;		//! ranges of at least this size are built as separate tasks
+	size_t			m_ParallelGrain;	//! ranges of at least this size are split with data-parallel primitives
+
+	TriangleBVHNode<FloatType>*		m_Nodes;
+	std::atomic<size_t>				m_NextNode;
+	Triangle**						m_Tris;
+	std::vector<Triangle*>			m_Scratch;	//! target of the parallel partition
+
+	std::vector<std::unique_ptr<Worker>>	m_Workers;
+	std::atomic<size_t>						m_PendingSubtrees;
+	std::atomic<bool>						m_Done;
 };
 
 template <class FloatType>
@@ -251,12 +836,50 @@ class TriMeshAcceleratorBVH : public TriMeshRayAccelerator<FloatType>, public Tr
 {
 public:
 
-	TriMeshAcceleratorBVH() {
+	enum BuildMode {
+		BUILD_MEDIAN,	//! object median split along alternating axes
+		BUILD_MIDPOINT,	//! split at the centroid midpoint of the longest axis
+		BUILD_SAH		//! binned surface area heuristic; supports multiple triangles per leaf
+	};
+
+	//! result of a closest point query
+	struct ClosestPoint
+	{
+		ClosestPoint() : triangle(nullptr) {}
+
+		bool isValid() const {
+			return triangle != nullptr;
+		}
+
+		unsigned int getTriangleIndex() const {
+			return triangle->getIndex();
+		}
+		unsigned int getMeshIndex() const {
+			return triangle->getMeshIndex();
+		}
+
+		vec3<FloatType> position;	//! closest surface point
+		FloatType u, v;				//! barycentric weights of the triangle's second and third vertex (as for ray intersections)
+		FloatType distance;			//! distance to the query point; negative inside if the sign was requested
+		const typename TriMesh<FloatType>::Triangle* triangle;
+	};
+
+	TriMeshAcceleratorBVH(BuildMode buildMode = BUILD_MEDIAN) {
 		m_Root = nullptr;
+		m_NumBuildThreads = 0;
+		m_TreeDepth = 0;
+		m_BuildSAHCost = (FloatType)0;
+		m_PseudoNormalsValid = false;
+		initBuildParameters(buildMode);
 	}
-	TriMeshAcceleratorBVH(const TriMesh<FloatType>& triMesh, bool storeLocalCopy = false) {
+	TriMeshAcceleratorBVH(const TriMesh<FloatType>& triMesh, bool storeLocalCopy = false, BuildMode buildMode = BUILD_MEDIAN) {
 		m_Root = nullptr;
-		build(triMesh, storeLocalCopy);
+		m_NumBuildThreads = 0;
+		m_TreeDepth = 0;
+		m_BuildSAHCost = (FloatType)0;
+		m_PseudoNormalsValid = false;
+		initBuildParameters(buildMode);
+		this->build(triMesh, storeLocalCopy);
 		
 		//std::vector<const TriMesh<FloatType>*> meshes;
 		//meshes.push_back(&triMesh);
@@ -268,124 +891,708 @@ public:
 
 	}
 
-	~TriMeshAcceleratorBVH() {
-		SAFE_DELETE(m_Root);
+	//! selects the split strategy used by subsequent build calls
+	void setBuildMode(BuildMode buildMode) {
+		m_BuildMode = buildMode;
+	}
+	BuildMode getBuildMode() const {
+		return m_BuildMode;
+	}
+
+	//! number of threads used by subsequent build calls; 0 uses all hardware threads
+	void setNumBuildThreads(unsigned int numThreads) {
+		m_NumBuildThreads = numThreads;
+	}
+
+	//! number of centroid bins per axis and maximum number of triangles per leaf (only used by BUILD_SAH)
+	void setSAHParameters(unsigned int numBins, unsigned int maxLeafSize) {
+		if (numBins < 2) throw MLIB_EXCEPTION("SAH build requires at least two bins");
+		if (maxLeafSize < 1) throw MLIB_EXCEPTION("leaves must hold at least one triangle");
+		m_SAHNumBins = numBins;
+		m_SAHMaxLeafSize = maxLeafSize;
+	}
+
+	using TriMeshRayAccelerator<FloatType>::intersect;
+
+	//! same as intersect, but accumulates the number of box and triangle tests into stats
+	typename TriMeshRayAccelerator<FloatType>::Intersection intersect(const Ray<FloatType>& r, typename TriMeshRayAccelerator<FloatType>::TraversalStats& stats, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		typename TriMeshRayAccelerator<FloatType>::Intersection i;
+		i.triangle = traverse(r, i.t, i.u, i.v, tmin, tmax, onlyFrontFaces, &stats);
+		return i;
+	}
+
+	//! SAH cost relative to the cost right after the last build; refitting keeps the topology of the tree, so the cost grows as the
+	//! mesh deforms; a rebuild typically pays off once the ratio exceeds 1.5 - 2
+	FloatType computeSAHCostRatio() const {
+		if (!m_Root || m_BuildSAHCost <= (FloatType)0) return (FloatType)1;
+		return computeSAHCost() / m_BuildSAHCost;
+	}
+
+	//! closest surface point to p within maxDist (invalid result if there is none); the sign requires a closed, consistently
+	//! oriented mesh and is determined with angle-weighted pseudo normals (Baerentzen and Aanaes 2005), which are computed on first use
+	ClosestPoint closestPoint(const vec3<FloatType>& p, bool computeSign = false, FloatType maxDist = std::numeric_limits<FloatType>::max()) const {
+		ClosestPoint res;
+		if (!m_Root) return res;
+
+		FloatType distSq = maxDist < std::sqrt(std::numeric_limits<FloatType>::max()) ? maxDist * maxDist : std::numeric_limits<FloatType>::max();
+		std::pair<const TriangleBVHNode<FloatType>*, FloatType> localStack[64];
+		if (m_TreeDepth <= 64) {
+			res.triangle = m_Root->closestPoint(p, distSq, res.position, res.u, res.v, localStack);
+		} else {
+			std::vector<std::pair<const TriangleBVHNode<FloatType>*, FloatType>> heapStack(m_TreeDepth);
+			res.triangle = m_Root->closestPoint(p, distSq, res.position, res.u, res.v, heapStack.data());
+		}
+		if (!res.triangle) return res;
+
+		res.distance = std::sqrt(distSq);
+		if (computeSign && res.distance > (FloatType)0) {
+			updatePseudoNormals();
+			const TrianglePseudoNormals& n = m_PseudoNormals[res.triangle - &TriMeshRayAccelerator<FloatType>::m_Triangles[0]];
+			const FloatType w = (FloatType)1 - res.u - res.v;
+
+			//pick the normal of the feature (vertex, edge, or face) the closest point lies on
+			const vec3<FloatType>* normal = &n.face;
+			if (res.u <= (FloatType)0 && res.v <= (FloatType)0)	normal = &n.vertices[0];
+			else if (w <= (FloatType)0 && res.v <= (FloatType)0)	normal = &n.vertices[1];
+			else if (w <= (FloatType)0 && res.u <= (FloatType)0)	normal = &n.vertices[2];
+			else if (res.v <= (FloatType)0)	normal = &n.edges[0];
+			else if (w <= (FloatType)0)		normal = &n.edges[1];
+			else if (res.u <= (FloatType)0)	normal = &n.edges[2];
+
+			if (((p - res.position) | *normal) < (FloatType)0) res.distance = -res.distance;
+		}
+		return res;
+	}
+
+	//! closest point queries for many points (multithreaded if OpenMP is enabled); results[i] belongs to points[i]
+	void closestPoints(const std::vector<vec3<FloatType>>& points, std::vector<ClosestPoint>& results, bool computeSign = false, FloatType maxDist = std::numeric_limits<FloatType>::max()) const {
+		results.resize(points.size());
+		if (computeSign) updatePseudoNormals();
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < (int)points.size(); i++) {
+			results[i] = closestPoint(points[i], computeSign, maxDist);
+		}
+	}
+
+	//! intersecting triangles of two accelerators; first belongs to this accelerator, second to the other one
+	typedef std::pair<const typename TriMesh<FloatType>::Triangle*, const typename TriMesh<FloatType>::Triangle*> TrianglePair;
+
+	//! all pairs of intersecting triangles (the contact set); pairs of overlapping subtrees are processed in parallel if OpenMP is enabled,
+	//! and the order of the pairs does not depend on the number of threads
+	void collisionPairs(const TriMeshAcceleratorBVH<FloatType>& other, std::vector<TrianglePair>& pairs) const {
+		collectCollisionPairs(other, nullptr, pairs);
+	}
+
+	//! same as above, with the other accelerator placed by transform (as for collision(other, transform))
+	void collisionPairs(const TriMeshAcceleratorBVH<FloatType>& other, const Matrix4x4<FloatType>& transform, std::vector<TrianglePair>& pairs) const {
+		const typename TriangleBVHNode<FloatType>::TransformedBoxTest test(transform);
+		collectCollisionPairs(other, &test, pairs);
+	}
+
+	std::vector<TrianglePair> collisionPairs(const TriMeshAcceleratorBVH<FloatType>& other) const {
+		std::vector<TrianglePair> pairs;
+		collisionPairs(other, pairs);
+		return pairs;
+	}
+
+	std::vector<TrianglePair> collisionPairs(const TriMeshAcceleratorBVH<FloatType>& other, const Matrix4x4<FloatType>& transform) const {
+		std::vector<TrianglePair> pairs;
+		collisionPairs(other, transform, pairs);
+		return pairs;
 	}
 
+	//! number of intersecting triangle pairs (same traversal as collisionPairs, but without storing the pairs)
+	size_t collisionCount(const TriMeshAcceleratorBVH<FloatType>& other) const {
+		return countCollisionPairs(other, nullptr);
+	}
+
+	size_t collisionCount(const TriMeshAcceleratorBVH<FloatType>& other, const Matrix4x4<FloatType>& transform) const {
+		const typename TriangleBVHNode<FloatType>::TransformedBoxTest test(transform);
+		return countCollisionPairs(other, &test);
+	}
+
+	//! expected traversal cost of a random ray relative to a single triangle test (SAH cost model); useful to compare builds
+	FloatType computeSAHCost() const {
+		if (!m_Root) return (FloatType)0;
+		const FloatType rootArea = m_Root->boundingBox.getSurfaceArea();
+		if (rootArea <= (FloatType)0) return (FloatType)m_Root->getNumLeaves();
+		return m_Root->computeSAHCostRec((FloatType)1 / rootArea);
+	}
 	
 	void printInfo() const {
 		std::cout << "Info: TriangleBVHAccelerator build done ( " << TriMeshRayAccelerator<FloatType>::m_TrianglePointers.size() << " tris )" << std::endl;
-		std::cout << "Info: Tree depth " << m_Root->getTreeDepthRec() << std::endl;
+		std::cout << "Info: Tree depth " << m_TreeDepth << std::endl;
 		std::cout << "Info: NumNodes " << m_Root->getNumNodesRec() << std::endl;
 		std::cout << "Info: NumLeaves " << m_Root->getNumLeaves() << std::endl;
+		std::cout << "Info: SAH cost " << computeSAHCost() << std::endl;
+	}
+
+	//! bytes held by the tree, triangles, local vertex copies and (if computed) pseudo normals
+	size_t memoryFootprint() const {
+		return sizeof(*this) + this->getSharedMemoryFootprint() + util::memoryFootprint(m_Nodes) + util::memoryFootprint(m_PseudoNormals);
+	}
+
+	//! version of the cache image written by saveCache; images of other versions are rejected
+	static const UINT32 CacheVersion = 1;
+
+	//! hash of the triangles' vertex positions and mesh/triangle indices; keys the cache image
+	UINT64 computeContentHash() const {
+		struct TriangleKey {
+			vec3<FloatType> p[3];
+			UINT32 triangleIndex;
+			UINT32 meshIndex;
+		};
+		UINT64 hash = 14695981039346656037ull;
+		for (const auto& tri : TriMeshRayAccelerator<FloatType>::m_Triangles) {
+			TriangleKey key;
+			key.p[0] = tri.getV0().position;
+			key.p[1] = tri.getV1().position;
+			key.p[2] = tri.getV2().position;
+			key.triangleIndex = tri.getIndex();
+			key.meshIndex = tri.getMeshIndex();
+			hash = (hash ^ util::hash64(key)) * 1099511628211ull;
+		}
+		return hash;
+	}
+
+	//! writes the tree (but not the meshes) as a flat binary image: a header followed by the nodes and the leaf order of the triangles;
+	//! all sections are 8 byte aligned, so loadCache can read the image directly from a memory-mapped file
+	void saveCache(std::vector<BYTE>& data) const {
+		const std::vector<typename TriMesh<FloatType>::Triangle*>& tris = TriMeshRayAccelerator<FloatType>::m_TrianglePointers;
+		const typename TriMesh<FloatType>::Triangle* firstTri = TriMeshRayAccelerator<FloatType>::m_Triangles.data();
+
+		CacheHeader header;
+		std::memcpy(header.magic, "MLIBBVH", 8);
+		header.version = CacheVersion;
+		header.floatSize = sizeof(FloatType);
+		header.contentHash = computeContentHash();
+		header.numTriangles = tris.size();
+		header.numNodes = m_Nodes.size();
+		header.buildMode = (UINT64)m_BuildMode;
+
+		data.resize(sizeof(CacheHeader) + m_Nodes.size() * sizeof(CacheNode) + tris.size() * sizeof(UINT32));
+		std::memcpy(data.data(), &header, sizeof(CacheHeader));
+
+		BYTE* nodeData = data.data() + sizeof(CacheHeader);
+		for (size_t i = 0; i < m_Nodes.size(); i++) {
+			const TriangleBVHNode<FloatType>& n = m_Nodes[i];
+			CacheNode c;
+			c.minB = n.boundingBox.getMin();
+			c.maxB = n.boundingBox.getMax();
+			c.lChild = n.isLeaf() ? 0 : (UINT32)(n.lChild - m_Nodes.data());
+			c.splitAxis = n.splitAxis;
+			c.firstTriangle = n.isLeaf() ? (UINT32)(n.leafTris - tris.data()) : 0;
+			c.numTriangles = n.isLeaf() ? n.numLeafTris : 0;
+			std::memcpy(nodeData + i * sizeof(CacheNode), &c, sizeof(CacheNode));
+		}
+
+		BYTE* triData = nodeData + m_Nodes.size() * sizeof(CacheNode);
+		for (size_t i = 0; i < tris.size(); i++) {
+			const UINT32 idx = (UINT32)(tris[i] - firstTri);
+			std::memcpy(triData + i * sizeof(UINT32), &idx, sizeof(UINT32));
+		}
+	}
+
+	void saveCache(const std::string& filename) const {
+		std::vector<BYTE> data;
+		saveCache(data);
+		BinaryDataStreamFile out(filename, true);
+		out.writeData(data.data(), data.size());
+		out.close();
+	}
+
+	//! references the meshes (as build does) and restores the tree from an image written by saveCache instead of building it; data is only read,
+	//! so it may point into a memory-mapped file; the nodes are copied out of the image (linear in their number, without any of the
+	//! build's sorting or binning); returns false and leaves the accelerator empty if the image is invalid, has another version or
+	//! precision, or was built from different meshes
+	bool loadCache(const BYTE* data, size_t size, const std::vector<const TriMesh<FloatType>*>& triMeshes, bool storeLocalCopy = false) {
+		this->bindMeshes(triMeshes, storeLocalCopy);
+		if (restoreTree(data, size)) return true;
+		this->destroy();
+		return false;
+	}
+
+	bool loadCache(const std::string& filename, const std::vector<const TriMesh<FloatType>*>& triMeshes, bool storeLocalCopy = false) {
+		if (!util::fileExists(filename)) {
+			this->destroy();
+			return false;
+		}
+		const std::vector<BYTE> data = util::getFileData(filename);
+		return loadCache(data.data(), data.size(), triMeshes, storeLocalCopy);
+	}
+
+	//! loads the tree from the cache file if it matches the meshes; otherwise builds it and (over)writes the file; returns true if the cache was used
+	bool buildCached(const std::string& filename, const std::vector<const TriMesh<FloatType>*>& triMeshes, bool storeLocalCopy = false) {
+		if (util::fileExists(filename)) {
+			const std::vector<BYTE> data = util::getFileData(filename);
+			this->bindMeshes(triMeshes, storeLocalCopy);
+			if (restoreTree(data.data(), data.size())) return true;
+		}
+		this->build(triMeshes, storeLocalCopy);
+		saveCache(filename);
+		return false;
+	}
+
+	//! writes a self-contained copy: the vertices of all triangles followed by the cache image
+	template<class BinaryDataBuffer, class BinaryDataCompressor>
+	void writeToStream(BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& s) const {
+		const auto& triangles = TriMeshRayAccelerator<FloatType>::m_Triangles;
+		UINT64 numMeshes = 0;
+		for (const auto& tri : triangles) {
+			numMeshes = std::max(numMeshes, (UINT64)tri.getMeshIndex() + 1);
+		}
+
+		//triangles are stored by mesh and by index within the mesh
+		s << numMeshes;
+		size_t t = 0;
+		for (UINT64 m = 0; m < numMeshes; m++) {
+			std::vector<typename TriMesh<FloatType>::Vertex> soup;
+			for (; t < triangles.size() && triangles[t].getMeshIndex() == m; t++) {
+				soup.push_back(triangles[t].getV0());
+				soup.push_back(triangles[t].getV1());
+				soup.push_back(triangles[t].getV2());
+			}
+			s << (UINT64)soup.size();
+			s.writeData((const BYTE*)soup.data(), sizeof(typename TriMesh<FloatType>::Vertex) * soup.size());
+		}
+
+		std::vector<BYTE> image;
+		saveCache(image);
+		s << image;
+	}
+
+	//! reads a copy written by writeToStream; the accelerator keeps its own (unindexed) copy of the vertices
+	template<class BinaryDataBuffer, class BinaryDataCompressor>
+	void readFromStream(BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& s) {
+		UINT64 numMeshes;
+		s >> numMeshes;
+		std::vector<std::vector<typename TriMesh<FloatType>::Vertex>> soups(numMeshes);
+		for (auto& soup : soups) {
+			UINT64 numVertices;
+			s >> numVertices;
+			soup.resize(numVertices);
+			s.readData((BYTE*)soup.data(), sizeof(typename TriMesh<FloatType>::Vertex) * soup.size());
+		}
+		std::vector<BYTE> image;
+		s >> image;
+
+		this->bindTriangleSoups(soups);
+		if (!restoreTree(image.data(), image.size())) throw MLIB_EXCEPTION("invalid BVH in stream");
 	}
 private:
+	//! layout of the cache image (see saveCache)
+	struct CacheHeader {
+		char	magic[8];
+		UINT32	version;
+		UINT32	floatSize;
+		UINT64	contentHash;
+		UINT64	numTriangles;
+		UINT64	numNodes;
+		UINT64	buildMode;
+	};
+	struct CacheNode {
+		vec3<FloatType> minB;
+		vec3<FloatType> maxB;
+		UINT32 lChild;			//! the right child follows the left one; 0 for leaves
+		UINT32 splitAxis;
+		UINT32 firstTriangle;	//! leaves only: offset into the triangle order
+		UINT32 numTriangles;
+	};
+
+	//! restores the nodes and the triangle order from a cache image for the bound triangles
+	bool restoreTree(const BYTE* data, size_t size) {
+		m_Root = nullptr;
+		m_Nodes.clear();
+		m_TreeDepth = 0;
+		m_BuildSAHCost = (FloatType)0;
+		m_PseudoNormals.clear();
+		m_PseudoNormalsValid = false;
+
+		CacheHeader header;
+		if (size < sizeof(CacheHeader)) return false;
+		std::memcpy(&header, data, sizeof(CacheHeader));
+		if (std::memcmp(header.magic, "MLIBBVH", 8) != 0 || header.version != CacheVersion || header.floatSize != sizeof(FloatType)) return false;
+
+		std::vector<typename TriMesh<FloatType>::Triangle*>& tris = TriMeshRayAccelerator<FloatType>::m_TrianglePointers;
+		std::vector<typename TriMesh<FloatType>::Triangle>& triangles = TriMeshRayAccelerator<FloatType>::m_Triangles;
+		if (header.numTriangles != tris.size() || header.contentHash != computeContentHash()) return false;
+		if (header.numNodes > 2 * header.numTriangles || size < sizeof(CacheHeader) + header.numNodes * sizeof(CacheNode) + header.numTriangles * sizeof(UINT32)) return false;
+		if ((header.numTriangles > 0 && header.numNodes == 0) || header.buildMode > BUILD_SAH) return false;
+
+		const BYTE* triData = data + sizeof(CacheHeader) + header.numNodes * sizeof(CacheNode);
+		for (size_t i = 0; i < tris.size(); i++) {
+			UINT32 idx;
+			std::memcpy(&idx, triData + i * sizeof(UINT32), sizeof(UINT32));
+			if (idx >= triangles.size()) return false;
+			tris[i] = &triangles[idx];
+		}
+
+		const BYTE* nodeData = data + sizeof(CacheHeader);
+		m_Nodes.resize((size_t)header.numNodes);
+		for (size_t i = 0; i < m_Nodes.size(); i++) {
+			CacheNode c;
+			std::memcpy(&c, nodeData + i * sizeof(CacheNode), sizeof(CacheNode));
+			TriangleBVHNode<FloatType>& n = m_Nodes[i];
+			n.boundingBox = BoundingBox3<FloatType>(c.minB, c.maxB);
+			n.splitAxis = c.splitAxis;
+			const bool valid = c.lChild == 0 ?
+				c.numTriangles > 0 && (UINT64)c.firstTriangle + c.numTriangles <= tris.size() :
+				c.lChild > i && (size_t)c.lChild + 1 < m_Nodes.size();	//children are stored after their parents, so the tree cannot contain cycles
+			if (!valid) {
+				m_Nodes.clear();
+				return false;
+			}
+			if (c.lChild == 0) {
+				n.leafTris = tris.data() + c.firstTriangle;
+				n.numLeafTris = c.numTriangles;
+			} else {
+				n.lChild = &m_Nodes[c.lChild];
+				n.rChild = &m_Nodes[c.lChild + 1];
+			}
+		}
+		if (!m_Nodes.empty()) m_Root = &m_Nodes[0];
+
+		m_BuildMode = (BuildMode)header.buildMode;
+		if (m_Root) computeRestoredTreeStatistics();
+		return true;
+	}
+
+	//! depth and SAH cost of a restored tree without recursion, so a degenerate image cannot overflow the stack; relies on the
+	//! children being stored after their parents (checked by restoreTree)
+	void computeRestoredTreeStatistics() {
+		std::vector<unsigned int> depth(m_Nodes.size(), 0);
+		depth[0] = 1;
+		for (size_t i = 0; i < m_Nodes.size(); i++) {
+			const TriangleBVHNode<FloatType>& n = m_Nodes[i];
+			m_TreeDepth = std::max(m_TreeDepth, depth[i]);
+			if (n.isLeaf()) continue;
+			depth[n.lChild - m_Nodes.data()] = std::max(depth[n.lChild - m_Nodes.data()], depth[i] + 1);
+			depth[n.rChild - m_Nodes.data()] = std::max(depth[n.rChild - m_Nodes.data()], depth[i] + 1);
+		}
+
+		//same as computeSAHCost, bottom up
+		const FloatType rootArea = m_Root->boundingBox.getSurfaceArea();
+		const FloatType invRootArea = rootArea > (FloatType)0 ? (FloatType)1 / rootArea : (FloatType)0;
+		std::vector<FloatType> cost(m_Nodes.size());
+		std::vector<size_t> numLeaves(m_Nodes.size());
+		for (size_t i = m_Nodes.size(); i-- > 0;) {
+			const TriangleBVHNode<FloatType>& n = m_Nodes[i];
+			const FloatType relArea = n.boundingBox.getSurfaceArea() * invRootArea;
+			if (n.isLeaf()) {
+				cost[i] = relArea * (FloatType)n.numLeafTris;
+				numLeaves[i] = 1;
+			} else {
+				const size_t l = n.lChild - m_Nodes.data(), r = n.rChild - m_Nodes.data();
+				cost[i] = relArea * TriangleBVHNode<FloatType>::getSAHTraversalCost() + cost[l] + cost[r];
+				numLeaves[i] = numLeaves[l] + numLeaves[r];
+			}
+		}
+		m_BuildSAHCost = rootArea > (FloatType)0 ? cost[0] : (FloatType)numLeaves[0];
+	}
+
+	//! angle-weighted pseudo normals of a triangle's face, edges (v0v1, v1v2, v2v0), and vertices
+	struct TrianglePseudoNormals {
+		vec3<FloatType> face;
+		vec3<FloatType> edges[3];
+		vec3<FloatType> vertices[3];
+	};
+
+	//! vertices and edges are identified by position, so meshes with duplicated vertices (e.g., per-face normals) are handled as well
+	struct PositionHash {
+		size_t operator()(const vec3<FloatType>& p) const {
+			const std::hash<FloatType> h;
+			return h(p.x) ^ (h(p.y) * 73856093) ^ (h(p.z) * 19349663);
+		}
+		size_t operator()(const std::pair<vec3<FloatType>, vec3<FloatType>>& e) const {
+			return (*this)(e.first) ^ ((*this)(e.second) * 83492791);
+		}
+	};
+
+	static bool positionLess(const vec3<FloatType>& a, const vec3<FloatType>& b) {
+		if (a.x != b.x) return a.x < b.x;
+		if (a.y != b.y) return a.y < b.y;
+		return a.z < b.z;
+	}
+
+	//! computes the pseudo normals on first use (thread-safe)
+	void updatePseudoNormals() const {
+		if (m_PseudoNormalsValid) return;
+		std::lock_guard<std::mutex> lock(m_PseudoNormalMutex);
+		if (m_PseudoNormalsValid) return;
+
+		const std::vector<typename TriMesh<FloatType>::Triangle>& tris = TriMeshRayAccelerator<FloatType>::m_Triangles;
+		m_PseudoNormals.resize(tris.size());
+
+		std::unordered_map<vec3<FloatType>, vec3<FloatType>, PositionHash> vertexNormals;
+		std::unordered_map<std::pair<vec3<FloatType>, vec3<FloatType>>, vec3<FloatType>, PositionHash> edgeNormals;
+		for (size_t i = 0; i < tris.size(); i++) {
+			const vec3<FloatType> v[3] = { tris[i].getV0().position, tris[i].getV1().position, tris[i].getV2().position };
+			vec3<FloatType> n = (v[1] - v[0]) ^ (v[2] - v[0]);
+			const FloatType len = n.length();
+			n = len > (FloatType)0 ? n / len : vec3<FloatType>::origin;
+			m_PseudoNormals[i].face = n;
+
+			for (unsigned int k = 0; k < 3; k++) {
+				const vec3<FloatType> e0 = v[(k + 1) % 3] - v[k];
+				const vec3<FloatType> e1 = v[(k + 2) % 3] - v[k];
+				const FloatType l = e0.length() * e1.length();
+				const FloatType angle = l > (FloatType)0 ? std::acos(math::clamp((e0 | e1) / l, (FloatType)-1, (FloatType)1)) : (FloatType)0;
+				vec3<FloatType>& vn = vertexNormals.insert(std::make_pair(v[k], vec3<FloatType>::origin)).first->second;
+				vn += angle * n;
+
+				const vec3<FloatType>& a = v[k];
+				const vec3<FloatType>& b = v[(k + 1) % 3];
+				vec3<FloatType>& en = edgeNormals.insert(std::make_pair(positionLess(a, b) ? std::make_pair(a, b) : std::make_pair(b, a), vec3<FloatType>::origin)).first->second;
+				en += n;
+			}
+		}
+
+		for (size_t i = 0; i < tris.size(); i++) {
+			const vec3<FloatType> v[3] = { tris[i].getV0().position, tris[i].getV1().position, tris[i].getV2().position };
+			for (unsigned int k = 0; k < 3; k++) {
+				const vec3<FloatType>& a = v[k];
+				const vec3<FloatType>& b = v[(k + 1) % 3];
+				m_PseudoNormals[i].vertices[k] = vertexNormals[a];
+				m_PseudoNormals[i].edges[k] = edgeNormals[positionLess(a, b) ? std::make_pair(a, b) : std::make_pair(b, a)];
+			}
+		}
+
+		m_PseudoNormalsValid = true;
+	}
+
+	void initBuildParameters(BuildMode buildMode) {
+		m_BuildMode = buildMode;
+		m_SAHNumBins = 16;
+		m_SAHMaxLeafSize = 4;
+	}
+
 	//! defined by the interface
 	bool collisionInternal(const TriMeshAcceleratorBVH<FloatType>& other) const {
-		return m_Root->intersects(*other.m_Root);
+		if (!m_Root || !other.m_Root) return false;
+		auto stop = [](const typename TriMesh<FloatType>::Triangle*, const typename TriMesh<FloatType>::Triangle*) { return false; };
+		return !m_Root->forEachIntersectingPair(*other.m_Root, stop);
 	}
 
-    bool collisionTransformInternal(const TriMeshAcceleratorBVH<FloatType>& other, const Matrix4x4<FloatType>& transform) const {
-        return m_Root->intersects(*other.m_Root, transform);
-    }
+	bool collisionTransformInternal(const TriMeshAcceleratorBVH<FloatType>& other, const Matrix4x4<FloatType>& transform) const {
+		if (!m_Root || !other.m_Root) return false;
+		const typename TriangleBVHNode<FloatType>::TransformedBoxTest test(transform);
+		auto stop = [](const typename TriMesh<FloatType>::Triangle*, const typename TriMesh<FloatType>::Triangle*) { return false; };
+		return !m_Root->forEachIntersectingPair(*other.m_Root, test, stop);
+	}
 
-    bool collisionTransformBBoxOnlyInternal(const TriMeshAcceleratorBVH<FloatType>& other, const Matrix4x4<FloatType>& transform) const {
-        return m_Root->collisionBBoxOnly(*other.m_Root, transform);
-    }
+	bool collisionTransformBBoxOnlyInternal(const TriMeshAcceleratorBVH<FloatType>& other, const Matrix4x4<FloatType>& transform) const {
+		if (!m_Root || !other.m_Root) return false;
+		const typename TriangleBVHNode<FloatType>::TransformedBoxTest test(transform);
+		return m_Root->collisionBBoxOnly(*other.m_Root, test);
+	}
 
-	//! defined by the interface
-	const typename TriMesh<FloatType>::Triangle* intersectInternal(const Ray<FloatType>& r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
-		u = v = std::numeric_limits<FloatType>::max();	
-		t = tmax;	//TODO MATTHIAS: probably we don't have to track tmax since t must always be smaller than the prev
-		return m_Root->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces);
+	//! runs the simultaneous descent (with or without transform) on a pair of subtrees
+	template<class F>
+	static bool forEachIntersectingPair(const TriangleBVHNode<FloatType>* a, const TriangleBVHNode<FloatType>* b, const typename TriangleBVHNode<FloatType>::TransformedBoxTest* test, F& f) {
+		return test ? a->forEachIntersectingPair(*b, *test, f) : a->forEachIntersectingPair(*b, f);
 	}
 
-	//! defined by the interface
-	void buildInternal() {
-		SAFE_DELETE(m_Root);
+	void collectCollisionPairs(const TriMeshAcceleratorBVH<FloatType>& other, const typename TriangleBVHNode<FloatType>::TransformedBoxTest* test, std::vector<TrianglePair>& pairs) const {
+		pairs.clear();
+		std::vector<std::pair<const TriangleBVHNode<FloatType>*, const TriangleBVHNode<FloatType>*>> subtreePairs;
+		collectSubtreePairs(other, test, subtreePairs);
 
-		bool useParallelBuild = true;
-		if (useParallelBuild) {
-			buildParallel(TriMeshRayAccelerator<FloatType>::m_TrianglePointers);
-		} else {
-			buildRecursive(TriMeshRayAccelerator<FloatType>::m_TrianglePointers);
+		std::vector<std::vector<TrianglePair>> subtreeResults(subtreePairs.size());
+#ifdef MLIB_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (int i = 0; i < (int)subtreePairs.size(); i++) {
+			std::vector<TrianglePair>& res = subtreeResults[i];
+			auto collect = [&res](const typename TriMesh<FloatType>::Triangle* a, const typename TriMesh<FloatType>::Triangle* b) {
+				res.push_back(std::make_pair(a, b));
+				return true;
+			};
+			forEachIntersectingPair(subtreePairs[i].first, subtreePairs[i].second, test, collect);
+		}
+		for (const auto& res : subtreeResults) {
+			pairs.insert(pairs.end(), res.begin(), res.end());
+		}
+	}
+
+	size_t countCollisionPairs(const TriMeshAcceleratorBVH<FloatType>& other, const typename TriangleBVHNode<FloatType>::TransformedBoxTest* test) const {
+		std::vector<std::pair<const TriangleBVHNode<FloatType>*, const TriangleBVHNode<FloatType>*>> subtreePairs;
+		collectSubtreePairs(other, test, subtreePairs);
+
+		long long count = 0;
+#ifdef MLIB_OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+:count)
+#endif
+		for (int i = 0; i < (int)subtreePairs.size(); i++) {
+			long long c = 0;
+			auto countPair = [&c](const typename TriMesh<FloatType>::Triangle*, const typename TriMesh<FloatType>::Triangle*) {
+				c++;
+				return true;
+			};
+			forEachIntersectingPair(subtreePairs[i].first, subtreePairs[i].second, test, countPair);
+			count += c;
 		}
+		return (size_t)count;
 	}
 
-	void buildParallel(std::vector<typename TriMesh<FloatType>::Triangle*>& tris) {
-		struct NodeEntry {
-			size_t begin;
-			size_t end;
-			TriangleBVHNode<FloatType> *node;
+	//! splits overlapping node pairs of both trees breadth-first (larger box first) until there are enough independent subtree pairs
+	//! to keep all threads busy; pairs of non-overlapping boxes are dropped; test is nullptr if the other tree is not transformed
+	void collectSubtreePairs(const TriMeshAcceleratorBVH<FloatType>& other, const typename TriangleBVHNode<FloatType>::TransformedBoxTest* test, std::vector<std::pair<const TriangleBVHNode<FloatType>*, const TriangleBVHNode<FloatType>*>>& subtreePairs) const {
+		auto overlaps = [test](const TriangleBVHNode<FloatType>* a, const TriangleBVHNode<FloatType>* b) {
+			return test ? test->overlaps(a->boundingBox, b->boundingBox) : a->boundingBox.intersects(b->boundingBox);
 		};
 
-		std::vector<NodeEntry> currLevel(1);
-		m_Root = new TriangleBVHNode<FloatType>;
-		currLevel[0].node = m_Root;
-		currLevel[0].begin = 0;
-		currLevel[0].end = tris.size();
-		
-		
-		unsigned int lastSortAxis = 0;
-		bool needFurtherSplitting = true;
-		while(needFurtherSplitting) {
-			needFurtherSplitting = false;
+		subtreePairs.clear();
+		if (!m_Root || !other.m_Root || !overlaps(m_Root, other.m_Root)) return;
+		subtreePairs.push_back(std::make_pair(m_Root, other.m_Root));
 
-			std::vector<NodeEntry> nextLevel(currLevel.size()*2);
-#pragma omp parallel for	
-			for (int i = 0; i < (int)std::min(currLevel.size(),tris.size()); i++) {
-				const size_t begin = currLevel[i].begin;
-				const size_t end = currLevel[i].end;
+		const size_t minSubtreePairs = 256;
+		std::vector<std::pair<const TriangleBVHNode<FloatType>*, const TriangleBVHNode<FloatType>*>> next;
+		bool split = true;
+		while (split && subtreePairs.size() < minSubtreePairs) {
+			split = false;
+			next.clear();
+			for (const auto& p : subtreePairs) {
+				const TriangleBVHNode<FloatType>* a = p.first;
+				const TriangleBVHNode<FloatType>* b = p.second;
+				if (a->isLeaf() && b->isLeaf()) {
+					next.push_back(p);
+					continue;
+				}
+				const TriangleBVHNode<FloatType>* children[2][2];
+				if (b->isLeaf() || (!a->isLeaf() && a->boundingBox.getSurfaceArea() >= b->boundingBox.getSurfaceArea())) {
+					children[0][0] = a->lChild;	children[0][1] = b;
+					children[1][0] = a->rChild;	children[1][1] = b;
+				} else {
+					children[0][0] = a;	children[0][1] = b->lChild;
+					children[1][0] = a;	children[1][1] = b->rChild;
+				}
+				for (unsigned int c = 0; c < 2; c++) {
+					if (overlaps(children[c][0], children[c][1])) next.push_back(std::make_pair(children[c][0], children[c][1]));
+				}
+				split = true;
+			}
+			subtreePairs.swap(next);
+		}
+	}
 
-				if (end - begin > 1) {
-					if (lastSortAxis == 0)		std::stable_sort(tris.begin()+begin, tris.begin()+end, TriangleBVHNode<FloatType>::cmpX);
-					else if (lastSortAxis == 1)	std::stable_sort(tris.begin()+begin, tris.begin()+end, TriangleBVHNode<FloatType>::cmpY);
-					else						std::stable_sort(tris.begin()+begin, tris.begin()+end, TriangleBVHNode<FloatType>::cmpZ);
+	//! defined by the interface
+	const typename TriMesh<FloatType>::Triangle* intersectInternal(const Ray<FloatType>& r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		return traverse(r, t, u, v, tmin, tmax, onlyFrontFaces, nullptr);
+	}
 
-					TriangleBVHNode<FloatType>* node = currLevel[i].node;
-					TriangleBVHNode<FloatType>* lChild = new TriangleBVHNode<FloatType>;
-					TriangleBVHNode<FloatType>* rChild = new TriangleBVHNode<FloatType>;
-					node->lChild = lChild;
-					node->rChild = rChild;
+	const typename TriMesh<FloatType>::Triangle* traverse(const Ray<FloatType>& r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin, FloatType tmax, bool onlyFrontFaces, typename TriMeshRayAccelerator<FloatType>::TraversalStats* stats) const {
+		u = v = std::numeric_limits<FloatType>::max();
+		t = tmax;
+		if (!m_Root) return nullptr;
 
-					nextLevel[2*i+0].begin = begin;
-					nextLevel[2*i+0].end = begin + ((end-begin)/2);
-					nextLevel[2*i+1].begin = begin + ((end-begin)/2);
-					nextLevel[2*i+1].end = end;
+		//a fixed size stack suffices unless the tree is degenerate (e.g., midpoint splits)
+		const TriangleBVHNode<FloatType>* localStack[64];
+		if (m_TreeDepth <= 64) return m_Root->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces, localStack, stats);
 
-					nextLevel[2*i+0].node = currLevel[i].node->lChild;
-					nextLevel[2*i+1].node = currLevel[i].node->rChild;
-					
-					if (nextLevel[2*i+0].end - nextLevel[2*i+0].begin < 2) lChild->leafTri = tris[nextLevel[2*i+0].begin];
-					else needFurtherSplitting = true;
-					if (nextLevel[2*i+1].end - nextLevel[2*i+1].begin < 2) rChild->leafTri = tris[nextLevel[2*i+1].begin];
-					else needFurtherSplitting = true;
-				} 
-			}
+		std::vector<const TriangleBVHNode<FloatType>*> heapStack(m_TreeDepth);
+		return m_Root->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces, heapStack.data(), stats);
+	}
 
-			if (needFurtherSplitting) {
-				currLevel = nextLevel;
-				lastSortAxis = (lastSortAxis+1)%3;
-			}
-		}
+	//! defined by the interface
+	bool occludedInternal(const Ray<FloatType>& r, FloatType tmin, FloatType tmax, bool onlyFrontFaces) const {
+		if (!m_Root) return false;
+
+		const TriangleBVHNode<FloatType>* localStack[64];
+		if (m_TreeDepth <= 64) return m_Root->occluded(r, tmin, tmax, onlyFrontFaces, localStack);
+
+		std::vector<const TriangleBVHNode<FloatType>*> heapStack(m_TreeDepth);
+		return m_Root->occluded(r, tmin, tmax, onlyFrontFaces, heapStack.data());
+	}
+
+	//! defined by the interface
+	void buildInternal() {
+		MLIB_PROFILE_ZONE("TriMeshAcceleratorBVH::build");
+		m_Root = nullptr;
+		m_Nodes.clear();
+		m_TreeDepth = 0;
+		m_BuildSAHCost = (FloatType)0;
+		m_PseudoNormals.clear();
+		m_PseudoNormalsValid = false;
+		if (TriMeshRayAccelerator<FloatType>::m_TrianglePointers.empty()) return;
+
+		typename TriangleBVHBuilder<FloatType>::SplitMode splitMode = TriangleBVHBuilder<FloatType>::SPLIT_MEDIAN;
+		if (m_BuildMode == BUILD_SAH)			splitMode = TriangleBVHBuilder<FloatType>::SPLIT_SAH;
+		else if (m_BuildMode == BUILD_MIDPOINT)	splitMode = TriangleBVHBuilder<FloatType>::SPLIT_MIDPOINT;
+
+		TriangleBVHBuilder<FloatType> builder(splitMode, m_NumBuildThreads, m_SAHNumBins, m_SAHMaxLeafSize);
+		m_Root = builder.build(TriMeshRayAccelerator<FloatType>::m_TrianglePointers, m_Nodes);
+		m_TreeDepth = m_Root->getTreeDepthRec();
+		m_BuildSAHCost = computeSAHCost();
+	}
+
+	//! defined by the interface; recomputes the bounding boxes bottom-up, independent subtrees in parallel
+	void refitInternal() {
+		m_PseudoNormals.clear();
+		m_PseudoNormalsValid = false;
+		if (!m_Root) return;
 
-		m_Root->computeBoundingBox();
+		//2^6 subtrees give enough parallelism; the nodes above them are updated afterwards
+		const unsigned int subtreeDepth = 6;
+		std::vector<TriangleBVHNode<FloatType>*> subtrees;
+		collectSubtrees(m_Root, 0, subtreeDepth, subtrees);
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < (int)subtrees.size(); i++) {
+			subtrees[i]->computeBoundingBox();
+		}
+		refitTopLevels(m_Root, 0, subtreeDepth);
 	}
 
-	void buildRecursive(std::vector<typename TriMesh<FloatType>::Triangle*>& tris) {
-		assert(tris.size() > 2);
-		m_Root = new TriangleBVHNode<FloatType>;
-		//m_Root->splitMedian(tris.begin(), tris.end(), 0);
-		m_Root->splitMidPoint(tris.begin(), tris.end());
-		m_Root->computeBoundingBox();
+	static void collectSubtrees(TriangleBVHNode<FloatType>* node, unsigned int depth, unsigned int subtreeDepth, std::vector<TriangleBVHNode<FloatType>*>& subtrees) {
+		if (depth == subtreeDepth || node->isLeaf()) {
+			subtrees.push_back(node);
+		} else {
+			collectSubtrees(node->lChild, depth + 1, subtreeDepth, subtrees);
+			collectSubtrees(node->rChild, depth + 1, subtreeDepth, subtrees);
+		}
 	}
 
+	static void refitTopLevels(TriangleBVHNode<FloatType>* node, unsigned int depth, unsigned int subtreeDepth) {
+		if (depth == subtreeDepth || node->isLeaf()) return;
+		refitTopLevels(node->lChild, depth + 1, subtreeDepth);
+		refitTopLevels(node->rChild, depth + 1, subtreeDepth);
+		node->boundingBox = node->lChild->boundingBox;
+		node->boundingBox.include(node->rChild->boundingBox);
+	}
 
 	//! private data
+	std::vector<TriangleBVHNode<FloatType>> m_Nodes;	//! m_Nodes[0] is the root
 	TriangleBVHNode<FloatType>* m_Root;
+	unsigned int m_TreeDepth;
+	FloatType m_BuildSAHCost;	//! SAH cost after the last build (see computeSAHCostRatio)
+
+	//! only used for signed closest point queries
+	mutable std::vector<TrianglePseudoNormals>	m_PseudoNormals;
+	mutable std::atomic<bool>					m_PseudoNormalsValid;
+	mutable std::mutex							m_PseudoNormalMutex;
+
+	BuildMode		m_BuildMode;
+	unsigned int	m_NumBuildThreads;
+	unsigned int	m_SAHNumBins;
+	unsigned int	m_SAHMaxLeafSize;
 
 };
 
+template<class BinaryDataBuffer, class BinaryDataCompressor, class FloatType>
+inline BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& operator<<(BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& s, const TriMeshAcceleratorBVH<FloatType>& bvh) {
+	bvh.writeToStream(s);
+	return s;
+}
+
+template<class BinaryDataBuffer, class BinaryDataCompressor, class FloatType>
+inline BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& operator>>(BinaryDataStream<BinaryDataBuffer, BinaryDataCompressor>& s, TriMeshAcceleratorBVH<FloatType>& bvh) {
+	bvh.readFromStream(s);
+	return s;
+}
+
 typedef TriMeshAcceleratorBVH<float>	TriMeshAcceleratorBVHf;
 typedef TriMeshAcceleratorBVH<double>	TriMeshAcceleratorBVHd;
 
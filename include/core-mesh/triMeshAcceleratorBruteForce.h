@@ -14,7 +14,11 @@ public:
 	}
 
 	TriMeshAcceleratorBruteForce(const TriMesh<FloatType>& triMesh, bool storeLocalCopy = false) {
-		build(triMesh, storeLocalCopy);
+		this->build(triMesh, storeLocalCopy);
+	}
+
+	size_t memoryFootprint() const {
+		return sizeof(*this) + this->getSharedMemoryFootprint();
 	}
 
 
@@ -72,6 +76,15 @@ private:
 		return tri;
 	}
 
+	//! interface definition
+	bool occludedInternal(const Ray<FloatType>& r, FloatType tmin, FloatType tmax, bool onlyFrontFaces) const {
+		FloatType t, u, v;
+		for (size_t i = 0; i < TriMeshRayAccelerator<FloatType>::m_TrianglePointers.size(); i++) {
+			if (TriMeshRayAccelerator<FloatType>::m_TrianglePointers[i]->intersect(r, t, u, v, tmin, tmax, onlyFrontFaces)) return true;
+		}
+		return false;
+	}
+
 	void buildInternal() {
 		//nothing to do here
 	}
@@ -0,0 +1,419 @@
+#pragma once
+
+#ifndef _TRIMESH_ACCELERATOR_LINEAR_BVH_H_
+#define _TRIMESH_ACCELERATOR_LINEAR_BVH_H_
+
+namespace ml {
+
+//////////////////////////////////////////////////////////////////////////
+// Compact BVH: nodes are stored contiguously in depth-first order;
+// the left child of an inner node is the next node, the right child is
+// referenced by index. Leaves reference a range of triangles whose vertex
+// positions are copied into a packed array (3 positions per triangle).
+//////////////////////////////////////////////////////////////////////////
+
+template <class FloatType>
+struct LinearBVHNode {
+	BoundingBox3<FloatType> boundingBox;
+	unsigned int offset;	//! leaf: index of the first triangle; inner node: index of the right child
+	unsigned short numTris;	//! number of triangles of a leaf; 0 for inner nodes
+	unsigned short axis;	//! split axis of an inner node (the left child holds the smaller centroids)
+
+	inline bool isLeaf() const {
+		return numTris > 0;
+	}
+};
+
+template <class FloatType>
+class TriMeshAcceleratorLinearBVH : public TriMeshRayAccelerator<FloatType>
+{
+public:
+
+	TriMeshAcceleratorLinearBVH() {
+		m_MaxLeafSize = 4;
+		m_MaxDepth = 0;
+	}
+	TriMeshAcceleratorLinearBVH(const TriMesh<FloatType>& triMesh, bool storeLocalCopy = false) {
+		m_MaxLeafSize = 4;
+		m_MaxDepth = 0;
+		this->build(triMesh, storeLocalCopy);
+	}
+
+	~TriMeshAcceleratorLinearBVH() {
+	}
+
+	//! maximum number of triangles per leaf (applies to subsequent build calls)
+	void setMaxLeafSize(unsigned int maxLeafSize) {
+		if (maxLeafSize < 1) throw MLIB_EXCEPTION("leaves must hold at least one triangle");
+		if (maxLeafSize > std::numeric_limits<unsigned short>::max()) throw MLIB_EXCEPTION("leaf size exceeds the node's triangle count range");
+		m_MaxLeafSize = maxLeafSize;
+	}
+
+	size_t getNumNodes() const {
+		return m_Nodes.size();
+	}
+
+	const std::vector<LinearBVHNode<FloatType>>& getNodes() const {
+		return m_Nodes;
+	}
+
+	void printInfo() const {
+		std::cout << "Info: LinearBVHAccelerator build done ( " << m_PackedTriangles.size() << " tris )" << std::endl;
+		std::cout << "Info: Tree depth " << m_MaxDepth << std::endl;
+		std::cout << "Info: NumNodes " << m_Nodes.size() << std::endl;
+		std::cout << "Info: Node size " << sizeof(LinearBVHNode<FloatType>) << " bytes" << std::endl;
+	}
+
+	//! bytes held by the nodes, packed triangles, triangles and local vertex copies
+	size_t memoryFootprint() const {
+		return sizeof(*this) + this->getSharedMemoryFootprint() + util::memoryFootprint(m_Nodes) +
+			util::memoryFootprint(m_PackedVertices) + util::memoryFootprint(m_PackedTriangles);
+	}
+
+	using TriMeshRayAccelerator<FloatType>::intersect;
+
+	//! same as intersect, but accumulates the number of box and triangle tests into stats
+	typename TriMeshRayAccelerator<FloatType>::Intersection intersect(const Ray<FloatType>& r, typename TriMeshRayAccelerator<FloatType>::TraversalStats& stats, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		typename TriMeshRayAccelerator<FloatType>::Intersection i;
+		i.triangle = traverse(r, i.t, i.u, i.v, tmin, tmax, onlyFrontFaces, &stats);
+		return i;
+	}
+
+private:
+
+	//! defined by the interface
+	const typename TriMesh<FloatType>::Triangle* intersectInternal(const Ray<FloatType>& r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		return traverse(r, t, u, v, tmin, tmax, onlyFrontFaces, nullptr);
+	}
+
+	//! front-to-back traversal: the child on the near side of the split plane is visited first and tmax shrinks with every hit
+	const typename TriMesh<FloatType>::Triangle* traverse(const Ray<FloatType>& r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin, FloatType tmax, bool onlyFrontFaces, typename TriMeshRayAccelerator<FloatType>::TraversalStats* stats) const {
+		u = v = std::numeric_limits<FloatType>::max();
+		t = tmax;
+		if (m_Nodes.empty()) return nullptr;
+
+		//a fixed size stack suffices unless the tree is degenerate
+		unsigned int localStack[64];
+		std::vector<unsigned int> heapStack;
+		unsigned int* stack = localStack;
+		if (m_MaxDepth > 64) {
+			heapStack.resize(m_MaxDepth);
+			stack = heapStack.data();
+		}
+		unsigned int stackSize = 0;
+
+		const vec3i& sign = r.getSign();
+		const typename TriMesh<FloatType>::Triangle* hit = nullptr;
+		unsigned int nodeIdx = 0;
+		while (true) {
+			const LinearBVHNode<FloatType>& node = m_Nodes[nodeIdx];
+			if (stats) stats->numNodeTests++;
+			if (node.boundingBox.intersect(r, tmin, tmax)) {
+				if (node.isLeaf()) {
+					if (stats) stats->numTriangleTests += node.numTris;
+					const vec3<FloatType>* v0 = &m_PackedVertices[3 * node.offset];
+					for (unsigned int i = 0; i < node.numTris; i++, v0 += 3) {
+						if (intersection::intersectRayTriangle(v0[0], v0[1], v0[2], r, t, u, v, tmin, tmax, onlyFrontFaces)) {
+							tmax = t;
+							hit = m_PackedTriangles[node.offset + i];
+						}
+					}
+				} else {
+					if (sign[node.axis]) {
+						stack[stackSize++] = nodeIdx + 1;
+						nodeIdx = node.offset;
+					} else {
+						stack[stackSize++] = node.offset;
+						nodeIdx++;
+					}
+					continue;
+				}
+			}
+			if (stackSize == 0) break;
+			nodeIdx = stack[--stackSize];
+		}
+		return hit;
+	}
+
+	//! defined by the interface; same traversal as above but returns at the first hit
+	bool occludedInternal(const Ray<FloatType>& r, FloatType tmin, FloatType tmax, bool onlyFrontFaces) const {
+		if (m_Nodes.empty()) return false;
+
+		unsigned int localStack[64];
+		std::vector<unsigned int> heapStack;
+		unsigned int* stack = localStack;
+		if (m_MaxDepth > 64) {
+			heapStack.resize(m_MaxDepth);
+			stack = heapStack.data();
+		}
+		unsigned int stackSize = 0;
+
+		const vec3i& sign = r.getSign();
+		FloatType t, u, v;
+		unsigned int nodeIdx = 0;
+		while (true) {
+			const LinearBVHNode<FloatType>& node = m_Nodes[nodeIdx];
+			if (node.boundingBox.intersect(r, tmin, tmax)) {
+				if (node.isLeaf()) {
+					const vec3<FloatType>* v0 = &m_PackedVertices[3 * node.offset];
+					for (unsigned int i = 0; i < node.numTris; i++, v0 += 3) {
+						if (intersection::intersectRayTriangle(v0[0], v0[1], v0[2], r, t, u, v, tmin, tmax, onlyFrontFaces)) return true;
+					}
+				} else {
+					if (sign[node.axis]) {
+						stack[stackSize++] = nodeIdx + 1;
+						nodeIdx = node.offset;
+					} else {
+						stack[stackSize++] = node.offset;
+						nodeIdx++;
+					}
+					continue;
+				}
+			}
+			if (stackSize == 0) break;
+			nodeIdx = stack[--stackSize];
+		}
+		return false;
+	}
+
+	//! defined by the interface; consecutive groups of 4 rays are traced as a packet, rays that cannot form a packet are traced one by one
+	void intersectBatchInternal(const Ray<FloatType>* rays, typename TriMeshRayAccelerator<FloatType>::Intersection* results, size_t numRays, FloatType tmin, FloatType tmax, bool onlyFrontFaces) const {
+		const int numPackets = (int)((numRays + 3) / 4);
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+		for (int p = 0; p < numPackets; p++) {
+			const size_t begin = 4 * (size_t)p;
+			const size_t end = std::min(begin + 4, numRays);
+			if (intersectPacket(rays + begin, results + begin, end - begin, tmin, tmax, onlyFrontFaces, std::is_same<FloatType, float>())) continue;
+
+			for (size_t i = begin; i < end; i++) {
+				typename TriMeshRayAccelerator<FloatType>::Intersection& res = results[i];
+				res.triangle = traverse(rays[i], res.t, res.u, res.v, tmin, tmax, onlyFrontFaces, nullptr);
+			}
+		}
+	}
+
+	//! there is no packet traversal for double precision
+	bool intersectPacket(const Ray<FloatType>* rays, typename TriMeshRayAccelerator<FloatType>::Intersection* results, size_t numRays, FloatType tmin, FloatType tmax, bool onlyFrontFaces, std::false_type) const {
+		return false;
+	}
+
+	//! 4-wide SSE packet traversal: one box test per node for all rays and every leaf triangle is tested against all rays at once;
+	//! returns false if the rays diverge (different direction signs, so there is no common front-to-back order) or do not fill a packet
+	bool intersectPacket(const Ray<FloatType>* rays, typename TriMeshRayAccelerator<FloatType>::Intersection* results, size_t numRays, FloatType tmin, FloatType tmax, bool onlyFrontFaces, std::true_type) const {
+#ifdef MLIB_SSE
+		if (numRays != 4 || m_Nodes.empty()) return false;
+		const vec3i& sign = rays[0].getSign();
+		if (rays[1].getSign() != sign || rays[2].getSign() != sign || rays[3].getSign() != sign) return false;
+
+		const __m128 ox = _mm_setr_ps(rays[0].getOrigin().x, rays[1].getOrigin().x, rays[2].getOrigin().x, rays[3].getOrigin().x);
+		const __m128 oy = _mm_setr_ps(rays[0].getOrigin().y, rays[1].getOrigin().y, rays[2].getOrigin().y, rays[3].getOrigin().y);
+		const __m128 oz = _mm_setr_ps(rays[0].getOrigin().z, rays[1].getOrigin().z, rays[2].getOrigin().z, rays[3].getOrigin().z);
+		const __m128 dx = _mm_setr_ps(rays[0].getDirection().x, rays[1].getDirection().x, rays[2].getDirection().x, rays[3].getDirection().x);
+		const __m128 dy = _mm_setr_ps(rays[0].getDirection().y, rays[1].getDirection().y, rays[2].getDirection().y, rays[3].getDirection().y);
+		const __m128 dz = _mm_setr_ps(rays[0].getDirection().z, rays[1].getDirection().z, rays[2].getDirection().z, rays[3].getDirection().z);
+		const __m128 idx = _mm_setr_ps(rays[0].getInverseDirection().x, rays[1].getInverseDirection().x, rays[2].getInverseDirection().x, rays[3].getInverseDirection().x);
+		const __m128 idy = _mm_setr_ps(rays[0].getInverseDirection().y, rays[1].getInverseDirection().y, rays[2].getInverseDirection().y, rays[3].getInverseDirection().y);
+		const __m128 idz = _mm_setr_ps(rays[0].getInverseDirection().z, rays[1].getInverseDirection().z, rays[2].getInverseDirection().z, rays[3].getInverseDirection().z);
+
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 tminV = _mm_set1_ps(tmin);
+		__m128 tmaxV = _mm_set1_ps(tmax);
+		__m128 uV = _mm_set1_ps(std::numeric_limits<float>::max());
+		__m128 vV = uV;
+		const typename TriMesh<FloatType>::Triangle* hit[4] = { nullptr, nullptr, nullptr, nullptr };
+
+		unsigned int localStack[64];
+		std::vector<unsigned int> heapStack;
+		unsigned int* stack = localStack;
+		if (m_MaxDepth > 64) {
+			heapStack.resize(m_MaxDepth);
+			stack = heapStack.data();
+		}
+		unsigned int stackSize = 0;
+
+		unsigned int nodeIdx = 0;
+		while (true) {
+			const LinearBVHNode<FloatType>& node = m_Nodes[nodeIdx];
+			const BoundingBox3<FloatType>& box = node.boundingBox;
+
+			//slab test; NaNs (ray inside a slab plane) are the first operand of min/max and therefore discarded
+			const __m128 nx = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(sign.x ? box.getMaxX() : box.getMinX()), ox), idx);
+			const __m128 fx = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(sign.x ? box.getMinX() : box.getMaxX()), ox), idx);
+			const __m128 ny = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(sign.y ? box.getMaxY() : box.getMinY()), oy), idy);
+			const __m128 fy = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(sign.y ? box.getMinY() : box.getMaxY()), oy), idy);
+			const __m128 nz = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(sign.z ? box.getMaxZ() : box.getMinZ()), oz), idz);
+			const __m128 fz = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(sign.z ? box.getMinZ() : box.getMaxZ()), oz), idz);
+			const __m128 tNear = _mm_max_ps(nz, _mm_max_ps(ny, _mm_max_ps(nx, tminV)));
+			const __m128 tFar = _mm_min_ps(fz, _mm_min_ps(fy, _mm_min_ps(fx, tmaxV)));
+
+			if (_mm_movemask_ps(_mm_cmple_ps(tNear, tFar))) {
+				if (node.isLeaf()) {
+					const vec3<FloatType>* v0 = &m_PackedVertices[3 * node.offset];
+					for (unsigned int i = 0; i < node.numTris; i++, v0 += 3) {
+						//Moeller-Trumbore for 4 rays (same operation order as intersection::intersectRayTriangle)
+						const vec3<FloatType> e1 = v0[1] - v0[0];
+						const vec3<FloatType> e2 = v0[2] - v0[0];
+						const __m128 e1x = _mm_set1_ps(e1.x), e1y = _mm_set1_ps(e1.y), e1z = _mm_set1_ps(e1.z);
+						const __m128 e2x = _mm_set1_ps(e2.x), e2y = _mm_set1_ps(e2.y), e2z = _mm_set1_ps(e2.z);
+
+						const __m128 hx = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+						const __m128 hy = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+						const __m128 hz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+						const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, hx), _mm_mul_ps(e1y, hy)), _mm_mul_ps(e1z, hz));
+						const __m128 f = _mm_div_ps(one, a);
+
+						const __m128 sx = _mm_sub_ps(ox, _mm_set1_ps(v0[0].x));
+						const __m128 sy = _mm_sub_ps(oy, _mm_set1_ps(v0[0].y));
+						const __m128 sz = _mm_sub_ps(oz, _mm_set1_ps(v0[0].z));
+						const __m128 u = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, hx), _mm_mul_ps(sy, hy)), _mm_mul_ps(sz, hz)));
+
+						const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+						const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+						const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+						const __m128 v = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)));
+						const __m128 t = _mm_mul_ps(f, _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)));
+
+						__m128 mask = _mm_cmpneq_ps(a, zero);
+						mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+						mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+						mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(t, tminV), _mm_cmple_ps(t, tmaxV)));
+						if (onlyFrontFaces) {
+							const vec3<FloatType> n = e1 ^ e2;
+							const __m128 dn = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(n.x)), _mm_mul_ps(dy, _mm_set1_ps(n.y))), _mm_mul_ps(dz, _mm_set1_ps(n.z)));
+							mask = _mm_andnot_ps(_mm_cmpgt_ps(dn, zero), mask);
+						}
+
+						const int hitMask = _mm_movemask_ps(mask);
+						if (hitMask) {
+							tmaxV = _mm_or_ps(_mm_and_ps(mask, t), _mm_andnot_ps(mask, tmaxV));
+							uV = _mm_or_ps(_mm_and_ps(mask, u), _mm_andnot_ps(mask, uV));
+							vV = _mm_or_ps(_mm_and_ps(mask, v), _mm_andnot_ps(mask, vV));
+							for (unsigned int k = 0; k < 4; k++) {
+								if (hitMask & (1 << k)) hit[k] = m_PackedTriangles[node.offset + i];
+							}
+						}
+					}
+				} else {
+					if (sign[node.axis]) {
+						stack[stackSize++] = nodeIdx + 1;
+						nodeIdx = node.offset;
+					} else {
+						stack[stackSize++] = node.offset;
+						nodeIdx++;
+					}
+					continue;
+				}
+			}
+			if (stackSize == 0) break;
+			nodeIdx = stack[--stackSize];
+		}
+
+		float tRes[4], uRes[4], vRes[4];
+		_mm_storeu_ps(tRes, tmaxV);
+		_mm_storeu_ps(uRes, uV);
+		_mm_storeu_ps(vRes, vV);
+		for (unsigned int k = 0; k < 4; k++) {
+			results[k].triangle = hit[k];
+			results[k].t = tRes[k];
+			results[k].u = uRes[k];
+			results[k].v = vRes[k];
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	//! defined by the interface
+	void buildInternal() {
+		m_Nodes.clear();
+		m_PackedVertices.clear();
+		m_PackedTriangles.clear();
+		m_MaxDepth = 0;
+
+		std::vector<typename TriMesh<FloatType>::Triangle*>& tris = TriMeshRayAccelerator<FloatType>::m_TrianglePointers;
+		if (tris.empty()) return;
+
+		//build a temporary pointer-based SAH tree and flatten it
+		std::vector<TriangleBVHNode<FloatType>> nodes;
+		TriangleBVHBuilder<FloatType> builder(TriangleBVHBuilder<FloatType>::SPLIT_SAH, 0, 16, m_MaxLeafSize);
+		const TriangleBVHNode<FloatType>* root = builder.build(tris, nodes);
+
+		m_Nodes.reserve(nodes.size());
+		m_PackedTriangles.reserve(tris.size());
+		m_PackedVertices.reserve(3 * tris.size());
+		flatten(root, 1);
+	}
+
+	//! defined by the interface; children are stored after their parents, so a reverse sweep updates the boxes bottom-up
+	void refitInternal() {
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < (int)m_PackedTriangles.size(); i++) {
+			m_PackedVertices[3 * i + 0] = m_PackedTriangles[i]->getV0().position;
+			m_PackedVertices[3 * i + 1] = m_PackedTriangles[i]->getV1().position;
+			m_PackedVertices[3 * i + 2] = m_PackedTriangles[i]->getV2().position;
+		}
+
+		for (size_t i = m_Nodes.size(); i-- > 0;) {
+			LinearBVHNode<FloatType>& node = m_Nodes[i];
+			node.boundingBox.reset();
+			if (node.isLeaf()) {
+				for (unsigned int k = 3 * node.offset; k < 3 * (node.offset + node.numTris); k++) {
+					node.boundingBox.include(m_PackedVertices[k]);
+				}
+			} else {
+				node.boundingBox.include(m_Nodes[i + 1].boundingBox);
+				node.boundingBox.include(m_Nodes[node.offset].boundingBox);
+			}
+		}
+	}
+
+	//! appends the subtree in depth-first order; returns the index of the subtree root
+	unsigned int flatten(const TriangleBVHNode<FloatType>* node, unsigned int depth) {
+		m_MaxDepth = std::max(m_MaxDepth, depth);
+
+		const unsigned int nodeIdx = (unsigned int)m_Nodes.size();
+		m_Nodes.push_back(LinearBVHNode<FloatType>());
+		m_Nodes[nodeIdx].boundingBox = node->boundingBox;
+
+		if (node->isLeaf()) {
+			m_Nodes[nodeIdx].offset = (unsigned int)m_PackedTriangles.size();
+			m_Nodes[nodeIdx].numTris = (unsigned short)node->numLeafTris;
+			m_Nodes[nodeIdx].axis = 0;
+			for (unsigned int i = 0; i < node->numLeafTris; i++) {
+				const typename TriMesh<FloatType>::Triangle* tri = node->leafTris[i];
+				m_PackedTriangles.push_back(tri);
+				m_PackedVertices.push_back(tri->getV0().position);
+				m_PackedVertices.push_back(tri->getV1().position);
+				m_PackedVertices.push_back(tri->getV2().position);
+			}
+		} else {
+			m_Nodes[nodeIdx].numTris = 0;
+			m_Nodes[nodeIdx].axis = (unsigned short)node->splitAxis;
+			flatten(node->lChild, depth + 1);
+			const unsigned int rightIdx = flatten(node->rChild, depth + 1);
+			m_Nodes[nodeIdx].offset = rightIdx;
+		}
+		return nodeIdx;
+	}
+
+	//! private data
+	std::vector<LinearBVHNode<FloatType>>					m_Nodes;
+	std::vector<vec3<FloatType>>							m_PackedVertices;	//! 3 positions per triangle, in leaf order
+	std::vector<const typename TriMesh<FloatType>::Triangle*>	m_PackedTriangles;	//! triangle references, in leaf order
+
+	unsigned int m_MaxLeafSize;
+	unsigned int m_MaxDepth;
+};
+
+typedef TriMeshAcceleratorLinearBVH<float>	TriMeshAcceleratorLinearBVHf;
+typedef TriMeshAcceleratorLinearBVH<double>	TriMeshAcceleratorLinearBVHd;
+
+} // namespace ml
+
+#endif
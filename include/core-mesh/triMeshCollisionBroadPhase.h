@@ -0,0 +1,274 @@
+#pragma once
+
+#ifndef _TRIMESH_COLLISION_BROADPHASE_H_
+#define _TRIMESH_COLLISION_BROADPHASE_H_
+
+namespace ml {
+
+//////////////////////////////////////////////////////////////////////////
+// Broad phase for many placed objects, each a (shared) collision
+// accelerator and an object-to-world transform. The world space bounding
+// boxes are kept sorted along a sweep axis (sweep and prune); moving an
+// object re-sorts only its own endpoints, which is cheap for small
+// motions. Candidate pairs are passed to the accelerators' narrow phase
+// with the relative transform of the two objects.
+//////////////////////////////////////////////////////////////////////////
+
+template <class FloatType, class Accelerator = TriMeshAcceleratorBVH<FloatType>>
+class TriMeshCollisionBroadPhase
+{
+public:
+
+	struct Object
+	{
+		const Accelerator* accelerator;
+		Matrix4x4<FloatType> objectToWorld;
+		Matrix4x4<FloatType> worldToObject;
+		BoundingBox3<FloatType> worldBoundingBox;
+		unsigned int minEndpoint;	//! positions of the box's endpoints in the sorted endpoint list
+		unsigned int maxEndpoint;
+		bool active;				//! false for removed objects (their index is reused by addObject)
+	};
+
+	TriMeshCollisionBroadPhase() {
+		m_SweepAxis = 0;
+	}
+
+	//! adds an object (the accelerator must outlive this object and must not be rebuilt without calling updateObject); returns the object index
+	unsigned int addObject(const Accelerator* accelerator, const Matrix4x4<FloatType>& objectToWorld = Matrix4x4<FloatType>::identity()) {
+		unsigned int idx;
+		if (!m_FreeObjects.empty()) {
+			idx = m_FreeObjects.back();
+			m_FreeObjects.pop_back();
+		} else {
+			idx = (unsigned int)m_Objects.size();
+			m_Objects.push_back(Object());
+		}
+
+		Object& o = m_Objects[idx];
+		o.accelerator = accelerator;
+		o.active = true;
+		o.minEndpoint = (unsigned int)m_Endpoints.size();
+		o.maxEndpoint = o.minEndpoint + 1;
+		m_Endpoints.push_back(Endpoint(idx, true));
+		m_Endpoints.push_back(Endpoint(idx, false));
+		setTransform(idx, objectToWorld);
+		return idx;
+	}
+
+	//! moves an object; only its endpoints are re-sorted
+	void updateObject(unsigned int idx, const Matrix4x4<FloatType>& objectToWorld) {
+		assert(idx < m_Objects.size() && m_Objects[idx].active);
+		setTransform(idx, objectToWorld);
+	}
+
+	void removeObject(unsigned int idx) {
+		assert(idx < m_Objects.size() && m_Objects[idx].active);
+		Object& o = m_Objects[idx];
+
+		const unsigned int first = std::min(o.minEndpoint, o.maxEndpoint);
+		const unsigned int second = std::max(o.minEndpoint, o.maxEndpoint);
+		m_Endpoints.erase(m_Endpoints.begin() + second);
+		m_Endpoints.erase(m_Endpoints.begin() + first);
+		for (unsigned int i = first; i < m_Endpoints.size(); i++) {
+			setEndpointPosition(i);
+		}
+
+		o.active = false;
+		o.accelerator = nullptr;
+		m_FreeObjects.push_back(idx);
+	}
+
+	void clear() {
+		m_Objects.clear();
+		m_FreeObjects.clear();
+		m_Endpoints.clear();
+	}
+
+	//! number of object indices in use (including removed ones)
+	size_t getNumObjects() const {
+		return m_Objects.size();
+	}
+
+	const Object& getObject(size_t idx) const {
+		return m_Objects[idx];
+	}
+
+	//! pairs (i < j) of objects whose world space bounding boxes overlap, sorted by i and j; the sweep axis is switched to the axis along
+	//! which the object centers vary most, if it separates the objects considerably better than the current one
+	void computeCandidatePairs(std::vector<std::pair<unsigned int, unsigned int>>& pairs) {
+		pairs.clear();
+		updateSweepAxis();
+
+		std::vector<unsigned int> activeObjects;
+		for (const Endpoint& e : m_Endpoints) {
+			const Object& o = m_Objects[e.object];
+			if (!o.worldBoundingBox.isValid()) continue;
+			if (e.isMin) {
+				for (unsigned int other : activeObjects) {
+					if (o.worldBoundingBox.intersects(m_Objects[other].worldBoundingBox)) {
+						pairs.push_back(std::make_pair(std::min(e.object, other), std::max(e.object, other)));
+					}
+				}
+				activeObjects.push_back(e.object);
+			} else {
+				for (size_t i = 0; i < activeObjects.size(); i++) {
+					if (activeObjects[i] == e.object) {
+						activeObjects[i] = activeObjects.back();
+						activeObjects.pop_back();
+						break;
+					}
+				}
+			}
+		}
+		std::sort(pairs.begin(), pairs.end());
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> computeCandidatePairs() {
+		std::vector<std::pair<unsigned int, unsigned int>> pairs;
+		computeCandidatePairs(pairs);
+		return pairs;
+	}
+
+	//! pairs (i < j) of colliding objects: the candidate pairs are tested with the narrow phase of the accelerators (in parallel if OpenMP is enabled)
+	void computeCollisions(std::vector<std::pair<unsigned int, unsigned int>>& collisions) {
+		std::vector<std::pair<unsigned int, unsigned int>> candidates;
+		computeCandidatePairs(candidates);
+
+		std::vector<unsigned char> colliding(candidates.size());
+#ifdef MLIB_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for (int i = 0; i < (int)candidates.size(); i++) {
+			colliding[i] = collision(candidates[i].first, candidates[i].second) ? 1 : 0;
+		}
+
+		collisions.clear();
+		for (size_t i = 0; i < candidates.size(); i++) {
+			if (colliding[i]) collisions.push_back(candidates[i]);
+		}
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> computeCollisions() {
+		std::vector<std::pair<unsigned int, unsigned int>> collisions;
+		computeCollisions(collisions);
+		return collisions;
+	}
+
+	//! narrow phase of two objects: the accelerator of b is placed in the object space of a
+	bool collision(unsigned int a, unsigned int b) const {
+		return m_Objects[a].accelerator->collision(*m_Objects[b].accelerator, getRelativeTransform(a, b));
+	}
+
+	//! transforms from the object space of b into the object space of a
+	Matrix4x4<FloatType> getRelativeTransform(unsigned int a, unsigned int b) const {
+		return m_Objects[a].worldToObject * m_Objects[b].objectToWorld;
+	}
+
+private:
+
+	struct Endpoint
+	{
+		Endpoint(unsigned int _object, bool _isMin) : value((FloatType)0), object(_object), isMin(_isMin) {}
+
+		//! min endpoints precede max endpoints of the same value, so touching boxes overlap (as for BoundingBox3::intersects)
+		bool operator<(const Endpoint& other) const {
+			if (value != other.value) return value < other.value;
+			return isMin && !other.isMin;
+		}
+
+		FloatType value;
+		unsigned int object;
+		bool isMin;
+	};
+
+	void setTransform(unsigned int idx, const Matrix4x4<FloatType>& objectToWorld) {
+		Object& o = m_Objects[idx];
+		o.objectToWorld = objectToWorld;
+		o.worldToObject = objectToWorld.getInverse();
+		o.worldBoundingBox.reset();
+		if (o.accelerator->getBoundingBox().isValid()) o.worldBoundingBox = o.accelerator->getBoundingBox() * objectToWorld;
+		updateEndpointValues(idx);
+		// a min endpoint moving right stops at its own max endpoint if that is not yet in place, so it is sifted again after the max endpoint
+		siftEndpoint(o.minEndpoint);
+		siftEndpoint(o.maxEndpoint);
+		siftEndpoint(o.minEndpoint);
+	}
+
+	//! objects without triangles are sorted to the end (and skipped by the sweep)
+	void updateEndpointValues(unsigned int idx) {
+		const Object& o = m_Objects[idx];
+		const bool valid = o.worldBoundingBox.isValid();
+		m_Endpoints[o.minEndpoint].value = valid ? o.worldBoundingBox.getMin()[m_SweepAxis] : std::numeric_limits<FloatType>::max();
+		m_Endpoints[o.maxEndpoint].value = valid ? o.worldBoundingBox.getMax()[m_SweepAxis] : std::numeric_limits<FloatType>::max();
+	}
+
+	//! insertion sort step: moves the endpoint at pos to its sorted position; returns the new position
+	unsigned int siftEndpoint(unsigned int pos) {
+		while (pos > 0 && m_Endpoints[pos] < m_Endpoints[pos - 1]) {
+			swapEndpoints(pos, pos - 1);
+			pos--;
+		}
+		while (pos + 1 < m_Endpoints.size() && m_Endpoints[pos + 1] < m_Endpoints[pos]) {
+			swapEndpoints(pos, pos + 1);
+			pos++;
+		}
+		return pos;
+	}
+
+	void swapEndpoints(unsigned int a, unsigned int b) {
+		std::swap(m_Endpoints[a], m_Endpoints[b]);
+		setEndpointPosition(a);
+		setEndpointPosition(b);
+	}
+
+	void setEndpointPosition(unsigned int pos) {
+		const Endpoint& e = m_Endpoints[pos];
+		if (e.isMin)	m_Objects[e.object].minEndpoint = pos;
+		else			m_Objects[e.object].maxEndpoint = pos;
+	}
+
+	//! switches to the axis of the largest variance of the object centers if it is at least twice the variance along the current axis
+	void updateSweepAxis() {
+		vec3<FloatType> sum = vec3<FloatType>::origin, sumSq = vec3<FloatType>::origin;
+		FloatType n = (FloatType)0;
+		for (const Object& o : m_Objects) {
+			if (!o.active || !o.worldBoundingBox.isValid()) continue;
+			const vec3<FloatType> c = o.worldBoundingBox.getCenter();
+			sum += c;
+			sumSq += vec3<FloatType>(c.x * c.x, c.y * c.y, c.z * c.z);
+			n += (FloatType)1;
+		}
+		if (n < (FloatType)2) return;
+
+		FloatType variance[3];
+		unsigned int bestAxis = m_SweepAxis;
+		for (unsigned int i = 0; i < 3; i++) {
+			variance[i] = sumSq[i] / n - (sum[i] / n) * (sum[i] / n);
+			if (variance[i] > variance[bestAxis]) bestAxis = i;
+		}
+		if (bestAxis == m_SweepAxis || variance[bestAxis] < (FloatType)2 * variance[m_SweepAxis]) return;
+
+		m_SweepAxis = bestAxis;
+		for (unsigned int i = 0; i < m_Objects.size(); i++) {
+			if (m_Objects[i].active) updateEndpointValues(i);
+		}
+		std::sort(m_Endpoints.begin(), m_Endpoints.end());
+		for (unsigned int i = 0; i < m_Endpoints.size(); i++) {
+			setEndpointPosition(i);
+		}
+	}
+
+	//! private data
+	std::vector<Object>			m_Objects;
+	std::vector<unsigned int>	m_FreeObjects;	//! indices of removed objects
+	std::vector<Endpoint>		m_Endpoints;	//! min and max of each active object's box along the sweep axis, sorted
+	unsigned int				m_SweepAxis;
+};
+
+typedef TriMeshCollisionBroadPhase<float>	TriMeshCollisionBroadPhasef;
+typedef TriMeshCollisionBroadPhase<double>	TriMeshCollisionBroadPhased;
+
+} // namespace ml
+
+#endif
@@ -0,0 +1,221 @@
+#pragma once
+
+#ifndef _TRIMESH_INSTANCE_ACCELERATOR_H_
+#define _TRIMESH_INSTANCE_ACCELERATOR_H_
+
+namespace ml {
+
+//////////////////////////////////////////////////////////////////////////
+// Two-level acceleration structure: a top-level BVH over the world space
+// bounds of instances, each referencing a (shared) mesh ray accelerator
+// and an object-to-world transform. Rays are transformed into object space
+// per instance; distances are always reported in world space.
+//////////////////////////////////////////////////////////////////////////
+
+template <class FloatType>
+class TriMeshInstanceAccelerator
+{
+public:
+
+	struct Instance
+	{
+		const TriMeshRayAccelerator<FloatType>* accelerator;
+		Matrix4x4<FloatType> objectToWorld;
+		Matrix4x4<FloatType> worldToObject;
+		BoundingBox3<FloatType> worldBoundingBox;
+	};
+
+	//! t is the world space distance; the surface attributes (getSurfacePosition, ...) and the mesh index refer to the instance's accelerator
+	struct Intersection : public TriMeshRayAccelerator<FloatType>::Intersection
+	{
+		Intersection() : instanceIndex((unsigned int)-1) {}
+
+		unsigned int getInstanceIndex() const {
+			return instanceIndex;
+		}
+
+		unsigned int instanceIndex;
+	};
+
+	TriMeshInstanceAccelerator() {
+		m_MaxDepth = 0;
+	}
+
+	//! adds an instance of a mesh accelerator (which must outlive this object); returns the instance index; call build afterwards
+	unsigned int addInstance(const TriMeshRayAccelerator<FloatType>* accelerator, const Matrix4x4<FloatType>& objectToWorld = Matrix4x4<FloatType>::identity()) {
+		Instance instance;
+		instance.accelerator = accelerator;
+		instance.objectToWorld = objectToWorld;
+		instance.worldToObject = objectToWorld.getInverse();
+		instance.worldBoundingBox = accelerator->getBoundingBox() * objectToWorld;
+		m_Instances.push_back(instance);
+		return (unsigned int)m_Instances.size() - 1;
+	}
+
+	void clear() {
+		m_Instances.clear();
+		m_Nodes.clear();
+		m_InstanceIndices.clear();
+		m_MaxDepth = 0;
+	}
+
+	size_t getNumInstances() const {
+		return m_Instances.size();
+	}
+
+	const Instance& getInstance(size_t i) const {
+		return m_Instances[i];
+	}
+
+	//! bytes held by the instances and the top-level tree (the referenced accelerators are not included)
+	size_t memoryFootprint() const {
+		return sizeof(*this) + util::memoryFootprint(m_Instances) + util::memoryFootprint(m_Nodes) + util::memoryFootprint(m_InstanceIndices);
+	}
+
+	//! builds the top-level tree over the instances' world bounding boxes (object median splits along the longest axis)
+	void build() {
+		MLIB_MEMORY_SCOPE(MEMORY_ACCELERATOR);
+		m_Nodes.clear();
+		m_InstanceIndices.resize(m_Instances.size());
+		for (size_t i = 0; i < m_Instances.size(); i++) {
+			m_InstanceIndices[i] = (unsigned int)i;
+		}
+		m_MaxDepth = 0;
+		if (m_Instances.empty()) return;
+
+		m_Nodes.reserve(2 * m_Instances.size());
+		buildRecursive(0, m_Instances.size(), 1);
+	}
+
+	Intersection intersect(const Ray<FloatType>& r, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		Intersection res;
+		traverse(r, tmin, tmax, onlyFrontFaces, &res);
+		return res;
+	}
+
+	bool intersect(const Ray<FloatType>& r, Intersection& i, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		i = intersect(r, tmin, tmax, onlyFrontFaces);
+		return i.isValid();
+	}
+
+	//! any-hit query; returns as soon as an instance is hit within [tmin, tmax]
+	bool occluded(const Ray<FloatType>& r, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		return traverse(r, tmin, tmax, onlyFrontFaces, nullptr);
+	}
+
+private:
+
+	//! closest hit if res is given, any hit otherwise
+	bool traverse(const Ray<FloatType>& r, FloatType tmin, FloatType tmax, bool onlyFrontFaces, Intersection* res) const {
+		if (m_Nodes.empty()) return false;
+
+		unsigned int localStack[64];
+		std::vector<unsigned int> heapStack;
+		unsigned int* stack = localStack;
+		if (m_MaxDepth > 64) {
+			heapStack.resize(m_MaxDepth);
+			stack = heapStack.data();
+		}
+		unsigned int stackSize = 0;
+
+		const vec3i& sign = r.getSign();
+		bool hit = false;
+		unsigned int nodeIdx = 0;
+		while (true) {
+			const LinearBVHNode<FloatType>& node = m_Nodes[nodeIdx];
+			if (node.boundingBox.intersect(r, tmin, tmax)) {
+				if (node.isLeaf()) {
+					for (unsigned int i = node.offset; i < node.offset + node.numTris; i++) {
+						const unsigned int instanceIdx = m_InstanceIndices[i];
+						const Instance& instance = m_Instances[instanceIdx];
+
+						//the object space ray direction is normalized, so object space distances are world distances scaled by the length of the transformed direction
+						const vec3<FloatType> d = instance.worldToObject.transformNormalAffine(r.getDirection());
+						const FloatType scale = d.length();
+						if (scale <= (FloatType)0) continue;
+						const Ray<FloatType> objectRay(instance.worldToObject * r.getOrigin(), d);
+
+						if (!res) {
+							if (instance.accelerator->occluded(objectRay, tmin * scale, tmax * scale, onlyFrontFaces)) return true;
+							continue;
+						}
+
+						typename TriMeshRayAccelerator<FloatType>::Intersection curr;
+						if (instance.accelerator->intersect(objectRay, curr, tmin * scale, tmax * scale, onlyFrontFaces)) {
+							static_cast<typename TriMeshRayAccelerator<FloatType>::Intersection&>(*res) = curr;
+							res->t = curr.t / scale;
+							res->instanceIndex = instanceIdx;
+							tmax = res->t;
+							hit = true;
+						}
+					}
+				} else {
+					if (sign[node.axis]) {
+						stack[stackSize++] = nodeIdx + 1;
+						nodeIdx = node.offset;
+					} else {
+						stack[stackSize++] = node.offset;
+						nodeIdx++;
+					}
+					continue;
+				}
+			}
+			if (stackSize == 0) break;
+			nodeIdx = stack[--stackSize];
+		}
+		return hit;
+	}
+
+	//! appends the subtree over m_InstanceIndices[begin, end) in depth-first order (same layout as TriMeshAcceleratorLinearBVH; numTris counts instances)
+	unsigned int buildRecursive(size_t begin, size_t end, unsigned int depth) {
+		m_MaxDepth = std::max(m_MaxDepth, depth);
+
+		const unsigned int nodeIdx = (unsigned int)m_Nodes.size();
+		m_Nodes.push_back(LinearBVHNode<FloatType>());
+
+		BoundingBox3<FloatType> bbox, centroidBox;
+		for (size_t i = begin; i < end; i++) {
+			const BoundingBox3<FloatType>& b = m_Instances[m_InstanceIndices[i]].worldBoundingBox;
+			bbox.include(b);
+			centroidBox.include(b.getCenter());
+		}
+		m_Nodes[nodeIdx].boundingBox = bbox;
+
+		if (end - begin == 1) {
+			m_Nodes[nodeIdx].offset = (unsigned int)begin;
+			m_Nodes[nodeIdx].numTris = 1;
+			m_Nodes[nodeIdx].axis = 0;
+			return nodeIdx;
+		}
+
+		const vec3<FloatType> extent = centroidBox.getExtent();
+		unsigned int axis = 0;
+		if (extent.y > extent.x) axis = 1;
+		if (extent.z > extent[axis]) axis = 2;
+
+		const size_t mid = (begin + end) / 2;
+		std::nth_element(m_InstanceIndices.begin() + begin, m_InstanceIndices.begin() + mid, m_InstanceIndices.begin() + end, [&](unsigned int a, unsigned int b) {
+			return m_Instances[a].worldBoundingBox.getCenter()[axis] < m_Instances[b].worldBoundingBox.getCenter()[axis];
+		});
+
+		m_Nodes[nodeIdx].numTris = 0;
+		m_Nodes[nodeIdx].axis = (unsigned short)axis;
+		buildRecursive(begin, mid, depth + 1);
+		const unsigned int rightIdx = buildRecursive(mid, end, depth + 1);
+		m_Nodes[nodeIdx].offset = rightIdx;
+		return nodeIdx;
+	}
+
+	//! private data
+	std::vector<Instance>					m_Instances;
+	std::vector<LinearBVHNode<FloatType>>	m_Nodes;
+	std::vector<unsigned int>				m_InstanceIndices;	//! instances in leaf order
+	unsigned int							m_MaxDepth;
+};
+
+typedef TriMeshInstanceAccelerator<float>	TriMeshInstanceAcceleratorf;
+typedef TriMeshInstanceAccelerator<double>	TriMeshInstanceAcceleratord;
+
+} // namespace ml
+
+#endif
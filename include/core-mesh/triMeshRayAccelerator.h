@@ -51,6 +51,22 @@ public:
 		const typename TriMesh<FloatType>::Triangle* triangle;
     };
 
+	//! traversal counters; accumulated over all rays passed to an accelerator's counting intersect (divide by the number of rays for per-ray averages)
+	struct TraversalStats
+	{
+		TraversalStats() {
+			reset();
+		}
+
+		void reset() {
+			numNodeTests = 0;
+			numTriangleTests = 0;
+		}
+
+		size_t numNodeTests;		//! number of ray-box tests
+		size_t numTriangleTests;	//! number of ray-triangle tests
+	};
+
 
 	const typename TriMesh<FloatType>::Triangle* intersect(const Ray<FloatType>& r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
 		return intersectInternal(r, t, u, v, tmin, tmax, onlyFrontFaces);
@@ -67,6 +83,24 @@ public:
 		return i;
 	}
 
+	//! any-hit query (shadow and visibility rays): returns true if any triangle is hit within [tmin, tmax]; stops at the first hit found
+	bool occluded(const Ray<FloatType>& r, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		return occludedInternal(r, tmin, tmax, onlyFrontFaces);
+	}
+
+	//! intersects a batch of rays (e.g., one per pixel); results[i] belongs to rays[i]. Coherent rays should be adjacent in the array
+	void intersect(const std::vector<Ray<FloatType>>& rays, std::vector<Intersection>& results, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		results.resize(rays.size());
+		if (rays.empty()) return;
+		intersectBatchInternal(rays.data(), results.data(), rays.size(), tmin, tmax, onlyFrontFaces);
+	}
+
+	std::vector<Intersection> intersect(const std::vector<Ray<FloatType>>& rays, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const {
+		std::vector<Intersection> results;
+		intersect(rays, results, tmin, tmax, onlyFrontFaces);
+		return results;
+	}
+
 
 	template<class Accelerator>
 	static Intersection getFirstIntersection(
@@ -97,7 +131,7 @@ public:
 
     //
     // ml::mat4f is the inverse of the "accelerator to world" matrix!
-    // TODO: this returns the closest interesction, but the "t" parameter is broken because it is in the space of the transformed object, not the original world-space ray.
+    // the returned t is in world space; for many instances use TriMeshInstanceAccelerator, which avoids the linear loop over all objects
     //
     template<class Accelerator>
     static Intersection getFirstIntersectionTransform(
@@ -109,17 +143,17 @@ public:
 
         UINT curObjectIndex = 0;
         intersect.t = std::numeric_limits<float>::max();
-        float bestDistSqToOrigin = std::numeric_limits<float>::max();
 
         for (const auto &accelerator : invTransformedAccelerators)
         {
+            //the transformed ray is renormalized, so object space distances are world distances scaled by the length of the transformed direction
+            const float scale = accelerator.second.transformNormalAffine(ray.getDirection()).length();
             Intersection curIntersection;
-            if (accelerator.first->intersect(accelerator.second * ray, curIntersection))
+            if (scale > 0.0f && accelerator.first->intersect(accelerator.second * ray, curIntersection, 0.0f, intersect.t * scale))
             {
-                float curDistSqToOrigin = (float)distSq(accelerator.second.getInverse() * curIntersection.getSurfacePosition(), ray.getOrigin());
-                if (curDistSqToOrigin < bestDistSqToOrigin)
+                curIntersection.t /= scale;
+                if (curIntersection.t < intersect.t)
                 {
-                    bestDistSqToOrigin = curDistSqToOrigin;
                     intersect = curIntersection;
                     objectIndex = curObjectIndex;
                 }
@@ -160,6 +194,19 @@ private:
 
 	virtual const typename TriMesh<FloatType>::Triangle* intersectInternal(const Ray<FloatType>& r, FloatType& t, FloatType& u, FloatType& v, FloatType tmin = (FloatType)0, FloatType tmax = std::numeric_limits<FloatType>::max(), bool onlyFrontFaces = false) const = 0;
 
+	virtual bool occludedInternal(const Ray<FloatType>& r, FloatType tmin, FloatType tmax, bool onlyFrontFaces) const = 0;
+
+	//! traces rays one by one; accelerators with a packet traversal override this
+	virtual void intersectBatchInternal(const Ray<FloatType>* rays, Intersection* results, size_t numRays, FloatType tmin, FloatType tmax, bool onlyFrontFaces) const {
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < (int)numRays; i++) {
+			Intersection& res = results[i];
+			res.triangle = intersectInternal(rays[i], res.t, res.u, res.v, tmin, tmax, onlyFrontFaces);
+		}
+	}
+
 };
 
 typedef TriMeshRayAccelerator<float> TriMeshRayAcceleratorf;
@@ -0,0 +1,152 @@
+#ifndef CORE_MULTITHREADING_LOCKFREEQUEUE_H_
+#define CORE_MULTITHREADING_LOCKFREEQUEUE_H_
+
+namespace ml
+{
+
+//
+// bounded multi-producer/multi-consumer queue without locks (D. Vyukov's ring buffer): each cell carries a sequence number
+// that tells producers and consumers whether it is free or filled for the current lap, so pushes and pops only contend on
+// a single compare-and-swap of the enqueue or dequeue position; batches claim several consecutive cells with one CAS.
+// Elements are stored by value, so small tasks do not need to be heap-allocated.
+//
+template <class T> class LockFreeQueue
+{
+public:
+	//! capacity is rounded up to a power of two
+	explicit LockFreeQueue(size_t capacity = 1024)
+	{
+		size_t size = 2;
+		while(size < capacity) size *= 2;
+		m_mask = size - 1;
+		m_cells.reset(new Cell[size]);
+		for(size_t i = 0; i < size; i++)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		m_enqueuePos.store(0, std::memory_order_relaxed);
+		m_dequeuePos.store(0, std::memory_order_relaxed);
+	}
+
+	//! returns false if the queue is full
+	bool tryPush(const T &value)
+	{
+		return tryPushBatch(&value, 1) == 1;
+	}
+
+	//! returns false if the queue is empty
+	bool tryPop(T &value)
+	{
+		return tryPopBatch(&value, 1) == 1;
+	}
+
+	//! pushes the first values (as many as fit, at most count) in order; returns the number of pushed values
+	size_t tryPushBatch(const T *values, size_t count)
+	{
+		count = std::min(count, capacity());
+		if(count == 0) return 0;
+		size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+		while(true)
+		{
+			const size_t n = countCells(pos, count, 0);
+			if(n == 0)
+			{
+				//either full, or another producer has claimed pos already
+				if(cellLag(pos, 0) < 0) return 0;
+				pos = m_enqueuePos.load(std::memory_order_relaxed);
+				continue;
+			}
+			if(m_enqueuePos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+			{
+				for(size_t i = 0; i < n; i++)
+				{
+					Cell &cell = m_cells[(pos + i) & m_mask];
+					cell.data = values[i];
+					cell.sequence.store(pos + i + 1, std::memory_order_release);
+				}
+				return n;
+			}
+		}
+	}
+
+	//! pops up to maxCount values in order with a single claim; returns the number of popped values
+	size_t tryPopBatch(T *values, size_t maxCount)
+	{
+		maxCount = std::min(maxCount, capacity());
+		if(maxCount == 0) return 0;
+		size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+		while(true)
+		{
+			const size_t n = countCells(pos, maxCount, 1);
+			if(n == 0)
+			{
+				//either empty, or another consumer has claimed pos already
+				if(cellLag(pos, 1) < 0) return 0;
+				pos = m_dequeuePos.load(std::memory_order_relaxed);
+				continue;
+			}
+			if(m_dequeuePos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+			{
+				for(size_t i = 0; i < n; i++)
+				{
+					Cell &cell = m_cells[(pos + i) & m_mask];
+					values[i] = std::move(cell.data);
+					cell.sequence.store(pos + i + m_mask + 1, std::memory_order_release);
+				}
+				return n;
+			}
+		}
+	}
+
+	//! number of queued values; only a snapshot while other threads push or pop
+	size_t sizeApprox() const
+	{
+		const size_t dequeuePos = m_dequeuePos.load(std::memory_order_relaxed);
+		const size_t enqueuePos = m_enqueuePos.load(std::memory_order_relaxed);
+		return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+	}
+
+	bool empty() const
+	{
+		return sizeApprox() == 0;
+	}
+
+	size_t capacity() const
+	{
+		return m_mask + 1;
+	}
+
+private:
+	struct Cell
+	{
+		std::atomic<size_t> sequence;	//! pos for a free cell, pos + 1 for a filled one (pos of the current lap)
+		T data;
+	};
+
+	//! difference between a cell's sequence and the one expected for pos (offset 0 to push, 1 to pop): zero if the cell is ready,
+	//! negative if the queue is full (push) or empty (pop), positive if another thread has claimed pos already
+	std::ptrdiff_t cellLag(size_t pos, size_t offset) const
+	{
+		const size_t sequence = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+		return (std::ptrdiff_t)(sequence - (pos + offset));
+	}
+
+	//! number of consecutive ready cells starting at pos (at most maxCount)
+	size_t countCells(size_t pos, size_t maxCount, size_t offset) const
+	{
+		size_t n = 0;
+		while(n < maxCount && cellLag(pos + n, offset) == 0) n++;
+		return n;
+	}
+
+	//! the positions are kept on separate cache lines, so producers and consumers do not invalidate each other's line
+	std::unique_ptr<Cell[]> m_cells;
+	size_t m_mask;
+	char m_padding0[64];
+	std::atomic<size_t> m_enqueuePos;
+	char m_padding1[64];
+	std::atomic<size_t> m_dequeuePos;
+	char m_padding2[64];
+};
+
+}  // namespace ml
+
+#endif  // CORE_MULTITHREADING_LOCKFREEQUEUE_H_
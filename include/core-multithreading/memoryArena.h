@@ -0,0 +1,112 @@
+#ifndef CORE_MULTITHREADING_MEMORYARENA_H_
+#define CORE_MULTITHREADING_MEMORYARENA_H_
+
+namespace ml
+{
+
+//
+// bump allocator for scratch memory of a single thread: allocations are only released all at once by reset (which keeps the
+// blocks for reuse) or release. Blocks are allocated on the arena's NUMA node; not thread-safe.
+//
+class MemoryArena
+{
+public:
+	//! node -1: no preference (the memory is placed by the operating system)
+	explicit MemoryArena(int node = -1, size_t blockSize = 1 << 20)
+	{
+		m_node = node;
+		m_blockSize = blockSize;
+		m_currentBlock = 0;
+		m_offset = 0;
+	}
+	~MemoryArena()
+	{
+		release();
+	}
+
+	//! returns uninitialized memory with the given alignment (a power of two)
+	void* allocate(size_t size, size_t alignment = 16)
+	{
+		while(m_currentBlock < m_blocks.size())
+		{
+			Block &block = m_blocks[m_currentBlock];
+			const size_t offset = alignOffset(block.data, m_offset, alignment);
+			if(offset + size <= block.size)
+			{
+				m_offset = offset + size;
+				return block.data + offset;
+			}
+			m_currentBlock++;
+			m_offset = 0;
+		}
+
+		Block block;
+		block.size = std::max(m_blockSize, size + alignment);
+		block.data = (char*)CpuTopology::allocateOnNode(block.size, m_node);
+		if(block.data == nullptr) throw MLIB_EXCEPTION("out of memory");
+		m_blocks.push_back(block);
+		m_currentBlock = m_blocks.size() - 1;
+		m_offset = alignOffset(block.data, 0, alignment) + size;
+		return block.data + m_offset - size;
+	}
+
+	//! uninitialized array of count elements
+	template<class T>
+	T* allocateArray(size_t count)
+	{
+		return (T*)allocate(count * sizeof(T), std::max(std::alignment_of<T>::value, (size_t)16));
+	}
+
+	//! makes all memory available again (previous allocations become invalid); the blocks are kept
+	void reset()
+	{
+		m_currentBlock = 0;
+		m_offset = 0;
+	}
+
+	//! frees all blocks
+	void release()
+	{
+		for(const Block &block : m_blocks)
+			CpuTopology::freeOnNode(block.data);
+		m_blocks.clear();
+		reset();
+	}
+
+	//! total size of the allocated blocks
+	size_t getCapacity() const
+	{
+		size_t capacity = 0;
+		for(const Block &block : m_blocks)
+			capacity += block.size;
+		return capacity;
+	}
+
+	int getNode() const
+	{
+		return m_node;
+	}
+
+private:
+	struct Block
+	{
+		char *data;
+		size_t size;
+	};
+
+	static size_t alignOffset(const char *data, size_t offset, size_t alignment)
+	{
+		const size_t address = (size_t)(data + offset);
+		return offset + ((alignment - address % alignment) % alignment);
+	}
+
+	int m_node;
+	size_t m_blockSize;
+	std::vector<Block> m_blocks;
+	size_t m_currentBlock;	//! block of the next allocation
+	size_t m_offset;		//! first free byte in the current block
+};
+
+}  // namespace ml
+
+#endif  // CORE_MULTITHREADING_MEMORYARENA_H_
@@ -0,0 +1,348 @@
+#ifndef CORE_MULTITHREADING_PARALLELALGORITHMS_H_
+#define CORE_MULTITHREADING_PARALLELALGORITHMS_H_
+
+namespace ml
+{
+
+//
+// parallel primitives on arrays (and std::vector) that run on a ThreadPool (by default the shared one).
+// The input is split into blocks of a fixed size that does not depend on the number of threads, and partial
+// results are combined in block order, so results are identical for every thread count (also for floating point sums).
+//
+namespace parallel
+{
+
+//! number of elements per block; the blocks (and thus the rounding of floating point reductions) only depend on this
+const size_t BlockSize = 1 << 14;
+
+inline size_t getBlockCount(size_t n)
+{
+	return (n + BlockSize - 1) / BlockSize;
+}
+
+//! calls f(block, begin, end) for all blocks of [0, n) in parallel
+template<class F>
+void forEachBlock(size_t n, ThreadPool &pool, const F &f)
+{
+	pool.parallelFor(0, getBlockCount(n), 1, [&](size_t block)
+	{
+		const size_t begin = block * BlockSize;
+		f(block, begin, std::min(n, begin + BlockSize));
+	});
+}
+
+//! init op data[0] op ... op data[n - 1]; op must be associative (it is applied in a fixed order, but with a different bracketing than a serial loop)
+template<class T, class Op>
+T reduce(const T *data, size_t n, T init, Op op, ThreadPool &pool = ThreadPool::getShared())
+{
+	std::vector<T> partials(getBlockCount(n));
+	forEachBlock(n, pool, [&](size_t block, size_t begin, size_t end)
+	{
+		T partial = data[begin];
+		for(size_t i = begin + 1; i < end; i++)
+			partial = op(partial, data[i]);
+		partials[block] = partial;
+	});
+
+	T result = init;
+	for(const T &partial : partials)
+		result = op(result, partial);
+	return result;
+}
+
+template<class T>
+T reduce(const T *data, size_t n, T init = T(0), ThreadPool &pool = ThreadPool::getShared())
+{
+	return reduce(data, n, init, std::plus<T>(), pool);
+}
+
+template<class T, class Op>
+T reduce(const std::vector<T> &data, T init, Op op, ThreadPool &pool = ThreadPool::getShared())
+{
+	return reduce(data.data(), data.size(), init, op, pool);
+}
+
+template<class T>
+T reduce(const std::vector<T> &data, T init = T(0), ThreadPool &pool = ThreadPool::getShared())
+{
+	return reduce(data.data(), data.size(), init, std::plus<T>(), pool);
+}
+
+//! out[i] = init op in[0] op ... op in[i - 1]; in and out may be the same array; returns the total (init op all elements)
+template<class T, class Op>
+T exclusiveScan(const T *in, T *out, size_t n, T init, Op op, ThreadPool &pool = ThreadPool::getShared())
+{
+	const size_t blockCount = getBlockCount(n);
+	std::vector<T> blockSums(blockCount);
+	forEachBlock(n, pool, [&](size_t block, size_t begin, size_t end)
+	{
+		T sum = in[begin];
+		for(size_t i = begin + 1; i < end; i++)
+			sum = op(sum, in[i]);
+		blockSums[block] = sum;
+	});
+
+	std::vector<T> blockOffsets(blockCount);
+	T total = init;
+	for(size_t block = 0; block < blockCount; block++)
+	{
+		blockOffsets[block] = total;
+		total = op(total, blockSums[block]);
+	}
+
+	forEachBlock(n, pool, [&](size_t block, size_t begin, size_t end)
+	{
+		T sum = blockOffsets[block];
+		for(size_t i = begin; i < end; i++)
+		{
+			const T value = in[i];
+			out[i] = sum;
+			sum = op(sum, value);
+		}
+	});
+	return total;
+}
+
+template<class T>
+T exclusiveScan(const T *in, T *out, size_t n, T init = T(0), ThreadPool &pool = ThreadPool::getShared())
+{
+	return exclusiveScan(in, out, n, init, std::plus<T>(), pool);
+}
+
+template<class T>
+T exclusiveScan(const std::vector<T> &in, std::vector<T> &out, T init = T(0), ThreadPool &pool = ThreadPool::getShared())
+{
+	out.resize(in.size());
+	return exclusiveScan(in.data(), out.data(), in.size(), init, std::plus<T>(), pool);
+}
+
+template<class T, class Op>
+T exclusiveScan(const std::vector<T> &in, std::vector<T> &out, T init, Op op, ThreadPool &pool = ThreadPool::getShared())
+{
+	out.resize(in.size());
+	return exclusiveScan(in.data(), out.data(), in.size(), init, op, pool);
+}
+
+//! stable partition: moves the elements for which pred is true to the front, keeping the relative order in both parts; returns the number of those elements
+template<class T, class Pred>
+size_t partition(T *data, size_t n, Pred pred, ThreadPool &pool = ThreadPool::getShared())
+{
+	const size_t blockCount = getBlockCount(n);
+	std::vector<unsigned char> flags(n);
+	std::vector<size_t> trueCounts(blockCount);
+	forEachBlock(n, pool, [&](size_t block, size_t begin, size_t end)
+	{
+		size_t count = 0;
+		for(size_t i = begin; i < end; i++)
+		{
+			flags[i] = pred(data[i]) ? 1 : 0;
+			count += flags[i];
+		}
+		trueCounts[block] = count;
+	});
+
+	std::vector<size_t> trueOffsets(blockCount), falseOffsets(blockCount);
+	size_t trueTotal = 0;
+	for(size_t block = 0; block < blockCount; block++)
+	{
+		trueOffsets[block] = trueTotal;
+		trueTotal += trueCounts[block];
+	}
+	size_t falseTotal = trueTotal;
+	for(size_t block = 0; block < blockCount; block++)
+	{
+		falseOffsets[block] = falseTotal;
+		falseTotal += std::min(n, (block + 1) * BlockSize) - block * BlockSize - trueCounts[block];
+	}
+
+	std::vector<T> partitioned(n);
+	forEachBlock(n, pool, [&](size_t block, size_t begin, size_t end)
+	{
+		size_t trueOffset = trueOffsets[block], falseOffset = falseOffsets[block];
+		for(size_t i = begin; i < end; i++)
+			partitioned[flags[i] ? trueOffset++ : falseOffset++] = std::move(data[i]);
+	});
+	forEachBlock(n, pool, [&](size_t, size_t begin, size_t end)
+	{
+		std::move(partitioned.begin() + begin, partitioned.begin() + end, data + begin);
+	});
+	return trueTotal;
+}
+
+template<class T, class Pred>
+size_t partition(std::vector<T> &data, Pred pred, ThreadPool &pool = ThreadPool::getShared())
+{
+	return partition(data.data(), data.size(), pred, pool);
+}
+
+//! counts how many elements fall into each of the binCount bins; bin(element) must return a bin index smaller than binCount
+template<class T, class BinFunction>
+std::vector<size_t> histogram(const T *data, size_t n, size_t binCount, BinFunction bin, ThreadPool &pool = ThreadPool::getShared())
+{
+	//counts are integers, so the partial histograms can be per chunk of blocks (which saves memory for many bins)
+	const size_t blockCount = getBlockCount(n);
+	const size_t chunkCount = std::min(blockCount, (size_t)pool.getThreadCount() * 4 + 1);
+	std::vector<std::vector<size_t>> partials(chunkCount);
+	pool.parallelFor(0, chunkCount, 1, [&](size_t chunk)
+	{
+		std::vector<size_t> &counts = partials[chunk];
+		counts.resize(binCount, 0);
+		const size_t begin = chunk * blockCount / chunkCount * BlockSize;
+		const size_t end = std::min(n, (chunk + 1) * blockCount / chunkCount * BlockSize);
+		for(size_t i = begin; i < end; i++)
+		{
+			const size_t index = (size_t)bin(data[i]);
+			MLIB_ASSERT_STR(index < binCount, "bin index out of range");
+			counts[index]++;
+		}
+	});
+
+	std::vector<size_t> result(binCount, 0);
+	for(const std::vector<size_t> &counts : partials)
+		for(size_t i = 0; i < binCount; i++)
+			result[i] += counts[i];
+	return result;
+}
+
+template<class T, class BinFunction>
+std::vector<size_t> histogram(const std::vector<T> &data, size_t binCount, BinFunction bin, ThreadPool &pool = ThreadPool::getShared())
+{
+	return histogram(data.data(), data.size(), binCount, bin, pool);
+}
+
+//
+// maps radix sort keys to unsigned integers of the same size with the same order
+//
+template<class K, class Enable = void> struct RadixKey;
+
+template<class K> struct RadixKey<K, typename std::enable_if<std::is_integral<K>::value && std::is_unsigned<K>::value>::type>
+{
+	typedef K Bits;
+	static Bits toBits(K key) { return key; }
+	static K fromBits(Bits bits) { return bits; }
+};
+
+//! flips the sign bit, so negative values come first
+template<class K> struct RadixKey<K, typename std::enable_if<std::is_integral<K>::value && std::is_signed<K>::value>::type>
+{
+	typedef typename std::make_unsigned<K>::type Bits;
+	static const Bits SignBit = (Bits)1 << (8 * sizeof(K) - 1);
+	static Bits toBits(K key) { return (Bits)key ^ SignBit; }
+	static K fromBits(Bits bits) { return (K)(bits ^ SignBit); }
+};
+
+//! IEEE floats: flips all bits of negative values and the sign bit of positive ones; -0 comes before +0, NaNs with the sign bit set come first, the others last
+template<class K> struct RadixKey<K, typename std::enable_if<std::is_floating_point<K>::value>::type>
+{
+	static_assert(sizeof(K) == 4 || sizeof(K) == 8, "only 32 and 64 bit floating point keys are supported");
+	typedef typename std::conditional<sizeof(K) == 4, UINT32, UINT64>::type Bits;
+	static const Bits SignBit = (Bits)1 << (8 * sizeof(K) - 1);
+	static Bits toBits(K key)
+	{
+		Bits bits;
+		memcpy(&bits, &key, sizeof(K));
+		return (bits & SignBit) ? ~bits : (bits | SignBit);
+	}
+	static K fromBits(Bits bits)
+	{
+		bits = (bits & SignBit) ? (bits ^ SignBit) : ~bits;
+		K key;
+		memcpy(&key, &bits, sizeof(K));
+		return key;
+	}
+};
+
+//! stable LSD radix sort on 8 bit digits of RadixKey<K>::Bits; values (if not null) are permuted along with the keys.
+//! Passes in which all keys have the same digit are skipped.
+template<class K, class V>
+void radixSort(K *keys, V *values, size_t n, ThreadPool &pool = ThreadPool::getShared())
+{
+	typedef RadixKey<K> Key;
+	typedef typename Key::Bits Bits;
+	const size_t blockCount = getBlockCount(n);
+
+	std::vector<Bits> bits(n), bitsTemp(n);
+	std::vector<V> valuesTemp(values ? n : 0);
+	forEachBlock(n, pool, [&](size_t, size_t begin, size_t end)
+	{
+		for(size_t i = begin; i < end; i++)
+			bits[i] = Key::toBits(keys[i]);
+	});
+
+	Bits *source = bits.data(), *target = bitsTemp.data();
+	V *sourceValues = values, *targetValues = valuesTemp.data();
+	std::vector<size_t> offsets(blockCount * 256);
+	for(size_t shift = 0; shift < 8 * sizeof(Bits); shift += 8)
+	{
+		forEachBlock(n, pool, [&](size_t block, size_t begin, size_t end)
+		{
+			size_t *counts = &offsets[block * 256];
+			std::fill(counts, counts + 256, (size_t)0);
+			for(size_t i = begin; i < end; i++)
+				counts[(source[i] >> shift) & 0xff]++;
+		});
+
+		//digit-major, block-minor offsets keep equal digits in input order
+		size_t offset = 0;
+		bool trivial = false;
+		for(size_t digit = 0; digit < 256; digit++)
+		{
+			const size_t digitBegin = offset;
+			for(size_t block = 0; block < blockCount; block++)
+			{
+				const size_t count = offsets[block * 256 + digit];
+				offsets[block * 256 + digit] = offset;
+				offset += count;
+			}
+			if(offset - digitBegin == n) trivial = true;
+		}
+		if(trivial) continue;
+
+		forEachBlock(n, pool, [&](size_t block, size_t begin, size_t end)
+		{
+			size_t *blockOffsets = &offsets[block * 256];
+			for(size_t i = begin; i < end; i++)
+			{
+				const size_t position = blockOffsets[(source[i] >> shift) & 0xff]++;
+				target[position] = source[i];
+				if(sourceValues) targetValues[position] = std::move(sourceValues[i]);
+			}
+		});
+		std::swap(source, target);
+		std::swap(sourceValues, targetValues);
+	}
+
+	forEachBlock(n, pool, [&](size_t, size_t begin, size_t end)
+	{
+		for(size_t i = begin; i < end; i++)
+			keys[i] = Key::fromBits(source[i]);
+		if(sourceValues && sourceValues != values)
+			std::move(sourceValues + begin, sourceValues + end, values + begin);
+	});
+}
+
+template<class K>
+void radixSort(K *keys, size_t n, ThreadPool &pool = ThreadPool::getShared())
+{
+	radixSort(keys, (char*)nullptr, n, pool);
+}
+
+template<class K>
+void radixSort(std::vector<K> &keys, ThreadPool &pool = ThreadPool::getShared())
+{
+	radixSort(keys.data(), (char*)nullptr, keys.size(), pool);
+}
+
+//! sorts keys and permutes values along with them
+template<class K, class V>
+void radixSort(std::vector<K> &keys, std::vector<V> &values, ThreadPool &pool = ThreadPool::getShared())
+{
+	MLIB_ASSERT_STR(keys.size() == values.size(), "one value per key required");
+	radixSort(keys.data(), values.data(), keys.size(), pool);
+}
+
+}  // namespace parallel
+
+}  // namespace ml
+
+#endif  // CORE_MULTITHREADING_PARALLELALGORITHMS_H_
@@ -46,6 +46,18 @@ public:
         return true;
     }
 
+    //! claims up to maxCount tasks with a single lock; returns false if there were no tasks left
+    bool getNextTasks(std::vector<T> &nextTasks, size_t maxCount)
+    {
+        nextTasks.clear();
+        m_mutex.lock();
+        const size_t count = std::min(maxCount, m_tasks.size());
+        nextTasks.assign(m_tasks.end() - count, m_tasks.end());
+        m_tasks.resize(m_tasks.size() - count);
+        m_mutex.unlock();
+        return count > 0;
+    }
+
 private:
     std::mutex m_mutex;
     std::vector<T> m_tasks;
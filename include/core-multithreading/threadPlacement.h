@@ -0,0 +1,57 @@
+#ifndef CORE_MULTITHREADING_THREADPLACEMENT_H_
+#define CORE_MULTITHREADING_THREADPLACEMENT_H_
+
+namespace ml
+{
+
+//
+// where the threads of a ThreadPool may run; threads are spread round robin over the NUMA nodes
+//
+enum ThreadPlacement
+{
+	PLACEMENT_FREE,		//! the operating system may move threads to any processor (default)
+	PLACEMENT_NODE,		//! thread i may run on all processors of NUMA node i % nodeCount
+	PLACEMENT_CORE,		//! thread i is pinned to a single processor (the processors of each node are used in order)
+};
+
+//
+// logical processors grouped by NUMA node; a single node with all processors if the topology cannot be queried
+//
+class CpuTopology
+{
+public:
+	//! topology of this machine (queried once)
+	static const CpuTopology& get();
+
+	UINT getNodeCount() const
+	{
+		return (UINT)m_nodes.size();
+	}
+	const std::vector<UINT>& getNodeProcessors(UINT node) const
+	{
+		return m_nodes[node];
+	}
+	UINT getProcessorCount() const;
+
+	//! node on which thread threadIndex of a pool runs (0 for PLACEMENT_FREE)
+	UINT getThreadNode(UINT threadIndex, ThreadPlacement placement) const;
+	//! processors on which thread threadIndex of a pool may run (empty for PLACEMENT_FREE)
+	std::vector<UINT> getThreadProcessors(UINT threadIndex, ThreadPlacement placement) const;
+
+	//! restricts the calling thread to the given processors; returns false if this is not supported or fails
+	static bool setCurrentThreadAffinity(const std::vector<UINT> &processors);
+
+	//! allocates memory on a NUMA node (node -1: no preference); on Linux the pages are placed on the node of the first thread
+	//! touching them, so call this from a thread running on the node
+	static void* allocateOnNode(size_t size, int node);
+	static void freeOnNode(void *data);
+
+private:
+	CpuTopology();
+
+	std::vector<std::vector<UINT>> m_nodes;	//! processor indices of each node
+};
+
+}  // namespace ml
+
+#endif  // CORE_MULTITHREADING_THREADPLACEMENT_H_
@@ -4,17 +4,140 @@
 namespace ml
 {
 
+//
+// persistent pool of worker threads with work stealing; idle workers sleep until jobs are queued.
+// Waiting inside a job (e.g., a nested parallelFor) runs other jobs instead of blocking the worker.
+//
 class ThreadPool
 {
 public:
-	~ThreadPool() {}
+	ThreadPool();
+	explicit ThreadPool(UINT threadCount, ThreadPlacement placement = PLACEMENT_FREE);
+	~ThreadPool();
 
-    void init(UINT threadCount);
-    void init(UINT threadCount, const std::vector<ThreadLocalStorage*> &threadLocalStorage);
+	//! starts threadCount persistent threads (0: one per hardware thread); threads of a previous init are stopped first.
+	//! Workers without thread local storage get a plain ThreadLocalStorage, so every job can use the worker's arena.
+    void init(UINT threadCount, ThreadPlacement placement = PLACEMENT_FREE);
+    void init(UINT threadCount, const std::vector<ThreadLocalStorage*> &threadLocalStorage, ThreadPlacement placement = PLACEMENT_FREE);
+
+	UINT getThreadCount() const
+	{
+		return (UINT)m_threads.size();
+	}
+	ThreadPlacement getPlacement() const
+	{
+		return m_placement;
+	}
+	//! NUMA node of a worker thread (-1 for PLACEMENT_FREE)
+	int getThreadNode(UINT threadIndex) const
+	{
+		return m_threads[threadIndex]->getNode();
+	}
+
+	//! pool with one thread per hardware thread, started on first use and shared by the parallel algorithms
+	static ThreadPool& getShared();
+
+	//! runs (and deletes) all tasks of the list; blocks until they are done
     void runTasks(TaskList<WorkerThreadTask*> &tasks, bool useConsole = true);
 
+	//! queues f; the future returns its result (or rethrows its exception); runs f immediately if the pool has no threads.
+	//! jobs must not block on futures of other jobs (use parallelFor for nested parallelism)
+	template<class F>
+	std::future<typename std::result_of<F()>::type> submit(F f)
+	{
+		typedef typename std::result_of<F()>::type ResultType;
+		std::shared_ptr<std::packaged_task<ResultType()>> task(new std::packaged_task<ResultType()>(f));
+		std::future<ResultType> result = task->get_future();
+		if(m_threads.empty())
+		{
+			(*task)();
+			return result;
+		}
+
+		WorkerThreadJob job;
+		job.run = [task](UINT, ThreadLocalStorage*) { (*task)(); };
+		job.pending = nullptr;
+		enqueue(job);
+		return result;
+	}
+
+	//! calls fn(i) for all i in [begin, end); chunks of grain indices are claimed by the workers and the calling thread; blocks until all are done.
+	//! If fn throws, no further chunks are started and the first exception is rethrown on the calling thread once the running chunks are done
+	template<class F>
+	void parallelFor(size_t begin, size_t end, size_t grain, const F &fn)
+	{
+		if(begin >= end) return;
+		grain = std::max(grain, (size_t)1);
+		const size_t chunkCount = (end - begin - 1) / grain + 1;
+
+		std::atomic<size_t> nextChunk(0);
+		std::exception_ptr error;
+		std::mutex errorMutex;
+		auto runChunks = [&]()
+		{
+			size_t chunk;
+			while((chunk = nextChunk++) < chunkCount)
+			{
+				const size_t chunkBegin = begin + chunk * grain;
+				const size_t chunkEnd = std::min(end, chunkBegin + grain);
+				try
+				{
+					for(size_t i = chunkBegin; i < chunkEnd; i++)
+						fn(i);
+				}
+				catch(...)
+				{
+					std::lock_guard<std::mutex> lock(errorMutex);
+					if(!error) error = std::current_exception();
+					nextChunk = chunkCount;
+				}
+			}
+		};
+
+		//helpers that start after all chunks were claimed return immediately
+		std::atomic<size_t> pending(0);
+		const size_t helperCount = std::min(chunkCount - 1, m_threads.size());
+		for(size_t helper = 0; helper < helperCount; helper++)
+		{
+			WorkerThreadJob job;
+			job.run = [&runChunks](UINT, ThreadLocalStorage*) { runChunks(); };
+			job.pending = &pending;
+			pending++;
+			enqueue(job);
+		}
+		runChunks();
+		wait(pending);
+		if(error) std::rethrow_exception(error);
+	}
+
 private:
-    std::vector<WorkerThread> m_threads;
+	friend class WorkerThread;
+
+	void stop();
+	void workerLoop(WorkerThread &worker);
+
+	//! queues a job on the calling worker's deque, or round robin if called from another thread
+	void enqueue(const WorkerThreadJob &job);
+	bool getJob(UINT workerIndex, WorkerThreadJob &job);
+	void runJob(const WorkerThreadJob &job, UINT threadIndex, ThreadLocalStorage *storage);
+
+	//! returns once pending is zero; workers run other jobs in the meantime, other threads block
+	void wait(std::atomic<size_t> &pending);
+
+	//! index of the calling thread in m_threads, or -1 if it is not a worker of this pool
+	int getCurrentWorker() const;
+
+    std::vector<std::unique_ptr<WorkerThread>> m_threads;
+	std::vector<std::unique_ptr<ThreadLocalStorage>> m_defaultStorage;	//! for workers that were not given storage
+	ThreadPlacement m_placement;
+	std::atomic<size_t> m_queuedJobs;
+	std::atomic<UINT> m_nextThread;
+
+	bool m_stop;	//! guarded by m_workMutex
+	std::mutex m_workMutex;
+	std::condition_variable m_workCondition;	//! signaled when jobs are queued or the pool stops
+	std::mutex m_doneMutex;
+	std::condition_variable m_doneCondition;	//! signaled when a pending counter drops to zero
 };
 
 }  // namespace ml
@@ -4,13 +4,29 @@
 namespace ml
 {
 
+class ThreadPool;
+
 //
 // abstract base class for thread local storage
 //
 class ThreadLocalStorage
 {
 public:
+	ThreadLocalStorage()
+	{
+		m_arena = nullptr;
+	}
+
+	//! scratch memory of the worker thread that uses this storage, allocated on the worker's NUMA node; null if the storage was
+	//! never given to a ThreadPool, and invalid once that pool is stopped
+	MemoryArena* getArena() const
+	{
+		return m_arena;
+	}
 
+private:
+	friend class WorkerThread;
+	MemoryArena *m_arena;
 };
 
 //
@@ -23,37 +39,72 @@ public:
     virtual void run(UINT threadIndex, ThreadLocalStorage *threadLocalStorage) = 0;
 };
 
+//
+// unit of work in a worker's deque; pending (if not null) is decremented once run has returned
+//
+struct WorkerThreadJob
+{
+	std::function<void(UINT threadIndex, ThreadLocalStorage *storage)> run;
+	std::atomic<size_t> *pending;
+};
+
+//
+// persistent thread of a ThreadPool with its own deque of jobs: the thread pops its newest jobs from the back, idle threads steal the oldest from the front
+//
 class WorkerThread
 {
 public:
 	WorkerThread()
 	{
-		m_thread = nullptr;
+		m_pool = nullptr;
+		m_threadIndex = 0;
+		m_storage = nullptr;
+		m_node = -1;
 	}
 	~WorkerThread()
 	{
-		//SAFE_DELETE(m_thread);
+		join();
 	}
 
-    void init(UINT threadIndex, ThreadLocalStorage *storage);
-    void processTasks(TaskList<WorkerThreadTask*> &tasks);
+	//! the thread restricts itself to processors (if not empty) before it runs jobs; its arena allocates on node (-1: no preference)
+    void init(UINT threadIndex, ThreadLocalStorage *storage, ThreadPool *pool, const std::vector<UINT> &processors = std::vector<UINT>(), int node = -1);
+	void join();
+
+	void push(const WorkerThreadJob &job);
+	bool popBack(WorkerThreadJob &job);
+	bool stealFront(WorkerThreadJob &job);
 
-    bool done()
-    {
-        return m_done;
-    }
+	UINT getThreadIndex() const
+	{
+		return m_threadIndex;
+	}
+	ThreadLocalStorage* getStorage() const
+	{
+		return m_storage;
+	}
+	std::thread::id getThreadId() const
+	{
+		return m_thread.get_id();
+	}
+	int getNode() const
+	{
+		return m_node;
+	}
 
 private:
 	static void workerThreadEntry( WorkerThread *context );
-	void enterThreadTaskLoop();
 
-    bool m_done;
-    std::thread *m_thread;
+    std::thread m_thread;
+	ThreadPool *m_pool;
 
 	UINT m_threadIndex;
     ThreadLocalStorage *m_storage;
+	std::vector<UINT> m_processors;
+	int m_node;
+	std::unique_ptr<MemoryArena> m_arena;
 
-    TaskList<WorkerThreadTask*> *m_tasks;
+	std::mutex m_mutex;
+	std::deque<WorkerThreadJob> m_jobs;
 };
 
 }  // namespace ml
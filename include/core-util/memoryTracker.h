@@ -0,0 +1,244 @@
+#pragma once
+
+#ifndef CORE_UTIL_MEMORYTRACKER_H_
+#define CORE_UTIL_MEMORYTRACKER_H_
+
+namespace ml {
+
+//
+// memory accounting per subsystem: current and peak bytes, allocation counts and optional budgets. Allocations are attributed
+// either explicitly (TrackingAllocator, recordAllocation) or, if mLib is compiled with MLIB_TRACK_MEMORY, automatically: the
+// global operator new is then replaced and charges every allocation to the subsystem of the innermost MLIB_MEMORY_SCOPE of the
+// calling thread (mLib's meshes, accelerators, grids, images and sensor data set their scopes). Memory from malloc (e.g., the
+// compressed frames of SensorData) is not seen by the tracker; the memoryFootprint() methods of the containers cover it.
+//
+
+enum MemorySubsystem
+{
+	MEMORY_OTHER,
+	MEMORY_MESH,
+	MEMORY_ACCELERATOR,
+	MEMORY_GRID,
+	MEMORY_IMAGE,
+	MEMORY_SENSOR_DATA,
+	MEMORY_SUBSYSTEM_COUNT
+};
+
+struct MemoryStatistics
+{
+	MemorySubsystem subsystem;
+	std::string name;
+	size_t currentBytes;
+	size_t peakBytes;		//! since the start or the last resetPeaks
+	UINT64 allocations;		//! number of allocations so far
+	size_t budgetBytes;		//! 0: unlimited
+};
+
+class MemoryTracker
+{
+public:
+	//! true if mLib was compiled with MLIB_TRACK_MEMORY (otherwise only explicitly recorded allocations are counted)
+	static bool isTrackingAllAllocations() {
+#ifdef MLIB_TRACK_MEMORY
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	//! charges bytes to the subsystem; throws std::bad_alloc (without charging) if that exceeds the subsystem's budget
+	static void recordAllocation(MemorySubsystem subsystem, size_t bytes) {
+		const size_t current = s_currentBytes[subsystem].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		const size_t budget = s_budgetBytes[subsystem].load(std::memory_order_relaxed);
+		if (budget != 0 && current > budget) {
+			s_currentBytes[subsystem].fetch_sub(bytes, std::memory_order_relaxed);
+			throw std::bad_alloc();
+		}
+		s_allocations[subsystem].fetch_add(1, std::memory_order_relaxed);
+		updatePeak(s_peakBytes[subsystem], current);
+		updatePeak(s_totalPeakBytes, s_totalCurrentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+	}
+	static void recordFree(MemorySubsystem subsystem, size_t bytes) {
+		s_currentBytes[subsystem].fetch_sub(bytes, std::memory_order_relaxed);
+		s_totalCurrentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	static size_t getCurrentBytes(MemorySubsystem subsystem) {
+		return s_currentBytes[subsystem].load(std::memory_order_relaxed);
+	}
+	static size_t getPeakBytes(MemorySubsystem subsystem) {
+		return s_peakBytes[subsystem].load(std::memory_order_relaxed);
+	}
+	static size_t getTotalCurrentBytes() {
+		return s_totalCurrentBytes.load(std::memory_order_relaxed);
+	}
+	static size_t getTotalPeakBytes() {
+		return s_totalPeakBytes.load(std::memory_order_relaxed);
+	}
+
+	//! limits the bytes a subsystem may hold (0: unlimited); allocations beyond it throw std::bad_alloc, so a service fails
+	//! the request at hand instead of being killed by the operating system
+	static void setBudget(MemorySubsystem subsystem, size_t bytes) {
+		s_budgetBytes[subsystem].store(bytes, std::memory_order_relaxed);
+	}
+	static size_t getBudget(MemorySubsystem subsystem) {
+		return s_budgetBytes[subsystem].load(std::memory_order_relaxed);
+	}
+	//! true if bytes more can be charged to the subsystem without exceeding its budget (e.g., to check a file before loading it)
+	static bool fitsBudget(MemorySubsystem subsystem, size_t bytes) {
+		const size_t budget = getBudget(subsystem);
+		return budget == 0 || getCurrentBytes(subsystem) + bytes <= budget;
+	}
+
+	//! sets the peaks to the current values
+	static void resetPeaks();
+
+	static const char* getSubsystemName(MemorySubsystem subsystem);
+
+	//! statistics of all subsystems (in the order of MemorySubsystem)
+	static std::vector<MemoryStatistics> getStatistics();
+
+	//! table of all subsystems with current and peak MB
+	static std::string getSummary();
+	static void printSummary() {
+		std::cout << getSummary();
+	}
+
+	//! subsystem that the global operator new charges on the calling thread (see MemoryScope)
+	static MemorySubsystem getCurrentSubsystem() {
+		return s_currentSubsystem;
+	}
+	static void setCurrentSubsystem(MemorySubsystem subsystem) {
+		s_currentSubsystem = subsystem;
+	}
+
+private:
+	static void updatePeak(std::atomic<size_t>& peak, size_t value) {
+		size_t previous = peak.load(std::memory_order_relaxed);
+		while (value > previous && !peak.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {}
+	}
+
+	static std::atomic<size_t> s_currentBytes[MEMORY_SUBSYSTEM_COUNT];
+	static std::atomic<size_t> s_peakBytes[MEMORY_SUBSYSTEM_COUNT];
+	static std::atomic<UINT64> s_allocations[MEMORY_SUBSYSTEM_COUNT];
+	static std::atomic<size_t> s_budgetBytes[MEMORY_SUBSYSTEM_COUNT];
+	static std::atomic<size_t> s_totalCurrentBytes;
+	static std::atomic<size_t> s_totalPeakBytes;
+	static MLIB_THREAD_LOCAL MemorySubsystem s_currentSubsystem;
+};
+
+//! charges the allocations of the calling thread during its lifetime to the given subsystem (restores the previous one afterwards)
+class MemoryScope
+{
+public:
+	MemoryScope(MemorySubsystem subsystem) {
+		m_previous = MemoryTracker::getCurrentSubsystem();
+		MemoryTracker::setCurrentSubsystem(subsystem);
+	}
+	~MemoryScope() {
+		MemoryTracker::setCurrentSubsystem(m_previous);
+	}
+
+private:
+	MemorySubsystem m_previous;
+};
+
+//! std allocator that charges its memory to a subsystem (independent of MLIB_TRACK_MEMORY),
+//! e.g., std::vector<vec3f, TrackingAllocator<vec3f, MEMORY_MESH>>
+template<class T, MemorySubsystem Subsystem = MEMORY_OTHER>
+class TrackingAllocator
+{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template<class U>
+	struct rebind {
+		typedef TrackingAllocator<U, Subsystem> other;
+	};
+
+	TrackingAllocator() {}
+	template<class U>
+	TrackingAllocator(const TrackingAllocator<U, Subsystem>&) {}
+
+	T* allocate(size_t count) {
+		MemoryTracker::recordAllocation(Subsystem, count * sizeof(T));
+		T* data = (T*)std::malloc(count * sizeof(T));
+		if (data == nullptr) {
+			MemoryTracker::recordFree(Subsystem, count * sizeof(T));
+			throw std::bad_alloc();
+		}
+		return data;
+	}
+	void deallocate(T* data, size_t count) {
+		std::free(data);
+		MemoryTracker::recordFree(Subsystem, count * sizeof(T));
+	}
+
+	template<class U, class... Args>
+	void construct(U* p, Args&&... args) {
+		new((void*)p) U(std::forward<Args>(args)...);
+	}
+	template<class U>
+	void destroy(U* p) {
+		p->~U();
+	}
+	size_t max_size() const {
+		return std::numeric_limits<size_t>::max() / sizeof(T);
+	}
+};
+
+template<class T, class U, MemorySubsystem Subsystem>
+inline bool operator==(const TrackingAllocator<T, Subsystem>&, const TrackingAllocator<U, Subsystem>&) {
+	return true;
+}
+template<class T, class U, MemorySubsystem Subsystem>
+inline bool operator!=(const TrackingAllocator<T, Subsystem>&, const TrackingAllocator<U, Subsystem>&) {
+	return false;
+}
+
+namespace util {
+
+	//! heap bytes held by containers (capacity, not size); used by the memoryFootprint() methods
+	template<class T>
+	inline size_t memoryFootprint(const std::vector<T>& v) {
+		return v.capacity() * sizeof(T);
+	}
+	template<class T>
+	inline size_t memoryFootprint(const std::vector<std::vector<T>>& v) {
+		size_t bytes = v.capacity() * sizeof(std::vector<T>);
+		for (const std::vector<T>& inner : v) bytes += memoryFootprint(inner);
+		return bytes;
+	}
+	inline size_t memoryFootprint(const std::string& s) {
+		//short strings are stored inline, in the string object itself
+		const char* object = (const char*)&s;
+		const bool isInline = !std::less<const char*>()(s.data(), object) && std::less<const char*>()(s.data(), object + sizeof(std::string));
+		return isInline ? 0 : s.capacity() + 1;
+	}
+	//! estimate: bucket array plus one node (next pointer, cached hash and value) per element
+	template<class K, class V, class H, class E, class A>
+	inline size_t memoryFootprint(const std::unordered_map<K, V, H, E, A>& m) {
+		return m.bucket_count() * sizeof(void*) + m.size() * (sizeof(std::pair<const K, V>) + 2 * sizeof(void*));
+	}
+
+}  // namespace util
+
+}  // namespace ml
+
+#define MLIB_MEMORY_SCOPE_CONCAT_INNER(a, b) a##b
+#define MLIB_MEMORY_SCOPE_CONCAT(a, b) MLIB_MEMORY_SCOPE_CONCAT_INNER(a, b)
+
+#ifdef MLIB_TRACK_MEMORY
+//! charges the allocations of the rest of the enclosing scope to the subsystem
+#define MLIB_MEMORY_SCOPE(subsystem) ml::MemoryScope MLIB_MEMORY_SCOPE_CONCAT(mlibMemoryScope, __LINE__)(subsystem)
+#else
+#define MLIB_MEMORY_SCOPE(subsystem)
+#endif
+
+#endif // CORE_UTIL_MEMORYTRACKER_H_
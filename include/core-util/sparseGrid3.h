@@ -45,6 +45,11 @@ public:
     return m_Data.size();
   }
 
+	//! bytes held by the grid (estimated for the hash map)
+	size_t memoryFootprint() const {
+		return sizeof(*this) + util::memoryFootprint(m_Data);
+	}
+
 	void clear() {
 		m_Data.clear();
 	}
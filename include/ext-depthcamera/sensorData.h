@@ -87,6 +87,14 @@ namespace ml {
 #define SAFE_DELETE_ARRAY(p) { if (p) { delete[] (p);   (p)=nullptr; } }
 #endif
 
+#ifndef MLIB_PROFILE_ZONE
+#define MLIB_PROFILE_ZONE(name)
+#endif
+
+#ifndef MLIB_MEMORY_SCOPE
+#define MLIB_MEMORY_SCOPE(subsystem)
+#endif
+
 #ifndef UINT64
 #ifdef WIN32
 	typedef unsigned __int64 UINT64;
@@ -408,6 +416,11 @@ namespace ml {
 				m_cameraToWorld.setZero(-std::numeric_limits<float>::infinity());
 			}
 
+			//! bytes held by the frame (including the compressed data)
+			size_t memoryFootprint() const {
+				return sizeof(*this) + (size_t)m_colorSizeBytes + (size_t)m_depthSizeBytes;
+			}
+
 		private:
 			friend class SensorData;
 
@@ -559,6 +572,7 @@ namespace ml {
 			}
 
 			vec3uc* decompressColorAlloc(COMPRESSION_TYPE_COLOR type) const {
+				MLIB_PROFILE_ZONE("SensorData::decompressColor");
 				if (type == TYPE_RAW)	return decompressColorAlloc_raw(type);
 #ifdef _USE_UPLINK_COMPRESSION
 				else return decompressColorAlloc_occ(type);	//this handles all image formats;
@@ -652,6 +666,7 @@ namespace ml {
 			}
 
 			unsigned short* decompressDepthAlloc(unsigned int width, unsigned int height, COMPRESSION_TYPE_DEPTH type) const {
+				MLIB_PROFILE_ZONE("SensorData::decompressDepth");
 				if (type == TYPE_RAW_USHORT)	return decompressDepthAlloc_raw(type);
 				else if (type == TYPE_ZLIB_USHORT) return decompressDepthAlloc_stb(type);
 				else if (type == TYPE_OCCI_USHORT) return decompressDepthAlloc_occ(width, height, type);
@@ -840,6 +855,13 @@ namespace ml {
 			m_depthCompressionType = TYPE_DEPTH_UNKNOWN;
 		}
 
+		//! bytes held by the sensor data (dominated by the compressed frames)
+		size_t memoryFootprint() const {
+			size_t bytes = sizeof(*this) + (m_frames.capacity() - m_frames.size()) * sizeof(RGBDFrame) + m_IMUFrames.capacity() * sizeof(IMUFrame);
+			for (const RGBDFrame& f : m_frames) bytes += f.memoryFootprint();
+			return bytes;
+		}
+
 		//! checks the version number
 		void assertVersionNumber() const {
 			if (m_versionNumber != M_SENSOR_DATA_VERSION)
@@ -1066,6 +1088,7 @@ namespace ml {
 
 		//! saves a .sens file
 		void saveToFile(const std::string& filename) const {
+			MLIB_PROFILE_ZONE("SensorData::saveToFile");
 			std::ofstream out(filename, std::ios::binary);
 			if (!out) {
 				throw std::runtime_error("Unable to open file for writing: " + filename);
@@ -1213,6 +1236,8 @@ namespace ml {
 
 		//! loads a .sens file
 		void loadFromFile(const std::string& filename) {
+			MLIB_PROFILE_ZONE("SensorData::loadFromFile");
+			MLIB_MEMORY_SCOPE(MEMORY_SENSOR_DATA);
 			std::ifstream in(filename, std::ios::binary);
 
 			if (!in.is_open()) {
@@ -1282,7 +1307,7 @@ namespace ml {
 			std::string getCurrent() {
 				std::stringstream ss;
 				ss << m_base;
-				for (unsigned int i = std::max(1u, (unsigned int)std::ceilf(std::log10f((float)m_current + 1))); i < m_numCountDigits; i++) ss << "0";
+				for (unsigned int i = std::max(1u, (unsigned int)std::ceil(std::log10((float)m_current + 1))); i < m_numCountDigits; i++) ss << "0";
 				ss << m_current;
 				ss << m_fileEnding;
 				return ss.str();
@@ -1750,19 +1775,17 @@ namespace ml {
 						m_bTerminateThread = true;	// should be already true anyway
 						break; //we're done
 					}
+					//the list and the ready flags are shared with the decompression thread
+					m_mutexList.lock();
 					if (m_data.size() > 0 && m_data.front().m_bIsReady) {
-						m_mutexList.lock();
 						FrameState fs = m_data.front();
 						m_data.pop_front();
 						m_mutexList.unlock();
 						m_nextFromSensorCache++;
 						return fs;
 					}
-					else {
-						#ifdef _WIN32
-						Sleep(0);
-						#endif
-					}
+					m_mutexList.unlock();
+					std::this_thread::yield();
 				}
 				return FrameState();
 			}
@@ -1777,7 +1800,10 @@ namespace ml {
 					if (cache->m_bTerminateThread) break;
 					if (cache->m_nextFromSensorData >= cache->m_sensorData->m_frames.size()) break;	//we're done
 
-					if (cache->m_data.size() < cache->m_cacheSize) {	//need to fill the cache
+					cache->m_mutexList.lock();
+					const bool needsFrame = cache->m_data.size() < cache->m_cacheSize;
+					cache->m_mutexList.unlock();
+					if (needsFrame) {	//need to fill the cache
 						cache->m_mutexList.lock();
 						cache->m_data.push_back(FrameState());
 						cache->m_mutexList.unlock();
@@ -1791,9 +1817,14 @@ namespace ml {
 						fs.m_depthFrame = sensorData->decompressDepthAlloc(frame);
 						fs.m_timeStampDepth = frame.m_timeStampDepth;
 						fs.m_timeStampColor = frame.m_timeStampColor;
+						cache->m_mutexList.lock();
 						fs.m_bIsReady = true;
+						cache->m_mutexList.unlock();
 						cache->m_nextFromSensorData++;
 					}
+					else {
+						std::this_thread::yield();
+					}
 				}
 			}
 
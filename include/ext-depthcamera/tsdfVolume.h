@@ -0,0 +1,308 @@
+
+#ifndef _TSDF_VOLUME_H_
+#define _TSDF_VOLUME_H_
+
+namespace ml {
+
+	//! truncated signed distance volume fused from depth frames (Curless and Levoy; Newcombe et al., "KinectFusion"): every voxel keeps the weighted
+	//! average of its projective distances to the observed surfaces (in meters, clamped to the truncation, positive in front of a surface), the
+	//! summed weight and optionally an averaged color. Voxels with weight 0 are unobserved.
+	class TSDFVolume {
+	public:
+		//! dim voxels of voxelSize meters; the center of voxel (0, 0, 0) is at origin (in world space); truncation in meters (0: 4 voxels)
+		TSDFVolume(const vec3ul& dim, float voxelSize, const vec3f& origin = vec3f::origin, float truncation = 0.0f, bool useColor = true) {
+			m_voxelSize = voxelSize;
+			m_origin = origin;
+			m_truncation = truncation > 0.0f ? truncation : 4.0f * voxelSize;
+			m_maxWeight = 128.0f;
+			m_tsdf.allocate(dim.x, dim.y, dim.z);
+			m_weight.allocate(dim.x, dim.y, dim.z);
+			if (useColor) m_color.allocate(dim.x, dim.y, dim.z);
+			reset();
+		}
+
+		//! all voxels become unobserved
+		void reset() {
+			m_tsdf.setValues(m_truncation);
+			m_weight.setValues(0.0f);
+			if (hasColor()) m_color.setValues(vec3uc(0, 0, 0));
+		}
+
+		//! integrates a depth image (in meters; invalid pixels hold the invalid value or 0) taken with depthIntrinsic from cameraToWorld; color
+		//! (optional) is looked up through depthToColor (depth to color camera space) and colorIntrinsic. Parallel over slices with MLIB_OPENMP;
+		//! within a row, the projection is scalar and the distance and weight update is a branch-free masked pass.
+		void integrate(const DepthImage32& depth, const mat4f& depthIntrinsic, const mat4f& cameraToWorld,
+			const ColorImageR8G8B8* color = nullptr, const mat4f& colorIntrinsic = mat4f::identity(), const mat4f& depthToColor = mat4f::identity()) {
+
+			const mat4f worldToCamera = cameraToWorld.getInverse();
+			const float fx = depthIntrinsic(0, 0), fy = depthIntrinsic(1, 1), mx = depthIntrinsic(0, 2), my = depthIntrinsic(1, 2);
+			const int width = (int)depth.getWidth(), height = (int)depth.getHeight();
+			const bool integrateColor = color != nullptr && hasColor();
+
+			//camera space positions are affine in x, so every row is traversed with a constant step
+			const vec3f step = worldToCamera.getMatrix3x3() * vec3f(m_voxelSize, 0.0f, 0.0f);
+			const float truncation = m_truncation, maxWeight = m_maxWeight;
+			const size_t dimX = m_tsdf.getDimX();
+
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+			for (int z = 0; z < (int)m_tsdf.getDimZ(); z++) {
+				//per row: camera space depths, projected pixel coordinates and observed distances (-infinity where nothing is observed)
+				std::vector<float> rowZ(dimX), rowU(dimX), rowV(dimX), rowSdf(dimX);
+				for (size_t y = 0; y < m_tsdf.getDimY(); y++) {
+					const vec3f rowStart = worldToCamera * getWorldPosition(vec3f(0.0f, (float)y, (float)z));
+
+					//projection without branches (meaningless behind the camera, which the lookup skips); the index is an int, as size_t to float does not vectorize
+					for (int x = 0; x < (int)dimX; x++) {
+						const float cx = rowStart.x + (float)x * step.x, cy = rowStart.y + (float)x * step.y, cz = rowStart.z + (float)x * step.z;
+						rowZ[x] = cz;
+						rowU[x] = fx * cx / cz + mx;
+						rowV[x] = fy * cy / cz + my;
+					}
+
+					//depth lookup (a gather, so it stays scalar); pixel p covers [p - 0.5, p + 0.5), as with math::round
+					for (size_t x = 0; x < dimX; x++) {
+						float sdf = -std::numeric_limits<float>::infinity();
+						if (rowZ[x] > 0.0f && rowU[x] > -0.5f && rowV[x] > -0.5f && rowU[x] + 0.5f < (float)width && rowV[x] + 0.5f < (float)height) {
+							const float d = depth((unsigned int)(rowU[x] + 0.5f), (unsigned int)(rowV[x] + 0.5f));
+							if (depth.isValidValue(d) && d > 0.0f) sdf = d - rowZ[x];
+						}
+						rowSdf[x] = sdf;
+					}
+
+					//colors are averaged with the weights before the update
+					if (integrateColor) {
+						for (size_t x = 0; x < dimX; x++) {
+							if (rowSdf[x] < -truncation || rowSdf[x] >= truncation) continue;
+							const vec3f cc = depthToColor * (rowStart + (float)x * step);
+							const int cu = math::round(colorIntrinsic(0, 0) * cc.x / cc.z + colorIntrinsic(0, 2));
+							const int cv = math::round(colorIntrinsic(1, 1) * cc.y / cc.z + colorIntrinsic(1, 2));
+							if (cc.z > 0.0f && cu >= 0 && cv >= 0 && cu < (int)color->getWidth() && cv < (int)color->getHeight()) {
+								const float weight = m_weight(x, y, (size_t)z);
+								vec3uc& voxelColor = m_color(x, y, (size_t)z);
+								const vec3f averaged = (vec3f(voxelColor) * weight + vec3f((*color)(cu, cv))) / (weight + 1.0f);
+								voxelColor = vec3uc(math::round(averaged.x), math::round(averaged.y), math::round(averaged.z));
+							}
+						}
+					}
+
+					//masked update without branches or conditional stores, so the compiler can vectorize it; voxels behind the truncation
+					//band (occluded) keep their values. The mask is 0 or 1 and the clamped distance is finite, so blending is exact.
+					float* value = &m_tsdf(0, y, (size_t)z);
+					float* weight = &m_weight(0, y, (size_t)z);
+					for (size_t x = 0; x < dimX; x++) {
+						const float observed = rowSdf[x] >= -truncation ? 1.0f : 0.0f;
+						const float w = weight[x];
+						const float blended = (value[x] * w + std::max(std::min(rowSdf[x], truncation), -truncation)) / (w + 1.0f);
+						value[x] = observed * blended + (1.0f - observed) * value[x];
+						weight[x] = observed * std::min(w + 1.0f, maxWeight) + (1.0f - observed) * w;
+					}
+				}
+			}
+		}
+
+		//! integrates all frames of sensorData with valid poses; the frames are decompressed in the background (RGBDFrameCacheRead)
+		//! while the previous one is integrated
+		void integrate(SensorData& sensorData, unsigned int cacheSize = 10) {
+			const mat4f colorIntrinsic = sensorData.m_calibrationColor.m_intrinsic;
+			const mat4f depthToColor = sensorData.m_calibrationDepth.m_extrinsic;
+			DepthImage32 depth(sensorData.m_depthWidth, sensorData.m_depthHeight);
+			ColorImageR8G8B8 color(sensorData.m_colorWidth, sensorData.m_colorHeight);
+
+			SensorData::RGBDFrameCacheRead cache(&sensorData, cacheSize);
+			for (size_t i = 0; i < sensorData.m_frames.size(); i++) {
+				SensorData::RGBDFrameCacheRead::FrameState frame = cache.getNext();
+				const mat4f& cameraToWorld = sensorData.m_frames[i].getCameraToWorld();
+				const bool validPose = cameraToWorld(0, 0) != -std::numeric_limits<float>::infinity() && cameraToWorld(0, 0) == cameraToWorld(0, 0);
+				if (validPose && frame.m_depthFrame != nullptr) {
+					for (size_t p = 0; p < depth.getNumPixels(); p++) {
+						const unsigned short d = frame.m_depthFrame[p];
+						depth.getData()[p] = d == 0 ? depth.getInvalidValue() : (float)d / sensorData.m_depthShift;
+					}
+					const bool useColor = hasColor() && frame.m_colorFrame != nullptr;
+					if (useColor) std::copy(frame.m_colorFrame, frame.m_colorFrame + color.getNumPixels(), color.getData());
+					integrate(depth, sensorData.m_calibrationDepth.m_intrinsic, cameraToWorld, useColor ? &color : nullptr, colorIntrinsic, depthToColor);
+				}
+				frame.free();
+			}
+		}
+
+		//! renders the surface (zero crossing) seen from cameraToWorld with intrinsic: depth in meters and camera space normals (both with
+		//! their invalid value where no surface is found between minDepth and maxDepth). Parallel over rows with MLIB_OPENMP.
+		void raycast(const mat4f& intrinsic, const mat4f& cameraToWorld, unsigned int width, unsigned int height, DepthImage32& depth, PointImage& normals,
+			float minDepth = 0.1f, float maxDepth = 10.0f) const {
+
+			depth.allocate(width, height);
+			normals.allocate(width, height);
+			normals.setInvalidValue(vec3f(-std::numeric_limits<float>::infinity()));
+			const float fx = intrinsic(0, 0), fy = intrinsic(1, 1), mx = intrinsic(0, 2), my = intrinsic(1, 2);
+			const mat3f cameraToWorldRotation = cameraToWorld.getMatrix3x3();
+			const mat3f worldToCameraRotation = cameraToWorldRotation.getInverse();
+			const vec3f eye = cameraToWorld.getTranslation();
+
+			//bounds of the voxel centers, in which samples are interpolated
+			const vec3f boundsMin = m_origin;
+			const vec3f boundsMax = getWorldPosition(vec3f((float)m_tsdf.getDimX() - 1, (float)m_tsdf.getDimY() - 1, (float)m_tsdf.getDimZ() - 1));
+
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+			for (int y = 0; y < (int)height; y++) {
+				for (unsigned int x = 0; x < width; x++) {
+					depth(x, (unsigned int)y) = depth.getInvalidValue();
+					normals(x, (unsigned int)y) = normals.getInvalidValue();
+
+					//t is the camera space depth along the ray
+					const vec3f dir = cameraToWorldRotation * vec3f(((float)x - mx) / fx, ((float)y - my) / fy, 1.0f);
+					float tMin = minDepth, tMax = maxDepth;
+					if (!clipRay(eye, dir, boundsMin, boundsMax, tMin, tMax)) continue;
+
+					//steps shorter than the truncation cannot jump over a zero crossing
+					const float tStep = 0.5f * m_truncation / dir.length();
+					float tPrev = tMin, fPrev = 0.0f;
+					bool prevValid = false;
+					for (float t = tMin; t <= tMax; t += tStep) {
+						float f;
+						if (!sampleTSDF(eye + t * dir, f)) {
+							prevValid = false;
+							continue;
+						}
+						if (prevValid && fPrev > 0.0f && f <= 0.0f) {
+							const float tHit = tPrev + (t - tPrev) * fPrev / (fPrev - f);
+							vec3f n;
+							if (sampleGradient(eye + tHit * dir, n)) {
+								depth(x, (unsigned int)y) = tHit;
+								normals(x, (unsigned int)y) = (worldToCameraRotation * n).getNormalized();
+							}
+							break;
+						}
+						if (prevValid && fPrev < 0.0f && f > 0.0f) break;	//back side of a surface
+						tPrev = t;
+						fPrev = f;
+						prevValid = true;
+					}
+				}
+			}
+		}
+
+		//! trilinear interpolation of the distance at a world position; false if one of the 8 voxels is unobserved or outside
+		bool sampleTSDF(const vec3f& world, float& tsdf) const {
+			const vec3f p = (world - m_origin) / m_voxelSize;
+			if (p.x < 0.0f || p.y < 0.0f || p.z < 0.0f) return false;
+			const size_t x = (size_t)p.x, y = (size_t)p.y, z = (size_t)p.z;
+			if (x + 1 >= m_tsdf.getDimX() || y + 1 >= m_tsdf.getDimY() || z + 1 >= m_tsdf.getDimZ()) return false;
+			const vec3f w(p.x - (float)x, p.y - (float)y, p.z - (float)z);
+
+			float v[8];
+			for (int i = 0; i < 8; i++) {
+				const size_t cx = x + (i & 1), cy = y + ((i >> 1) & 1), cz = z + (i >> 2);
+				if (m_weight(cx, cy, cz) == 0.0f) return false;
+				v[i] = m_tsdf(cx, cy, cz);
+			}
+			tsdf = (1.0f - w.z) * ((1.0f - w.y) * ((1.0f - w.x) * v[0] + w.x * v[1]) + w.y * ((1.0f - w.x) * v[2] + w.x * v[3]))
+				+ w.z * ((1.0f - w.y) * ((1.0f - w.x) * v[4] + w.x * v[5]) + w.y * ((1.0f - w.x) * v[6] + w.x * v[7]));
+			return true;
+		}
+
+		//! world position of a (fractional) voxel coordinate
+		vec3f getWorldPosition(const vec3f& voxel) const {
+			return m_origin + voxel * m_voxelSize;
+		}
+
+		//! zero level set of the observed voxels as a mesh in world space (with colors if the volume has them)
+		TriMeshf extractMesh() const {
+			Grid3<float> tsdf = m_tsdf;
+#ifdef MLIB_OPENMP
+#pragma omp parallel for
+#endif
+			for (int z = 0; z < (int)tsdf.getDimZ(); z++) {
+				for (size_t y = 0; y < tsdf.getDimY(); y++) {
+					for (size_t x = 0; x < tsdf.getDimX(); x++) {
+						if (m_weight(x, y, z) == 0.0f) tsdf(x, y, z) = std::numeric_limits<float>::infinity();
+					}
+				}
+			}
+			const mat4f voxelToWorld = mat4f::translation(m_origin) * mat4f::scale(m_voxelSize);
+			if (hasColor()) return MarchingCubesf::extract(tsdf, m_color, 0.0f, voxelToWorld);
+			return MarchingCubesf::extract(tsdf, 0.0f, voxelToWorld);
+		}
+
+		const Grid3<float>& getTSDF() const {
+			return m_tsdf;
+		}
+		const Grid3<float>& getWeights() const {
+			return m_weight;
+		}
+		//! empty if the volume was created without color
+		const Grid3<vec3uc>& getColors() const {
+			return m_color;
+		}
+		bool hasColor() const {
+			return m_color.getNumElements() > 0;
+		}
+
+		float getVoxelSize() const {
+			return m_voxelSize;
+		}
+		const vec3f& getOrigin() const {
+			return m_origin;
+		}
+		float getTruncation() const {
+			return m_truncation;
+		}
+
+		//! weights saturate at maxWeight (default 128), so the volume keeps adapting to new observations
+		void setMaxWeight(float maxWeight) {
+			m_maxWeight = maxWeight;
+		}
+		float getMaxWeight() const {
+			return m_maxWeight;
+		}
+
+		//! bytes held by the volume
+		size_t memoryFootprint() const {
+			return sizeof(*this) + (m_tsdf.getNumElements() + m_weight.getNumElements()) * sizeof(float) + m_color.getNumElements() * sizeof(vec3uc);
+		}
+
+	private:
+		//! central differences of the distance at a world position (not normalized)
+		bool sampleGradient(const vec3f& world, vec3f& gradient) const {
+			float f[6];
+			for (int axis = 0; axis < 3; axis++) {
+				vec3f offset = vec3f::origin;
+				offset[axis] = m_voxelSize;
+				if (!sampleTSDF(world + offset, f[2 * axis]) || !sampleTSDF(world - offset, f[2 * axis + 1])) return false;
+			}
+			gradient = vec3f(f[0] - f[1], f[2] - f[3], f[4] - f[5]);
+			return gradient.lengthSq() > 0.0f;
+		}
+
+		//! clips [tMin, tMax] of the ray eye + t * dir to the box; false if nothing is left
+		static bool clipRay(const vec3f& eye, const vec3f& dir, const vec3f& boxMin, const vec3f& boxMax, float& tMin, float& tMax) {
+			for (int axis = 0; axis < 3; axis++) {
+				if (dir[axis] == 0.0f) {
+					if (eye[axis] < boxMin[axis] || eye[axis] > boxMax[axis]) return false;
+					continue;
+				}
+				float t0 = (boxMin[axis] - eye[axis]) / dir[axis];
+				float t1 = (boxMax[axis] - eye[axis]) / dir[axis];
+				if (t0 > t1) std::swap(t0, t1);
+				tMin = std::max(tMin, t0);
+				tMax = std::min(tMax, t1);
+			}
+			return tMin <= tMax;
+		}
+
+		float m_voxelSize;
+		vec3f m_origin;
+		float m_truncation;
+		float m_maxWeight;
+		Grid3<float> m_tsdf;
+		Grid3<float> m_weight;
+		Grid3<vec3uc> m_color;
+	};
+
+} // namespace ml
+
+#endif // _TSDF_VOLUME_H_
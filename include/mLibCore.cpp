@@ -12,6 +12,8 @@
 #include <unistd.h>
 #include <sys/time.h>
 #include <dirent.h>
+#include <sched.h>
+#include <pthread.h>
 #endif
 
 //
@@ -32,6 +34,8 @@
 #include "../src/core-util/windowsUtil.cpp"
 #include "../src/core-util/directory.cpp"
 #include "../src/core-util/timer.cpp"
+#include "../src/core-util/profiler.cpp"
+#include "../src/core-util/memoryTracker.cpp"
 #include "../src/core-util/pipe.cpp"
 #include "../src/core-util/UIConnection.cpp"
 #include "../src/core-util/eventMap.cpp"
@@ -41,6 +45,7 @@
 //
 #include "../src/core-multithreading/threadPool.cpp"
 #include "../src/core-multithreading/workerThread.cpp"
+#include "../src/core-multithreading/threadPlacement.cpp"
 
 //
 // core-graphics source files
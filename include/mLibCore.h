@@ -21,6 +21,7 @@
 #include "core-util/binaryDataBuffer.h"
 #include "core-util/binaryDataSerialize.h"
 #include "core-util/binaryDataStream.h"
+#include "core-util/memoryTracker.h"
 
 //
 // core-math headers
@@ -136,6 +137,7 @@ namespace ml
 // core-base headers
 //
 #include "core-base/grid2.h"
+#include "core-base/grid3Layout.h"
 #include "core-base/grid3.h"
 
 //
@@ -144,6 +146,7 @@ namespace ml
 #include "core-util/stringUtilConvert.h"
 #include "core-util/directory.h"
 #include "core-util/timer.h"
+#include "core-util/profiler.h"
 #include "core-util/nearestNeighborSearch.h"
 #include "core-util/commandLineReader.h"
 #include "core-util/parameterFile.h"
@@ -158,8 +161,12 @@ namespace ml
 // core-multithreading headers
 //
 #include "core-multithreading/taskList.h"
+#include "core-multithreading/lockFreeQueue.h"
+#include "core-multithreading/threadPlacement.h"
+#include "core-multithreading/memoryArena.h"
 #include "core-multithreading/workerThread.h"
 #include "core-multithreading/threadPool.h"
+#include "core-multithreading/parallelAlgorithms.h"
 
 //
 // core-graphics headers
@@ -181,6 +188,7 @@ namespace ml
 #include "core-graphics/orientedBoundingBox3.h"
 #include "core-graphics/dist.h"
 #include "core-base/distanceField3.h"
+#include "core-base/sparseDistanceField3.h"
 #include "core-util/uniformAccelerator.h"
 #include "core-base/baseImage.h"
 #include "core-util/colorGradient.h"
@@ -199,12 +207,16 @@ namespace ml
 
 #include "core-mesh/triMesh.h"
 #include "core-mesh/triMeshSampler.h"
+#include "core-mesh/marchingCubes.h"
 
 #include "core-mesh/triMeshAccelerator.h"
 #include "core-mesh/triMeshRayAccelerator.h"
 #include "core-mesh/triMeshCollisionAccelerator.h"
 #include "core-mesh/triMeshAcceleratorBruteForce.h"
 #include "core-mesh/triMeshAcceleratorBVH.h"
+#include "core-mesh/triMeshAcceleratorLinearBVH.h"
+#include "core-mesh/triMeshInstanceAccelerator.h"
+#include "core-mesh/triMeshCollisionBroadPhase.h"
 
 #include "core-mesh/meshUtil.h"
 #include "core-mesh/meshShapes.h"
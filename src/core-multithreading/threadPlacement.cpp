@@ -0,0 +1,149 @@
+
+namespace ml
+{
+
+//! parses a Linux cpu list such as "0-3,8-11"
+static std::vector<UINT> parseProcessorList(const std::string &list)
+{
+	std::vector<UINT> processors;
+	for(const std::string &range : util::split(list, ","))
+	{
+		const std::vector<std::string> bounds = util::split(range, "-");
+		if(bounds.empty()) continue;
+		const UINT first = util::convertTo<UINT>(bounds[0]);
+		const UINT last = bounds.size() > 1 ? util::convertTo<UINT>(bounds[1]) : first;
+		for(UINT processor = first; processor <= last; processor++)
+			processors.push_back(processor);
+	}
+	return processors;
+}
+
+CpuTopology::CpuTopology()
+{
+#ifdef _WIN32
+	ULONG highestNode = 0;
+	if(GetNumaHighestNodeNumber(&highestNode))
+	{
+		for(ULONG node = 0; node <= highestNode; node++)
+		{
+			ULONGLONG mask = 0;
+			if(!GetNumaNodeProcessorMask((UCHAR)node, &mask) || mask == 0) continue;
+			std::vector<UINT> processors;
+			for(UINT processor = 0; processor < 64; processor++)
+				if(mask & (1ull << processor)) processors.push_back(processor);
+			m_nodes.push_back(processors);
+		}
+	}
+#endif //_WIN32
+
+#ifdef LINUX
+	const std::string nodeDirectory = "/sys/devices/system/node/";
+	DIR *directory = opendir(nodeDirectory.c_str());
+	if(directory != nullptr)
+	{
+		std::vector<std::string> nodeNames;
+		while(dirent *entry = readdir(directory))
+		{
+			const std::string name = entry->d_name;
+			if(name.size() > 4 && name.compare(0, 4, "node") == 0 && isdigit(name[4])) nodeNames.push_back(name);
+		}
+		closedir(directory);
+		std::sort(nodeNames.begin(), nodeNames.end(), [](const std::string &a, const std::string &b)
+		{
+			return util::convertTo<UINT>(a.substr(4)) < util::convertTo<UINT>(b.substr(4));
+		});
+
+		for(const std::string &name : nodeNames)
+		{
+			std::ifstream file(nodeDirectory + name + "/cpulist");
+			std::string list;
+			if(!std::getline(file, list)) continue;
+			const std::vector<UINT> processors = parseProcessorList(list);
+			if(!processors.empty()) m_nodes.push_back(processors);
+		}
+	}
+#endif //LINUX
+
+	if(m_nodes.empty())
+	{
+		m_nodes.resize(1);
+		const UINT processorCount = std::max(1u, std::thread::hardware_concurrency());
+		for(UINT processor = 0; processor < processorCount; processor++)
+			m_nodes[0].push_back(processor);
+	}
+}
+
+const CpuTopology& CpuTopology::get()
+{
+	static CpuTopology topology;
+	return topology;
+}
+
+UINT CpuTopology::getProcessorCount() const
+{
+	UINT count = 0;
+	for(const std::vector<UINT> &node : m_nodes)
+		count += (UINT)node.size();
+	return count;
+}
+
+UINT CpuTopology::getThreadNode(UINT threadIndex, ThreadPlacement placement) const
+{
+	if(placement == PLACEMENT_FREE) return 0;
+	return threadIndex % getNodeCount();
+}
+
+std::vector<UINT> CpuTopology::getThreadProcessors(UINT threadIndex, ThreadPlacement placement) const
+{
+	if(placement == PLACEMENT_FREE) return std::vector<UINT>();
+	const std::vector<UINT> &processors = m_nodes[getThreadNode(threadIndex, placement)];
+	if(placement == PLACEMENT_NODE) return processors;
+	return std::vector<UINT>(1, processors[(threadIndex / getNodeCount()) % processors.size()]);
+}
+
+bool CpuTopology::setCurrentThreadAffinity(const std::vector<UINT> &processors)
+{
+	if(processors.empty()) return false;
+#ifdef _WIN32
+	DWORD_PTR mask = 0;
+	for(UINT processor : processors)
+		if(processor < 8 * sizeof(DWORD_PTR)) mask |= (DWORD_PTR)1 << processor;
+	return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(LINUX)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for(UINT processor : processors)
+		if(processor < CPU_SETSIZE) CPU_SET(processor, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+void* CpuTopology::allocateOnNode(size_t size, int node)
+{
+#ifdef _WIN32
+	if(node >= 0) return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, (DWORD)node);
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(LINUX)
+	//first touch: writing one byte per page places the pages on the node of the calling thread
+	char *data = (char*)malloc(size);
+	if(data != nullptr && node >= 0)
+		for(size_t offset = 0; offset < size; offset += 4096)
+			data[offset] = 0;
+	return data;
+#else
+	return malloc(size);
+#endif
+}
+
+void CpuTopology::freeOnNode(void *data)
+{
+#ifdef _WIN32
+	VirtualFree(data, 0, MEM_RELEASE);
+#else
+	free(data);
+#endif
+}
+
+}  // namespace ml
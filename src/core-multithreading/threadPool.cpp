@@ -2,52 +2,207 @@
 namespace ml
 {
 
-void ThreadPool::init(UINT threadCount)
+ThreadPool::ThreadPool()
 {
-	m_threads.resize(threadCount);
-	for(UINT threadIndex = 0; threadIndex < threadCount; threadIndex++)
-		m_threads[threadIndex].init(threadIndex, nullptr);
+	m_queuedJobs = 0;
+	m_nextThread = 0;
+	m_stop = false;
+	m_placement = PLACEMENT_FREE;
+}
+
+ThreadPool::ThreadPool(UINT threadCount, ThreadPlacement placement)
+{
+	m_queuedJobs = 0;
+	m_nextThread = 0;
+	m_stop = false;
+	m_placement = PLACEMENT_FREE;
+	init(threadCount, placement);
+}
+
+ThreadPool::~ThreadPool()
+{
+	stop();
+}
+
+ThreadPool& ThreadPool::getShared()
+{
+	static ThreadPool pool(0);
+	return pool;
+}
+
+void ThreadPool::init(UINT threadCount, ThreadPlacement placement)
+{
+	if(threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+	init(threadCount, std::vector<ThreadLocalStorage*>(threadCount, nullptr), placement);
 }
 
-void ThreadPool::init(UINT threadCount, const std::vector<ThreadLocalStorage*> &threadLocalStorage)
+void ThreadPool::init(UINT threadCount, const std::vector<ThreadLocalStorage*> &threadLocalStorage, ThreadPlacement placement)
 {
-	m_threads.resize(threadCount);
+	stop();
+	if(threadCount == 0) threadCount = (UINT)threadLocalStorage.size();
+	MLIB_ASSERT_STR(threadLocalStorage.size() >= threadCount, "thread local storage required for each thread");
+	m_placement = placement;
+
+	//all workers must exist before the first one starts stealing
 	for(UINT threadIndex = 0; threadIndex < threadCount; threadIndex++)
-		m_threads[threadIndex].init(threadIndex, threadLocalStorage[threadIndex]);
+		m_threads.push_back(std::unique_ptr<WorkerThread>(new WorkerThread));
+	const CpuTopology &topology = CpuTopology::get();
+	for(UINT threadIndex = 0; threadIndex < threadCount; threadIndex++)
+	{
+		ThreadLocalStorage *storage = threadLocalStorage[threadIndex];
+		if(storage == nullptr)
+		{
+			m_defaultStorage.push_back(std::unique_ptr<ThreadLocalStorage>(new ThreadLocalStorage));
+			storage = m_defaultStorage.back().get();
+		}
+		const int node = placement == PLACEMENT_FREE ? -1 : (int)topology.getThreadNode(threadIndex, placement);
+		m_threads[threadIndex]->init(threadIndex, storage, this, topology.getThreadProcessors(threadIndex, placement), node);
+	}
+}
+
+void ThreadPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+		m_stop = true;
+	}
+	m_workCondition.notify_all();
+	for(auto &thread : m_threads)
+		thread->join();
+	m_threads.clear();
+	m_defaultStorage.clear();
+	m_stop = false;
 }
 
 void ThreadPool::runTasks(TaskList<WorkerThreadTask*> &tasks, bool useConsole)
 {
 	if(useConsole) std::cout << "running "  << tasks.tasksLeft() << " tasks" << std::endl;
 
-	for(UINT threadIndex = 0; threadIndex < m_threads.size(); threadIndex++)
-		m_threads[threadIndex].processTasks(tasks);
+	if(m_threads.empty())
+	{
+		WorkerThreadTask *task;
+		while(tasks.getNextTask(task))
+		{
+			task->run(0, nullptr);
+			delete task;
+		}
+		if(useConsole) std::cout << "all tasks completed" << std::endl;
+		return;
+	}
 
-	UINT consoleDelay = 0;
+	//many small tasks are claimed in batches, each run by a single job, which saves most of the per-job queueing;
+	//there are still enough batches per thread for stealing to balance uneven tasks
+	const size_t batchSize = std::max((size_t)1, std::min((size_t)64, (size_t)tasks.tasksLeft() / (16 * m_threads.size())));
 
-	bool allThreadsCompleted = false;
-	while(!allThreadsCompleted)
+	std::atomic<size_t> pending(0);
+	std::vector<WorkerThreadTask*> batch;
+	while(tasks.getNextTasks(batch, batchSize))
 	{
-		UINT activeThreadCount = 0;
-		for(UINT threadIndex = 0; threadIndex < m_threads.size(); threadIndex++)
-			if(!m_threads[threadIndex].done())
-				activeThreadCount++;
+		WorkerThreadJob job;
+		job.run = [batch](UINT threadIndex, ThreadLocalStorage *storage)
+		{
+			for(WorkerThreadTask *task : batch)
+			{
+				task->run(threadIndex, storage);
+				delete task;
+			}
+		};
+		job.pending = &pending;
+		pending++;
+		enqueue(job);
+	}
 
-		if(activeThreadCount == 0)
-			allThreadsCompleted = true;
+	if(useConsole && getCurrentWorker() < 0)
+	{
+		std::unique_lock<std::mutex> lock(m_doneMutex);
+		while(!m_doneCondition.wait_for(lock, std::chrono::seconds(1), [&pending]() { return pending == 0; }))
+			std::cout << "task batches left: " << pending << " (" << batchSize << " tasks each)" << std::endl;
+	}
+	else
+	{
+		wait(pending);
+	}
+	if(useConsole) std::cout << "all tasks completed" << std::endl;
+}
+
+void ThreadPool::enqueue(const WorkerThreadJob &job)
+{
+	const int currentWorker = getCurrentWorker();
+	const UINT threadIndex = currentWorker >= 0 ? (UINT)currentWorker : m_nextThread++ % (UINT)m_threads.size();
+	m_threads[threadIndex]->push(job);
+	m_queuedJobs++;
+
+	//a worker checks m_queuedJobs under the mutex before it sleeps, so the notification cannot get lost
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+	}
+	m_workCondition.notify_one();
+}
+
+bool ThreadPool::getJob(UINT workerIndex, WorkerThreadJob &job)
+{
+	bool found = m_threads[workerIndex]->popBack(job);
+	for(UINT i = 1; !found && i < m_threads.size(); i++)
+		found = m_threads[(workerIndex + i) % m_threads.size()]->stealFront(job);
+	if(found) m_queuedJobs--;
+	return found;
+}
 
-		if(consoleDelay == 0)
+void ThreadPool::runJob(const WorkerThreadJob &job, UINT threadIndex, ThreadLocalStorage *storage)
+{
+	job.run(threadIndex, storage);
+	if(job.pending && --(*job.pending) == 0)
+	{
+		std::lock_guard<std::mutex> lock(m_doneMutex);
+		m_doneCondition.notify_all();
+	}
+}
+
+void ThreadPool::wait(std::atomic<size_t> &pending)
+{
+	const int currentWorker = getCurrentWorker();
+	if(currentWorker >= 0)
+	{
+		WorkerThread &worker = *m_threads[currentWorker];
+		WorkerThreadJob job;
+		while(pending > 0)
 		{
-			if(useConsole) std::cout << "tasks left: " << tasks.tasksLeft() + activeThreadCount << std::endl;
-			consoleDelay = 40;
+			if(getJob(worker.getThreadIndex(), job))
+				runJob(job, worker.getThreadIndex(), worker.getStorage());
+			else
+				std::this_thread::yield();
 		}
-		else
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_doneMutex);
+	m_doneCondition.wait(lock, [&pending]() { return pending == 0; });
+}
+
+int ThreadPool::getCurrentWorker() const
+{
+	const std::thread::id id = std::this_thread::get_id();
+	for(size_t threadIndex = 0; threadIndex < m_threads.size(); threadIndex++)
+		if(m_threads[threadIndex]->getThreadId() == id)
+			return (int)threadIndex;
+	return -1;
+}
+
+void ThreadPool::workerLoop(WorkerThread &worker)
+{
+	WorkerThreadJob job;
+	while(true)
+	{
+		if(getJob(worker.getThreadIndex(), job))
 		{
-			consoleDelay--;
+			runJob(job, worker.getThreadIndex(), worker.getStorage());
+			continue;
 		}
-		std::this_thread::sleep_for( std::chrono::milliseconds(25) );
+
+		std::unique_lock<std::mutex> lock(m_workMutex);
+		m_workCondition.wait(lock, [this]() { return m_queuedJobs > 0 || m_stop; });
+		if(m_stop && m_queuedJobs == 0) return;
 	}
-	if(useConsole) std::cout << "all tasks completed" << std::endl;
 }
 
 }  // namespace ml
@@ -2,33 +2,52 @@
 namespace ml
 {
 
-void WorkerThread::init(UINT threadIndex, ThreadLocalStorage *storage)
+void WorkerThread::init(UINT threadIndex, ThreadLocalStorage *storage, ThreadPool *pool, const std::vector<UINT> &processors, int node)
 {
 	m_threadIndex = threadIndex;
 	m_storage = storage;
+	m_pool = pool;
+	m_processors = processors;
+	m_node = node;
+	m_arena.reset(new MemoryArena(node));
+	if(m_storage) m_storage->m_arena = m_arena.get();
+	m_thread = std::thread(workerThreadEntry, this);
 }
 
-void WorkerThread::processTasks(TaskList<WorkerThreadTask*> &tasks)
+void WorkerThread::join()
 {
-	m_done = false;
-	m_tasks = &tasks;
-	m_thread = new std::thread(workerThreadEntry, this);
+	if(m_thread.joinable())
+		m_thread.join();
 }
 
-void WorkerThread::workerThreadEntry( WorkerThread *context )
+void WorkerThread::push(const WorkerThreadJob &job)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_jobs.push_back(job);
+}
+
+bool WorkerThread::popBack(WorkerThreadJob &job)
 {
-	context->enterThreadTaskLoop();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_jobs.empty()) return false;
+	job = m_jobs.back();
+	m_jobs.pop_back();
+	return true;
 }
 
-void WorkerThread::enterThreadTaskLoop()
+bool WorkerThread::stealFront(WorkerThreadJob &job)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if(m_jobs.empty()) return false;
+	job = m_jobs.front();
+	m_jobs.pop_front();
+	return true;
+}
+
+void WorkerThread::workerThreadEntry( WorkerThread *context )
 {
-	WorkerThreadTask* curTask;
-	while(m_tasks->getNextTask(curTask))
-	{
-		curTask->run(m_threadIndex, m_storage);
-		delete curTask;
-	}
-	m_done = true;
+	if(!context->m_processors.empty()) CpuTopology::setCurrentThreadAffinity(context->m_processors);
+	context->m_pool->workerLoop(*context);
 }
 
 }  // namespace ml
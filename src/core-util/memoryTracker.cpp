@@ -0,0 +1,158 @@
+
+namespace ml {
+
+std::atomic<size_t> MemoryTracker::s_currentBytes[MEMORY_SUBSYSTEM_COUNT];
+std::atomic<size_t> MemoryTracker::s_peakBytes[MEMORY_SUBSYSTEM_COUNT];
+std::atomic<UINT64> MemoryTracker::s_allocations[MEMORY_SUBSYSTEM_COUNT];
+std::atomic<size_t> MemoryTracker::s_budgetBytes[MEMORY_SUBSYSTEM_COUNT];
+std::atomic<size_t> MemoryTracker::s_totalCurrentBytes;
+std::atomic<size_t> MemoryTracker::s_totalPeakBytes;
+MLIB_THREAD_LOCAL MemorySubsystem MemoryTracker::s_currentSubsystem = MEMORY_OTHER;
+
+void MemoryTracker::resetPeaks()
+{
+	for (UINT subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+		s_peakBytes[subsystem] = s_currentBytes[subsystem].load();
+	}
+	s_totalPeakBytes = s_totalCurrentBytes.load();
+}
+
+const char* MemoryTracker::getSubsystemName(MemorySubsystem subsystem)
+{
+	switch (subsystem) {
+	case MEMORY_OTHER:			return "other";
+	case MEMORY_MESH:			return "mesh";
+	case MEMORY_ACCELERATOR:	return "accelerator";
+	case MEMORY_GRID:			return "grid";
+	case MEMORY_IMAGE:			return "image";
+	case MEMORY_SENSOR_DATA:	return "sensor data";
+	default:					return "unknown";
+	}
+}
+
+std::vector<MemoryStatistics> MemoryTracker::getStatistics()
+{
+	std::vector<MemoryStatistics> statistics(MEMORY_SUBSYSTEM_COUNT);
+	for (UINT subsystem = 0; subsystem < MEMORY_SUBSYSTEM_COUNT; subsystem++) {
+		MemoryStatistics& s = statistics[subsystem];
+		s.subsystem = (MemorySubsystem)subsystem;
+		s.name = getSubsystemName(s.subsystem);
+		s.currentBytes = s_currentBytes[subsystem].load(std::memory_order_relaxed);
+		s.peakBytes = s_peakBytes[subsystem].load(std::memory_order_relaxed);
+		s.allocations = s_allocations[subsystem].load(std::memory_order_relaxed);
+		s.budgetBytes = s_budgetBytes[subsystem].load(std::memory_order_relaxed);
+	}
+	return statistics;
+}
+
+std::string MemoryTracker::getSummary()
+{
+	const double MB = 1024.0 * 1024.0;
+	std::stringstream out;
+	out << std::left << std::setw(16) << "subsystem" << std::right << std::setw(14) << "current MB" << std::setw(14) << "peak MB"
+		<< std::setw(14) << "allocations" << std::setw(14) << "budget MB" << std::endl;
+	out << std::fixed << std::setprecision(3);
+	for (const MemoryStatistics& s : getStatistics()) {
+		out << std::left << std::setw(16) << s.name << std::right << std::setw(14) << s.currentBytes / MB << std::setw(14) << s.peakBytes / MB
+			<< std::setw(14) << s.allocations;
+		if (s.budgetBytes > 0)	out << std::setw(14) << s.budgetBytes / MB << std::endl;
+		else					out << std::setw(14) << "-" << std::endl;
+	}
+	out << std::left << std::setw(16) << "total" << std::right << std::setw(14) << getTotalCurrentBytes() / MB << std::setw(14) << getTotalPeakBytes() / MB << std::endl;
+	return out.str();
+}
+
+} // namespace ml
+
+#ifdef MLIB_TRACK_MEMORY
+
+//
+// replacement of the global operator new/delete: every block starts with a header that stores its size and subsystem, so
+// it is released from the subsystem that was charged for it regardless of the scope in which it is deleted
+//
+namespace ml {
+
+struct MemoryBlockHeader
+{
+	size_t bytes;
+	MemorySubsystem subsystem;
+};
+static const size_t MemoryBlockHeaderSize = 16;		//! keeps the default new alignment
+static_assert(sizeof(MemoryBlockHeader) <= MemoryBlockHeaderSize, "header does not fit");
+
+static void* trackedAllocate(size_t bytes)
+{
+	const MemorySubsystem subsystem = MemoryTracker::getCurrentSubsystem();
+	MemoryTracker::recordAllocation(subsystem, bytes);
+	char* block = (char*)std::malloc(bytes + MemoryBlockHeaderSize);
+	if (block == nullptr) {
+		MemoryTracker::recordFree(subsystem, bytes);
+		throw std::bad_alloc();
+	}
+	MemoryBlockHeader* header = (MemoryBlockHeader*)block;
+	header->bytes = bytes;
+	header->subsystem = subsystem;
+	return block + MemoryBlockHeaderSize;
+}
+
+static void trackedFree(void* data)
+{
+	if (data == nullptr) return;
+	char* block = (char*)data - MemoryBlockHeaderSize;
+	const MemoryBlockHeader* header = (const MemoryBlockHeader*)block;
+	MemoryTracker::recordFree(header->subsystem, header->bytes);
+	std::free(block);
+}
+
+} // namespace ml
+
+void* operator new(size_t bytes)
+{
+	return ml::trackedAllocate(bytes);
+}
+void* operator new[](size_t bytes)
+{
+	return ml::trackedAllocate(bytes);
+}
+void* operator new(size_t bytes, const std::nothrow_t&) NOEXCEPT
+{
+	try {
+		return ml::trackedAllocate(bytes);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+void* operator new[](size_t bytes, const std::nothrow_t&) NOEXCEPT
+{
+	try {
+		return ml::trackedAllocate(bytes);
+	} catch (const std::bad_alloc&) {
+		return nullptr;
+	}
+}
+void operator delete(void* data) NOEXCEPT
+{
+	ml::trackedFree(data);
+}
+void operator delete[](void* data) NOEXCEPT
+{
+	ml::trackedFree(data);
+}
+void operator delete(void* data, size_t) NOEXCEPT
+{
+	ml::trackedFree(data);
+}
+void operator delete[](void* data, size_t) NOEXCEPT
+{
+	ml::trackedFree(data);
+}
+void operator delete(void* data, const std::nothrow_t&) NOEXCEPT
+{
+	ml::trackedFree(data);
+}
+void operator delete[](void* data, const std::nothrow_t&) NOEXCEPT
+{
+	ml::trackedFree(data);
+}
+
+#endif // MLIB_TRACK_MEMORY
@@ -0,0 +1,332 @@
+
+namespace ml {
+
+std::atomic<bool> Profiler::s_enabled(false);
+MLIB_THREAD_LOCAL ProfilerThread* Profiler::s_thread = nullptr;
+
+//! zones and threads of the process; created on first use, so zones in other static objects can register
+struct ProfilerState
+{
+	ProfilerState() {
+		maxEventsPerThread = 0;
+		startTicks = Profiler::getTicks();
+		startTime = Timer::getTime();
+#ifdef _WIN32
+		threadExitKey = FlsAlloc(releaseThread);
+#endif
+#ifdef LINUX
+		pthread_key_create(&threadExitKey, releaseThread);
+#endif
+	}
+
+	//! called on an exiting thread that recorded zones: its slot (with the recorded data) is reused by the next new thread
+#ifdef _WIN32
+	static void WINAPI releaseThread(void* thread);
+#else
+	static void releaseThread(void* thread);
+#endif
+
+	std::mutex mutex;
+	std::vector<const ProfilerZone*> zones;
+	std::vector<std::unique_ptr<ProfilerThread>> threads;	//! kept after the threads exit, so their data can still be summarized
+	std::vector<ProfilerThread*> freeThreads;				//! slots of exited threads; bounds the slots by the number of concurrent threads
+	size_t maxEventsPerThread;
+	UINT64 startTicks;
+	double startTime;
+#ifdef _WIN32
+	DWORD threadExitKey;
+#endif
+#ifdef LINUX
+	pthread_key_t threadExitKey;
+#endif
+};
+
+static ProfilerState& getProfilerState()
+{
+	//never destroyed, since threads may still exit (and release their slots) during static destruction
+	static ProfilerState* state = new ProfilerState();
+	return *state;
+}
+
+#ifdef _WIN32
+void WINAPI ProfilerState::releaseThread(void* thread)
+#else
+void ProfilerState::releaseThread(void* thread)
+#endif
+{
+	Profiler::s_thread = nullptr;
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.freeThreads.push_back((ProfilerThread*)thread);
+}
+
+ProfilerZone::ProfilerZone(const char* name, const char* file, int line)
+{
+	m_name = name;
+	m_file = file;
+	m_line = line;
+	m_id = Profiler::registerZone(this);
+}
+
+ProfilerThread::ProfilerThread(UINT threadIndex, size_t maxEvents)
+{
+	m_threadIndex = threadIndex;
+	m_depth = 0;
+	m_stack[0].node = 0;
+	m_stack[0].beginTicks = 0;
+	addNode(NoNode, NoNode);
+
+	m_maxEvents = maxEvents;
+	m_eventChunks.resize((maxEvents + EventChunkSize - 1) / EventChunkSize, nullptr);
+	m_eventCursor = nullptr;
+	m_eventChunkEnd = nullptr;
+	m_eventCount = 0;
+	m_droppedEvents = 0;
+}
+
+ProfilerThread::~ProfilerThread()
+{
+	for (Event* chunk : m_eventChunks) {
+		SAFE_DELETE_ARRAY(chunk);
+	}
+}
+
+UINT ProfilerThread::addNode(UINT zone, UINT parent)
+{
+	Node node;
+	node.zone = zone;
+	node.parent = parent;
+	node.firstChild = NoNode;
+	node.nextSibling = NoNode;
+	node.count = 0;
+	node.totalTicks = 0;
+	node.minTicks = std::numeric_limits<UINT64>::max();
+	node.maxTicks = 0;
+
+	const UINT index = (UINT)m_nodes.size();
+	if (parent != NoNode) {
+		node.nextSibling = m_nodes[parent].firstChild;
+		m_nodes[parent].firstChild = index;
+	}
+	m_nodes.push_back(node);
+	return index;
+}
+
+void ProfilerThread::reset()
+{
+	for (Node& node : m_nodes) {
+		node.count = 0;
+		node.totalTicks = 0;
+		node.minTicks = std::numeric_limits<UINT64>::max();
+		node.maxTicks = 0;
+	}
+	m_eventCursor = nullptr;
+	m_eventChunkEnd = nullptr;
+	m_eventCount = 0;
+	m_droppedEvents = 0;
+}
+
+bool ProfilerThread::nextEventChunk()
+{
+	const size_t index = m_eventCount.load(std::memory_order_relaxed);
+	if (index >= m_maxEvents) return false;
+	Event*& chunk = m_eventChunks[index / EventChunkSize];
+	if (chunk == nullptr) chunk = new Event[EventChunkSize];
+	const size_t chunkBegin = index - index % EventChunkSize;
+	m_eventCursor = chunk + (index - chunkBegin);
+	m_eventChunkEnd = chunk + std::min((size_t)EventChunkSize, m_maxEvents - chunkBegin);
+	return true;
+}
+
+UINT Profiler::registerZone(const ProfilerZone* zone)
+{
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.zones.push_back(zone);
+	return (UINT)state.zones.size() - 1;
+}
+
+ProfilerThread* Profiler::createThread()
+{
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	ProfilerThread* thread;
+	if (!state.freeThreads.empty()) {
+		thread = state.freeThreads.back();
+		state.freeThreads.pop_back();
+	} else {
+		state.threads.push_back(std::unique_ptr<ProfilerThread>(new ProfilerThread((UINT)state.threads.size(), state.maxEventsPerThread)));
+		thread = state.threads.back().get();
+	}
+#ifdef _WIN32
+	FlsSetValue(state.threadExitKey, thread);
+#endif
+#ifdef LINUX
+	pthread_setspecific(state.threadExitKey, thread);
+#endif
+	return thread;
+}
+
+void Profiler::setMaxEventsPerThread(size_t maxEventsPerThread)
+{
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.maxEventsPerThread = maxEventsPerThread;
+}
+
+double Profiler::getSecondsPerTick()
+{
+	const ProfilerState& state = getProfilerState();
+	double time = Timer::getTime();
+	while (time - state.startTime < 0.01) {
+		std::this_thread::yield();
+		time = Timer::getTime();
+	}
+	return (time - state.startTime) / (double)(getTicks() - state.startTicks);
+}
+
+std::vector<ProfilerZoneStatistics> Profiler::getZoneStatistics()
+{
+	return getZoneStatistics(getSecondsPerTick());
+}
+
+std::vector<ProfilerZoneStatistics> Profiler::getZoneStatistics(double secondsPerTick)
+{
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+
+	std::vector<ProfilerZoneStatistics> statistics(state.zones.size());
+	for (size_t zone = 0; zone < state.zones.size(); zone++) {
+		ProfilerZoneStatistics& s = statistics[zone];
+		s.name = state.zones[zone]->getName();
+		s.count = 0;
+		s.totalSeconds = 0.0;
+		s.minSeconds = std::numeric_limits<double>::max();
+		s.maxSeconds = 0.0;
+	}
+	for (const auto& thread : state.threads) {
+		for (const ProfilerThread::Node& node : thread->getNodes()) {
+			if (node.zone == ProfilerThread::NoNode || node.count == 0) continue;
+			ProfilerZoneStatistics& s = statistics[node.zone];
+			s.count += node.count;
+			s.totalSeconds += node.totalTicks * secondsPerTick;
+			s.minSeconds = std::min(s.minSeconds, node.minTicks * secondsPerTick);
+			s.maxSeconds = std::max(s.maxSeconds, node.maxTicks * secondsPerTick);
+		}
+	}
+
+	//zones that were never entered are left out
+	statistics.erase(std::remove_if(statistics.begin(), statistics.end(), [](const ProfilerZoneStatistics& s) { return s.count == 0; }), statistics.end());
+	std::stable_sort(statistics.begin(), statistics.end(), [](const ProfilerZoneStatistics& a, const ProfilerZoneStatistics& b) {
+		return a.totalSeconds > b.totalSeconds;
+	});
+	return statistics;
+}
+
+//! appends a line of the zone table: name, count, total ms, min, mean and max us
+static void appendZoneLine(std::ostream& out, const std::string& name, UINT64 count, double totalSeconds, double minSeconds, double maxSeconds)
+{
+	out << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(10) << count << std::setw(12) << totalSeconds * 1e3 << std::setw(12) << minSeconds * 1e6
+		<< std::setw(12) << totalSeconds * 1e6 / (double)std::max(count, (UINT64)1) << std::setw(12) << maxSeconds * 1e6 << std::endl;
+}
+
+//! appends a call tree node and (sorted by decreasing total time) its children
+static void appendCallTree(std::ostream& out, const ProfilerThread& thread, const std::vector<const ProfilerZone*>& zones, UINT nodeIndex, UINT depth, double secondsPerTick)
+{
+	const std::vector<ProfilerThread::Node>& nodes = thread.getNodes();
+	const ProfilerThread::Node& node = nodes[nodeIndex];
+	if (node.zone != ProfilerThread::NoNode) {
+		if (node.count == 0) return;
+		appendZoneLine(out, std::string(2 * depth, ' ') + zones[node.zone]->getName(), node.count,
+			node.totalTicks * secondsPerTick, node.minTicks * secondsPerTick, node.maxTicks * secondsPerTick);
+	}
+
+	std::vector<UINT> children;
+	for (UINT child = node.firstChild; child != ProfilerThread::NoNode; child = nodes[child].nextSibling) {
+		children.push_back(child);
+	}
+	std::stable_sort(children.begin(), children.end(), [&](UINT a, UINT b) { return nodes[a].totalTicks > nodes[b].totalTicks; });
+	for (UINT child : children) {
+		appendCallTree(out, thread, zones, child, node.zone == ProfilerThread::NoNode ? depth : depth + 1, secondsPerTick);
+	}
+}
+
+std::string Profiler::getSummary()
+{
+	const double secondsPerTick = getSecondsPerTick();
+	std::stringstream out;
+	out << "zones" << std::endl;
+	out << std::left << std::setw(40) << "name" << std::right << std::setw(10) << "count" << std::setw(12) << "total ms"
+		<< std::setw(12) << "min us" << std::setw(12) << "mean us" << std::setw(12) << "max us" << std::endl;
+	for (const ProfilerZoneStatistics& s : getZoneStatistics(secondsPerTick)) {
+		appendZoneLine(out, s.name, s.count, s.totalSeconds, s.minSeconds, s.maxSeconds);
+	}
+
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	for (const auto& thread : state.threads) {
+		out << std::endl << "thread " << thread->getThreadIndex();
+		if (thread->getDroppedEventCount() > 0) out << " (" << thread->getDroppedEventCount() << " trace events dropped)";
+		out << std::endl;
+		appendCallTree(out, *thread, state.zones, 0, 0, secondsPerTick);
+	}
+	return out.str();
+}
+
+//! escapes a zone name for a JSON string
+static std::string escapeJSON(const char* s)
+{
+	std::string result;
+	for (; *s; s++) {
+		if (*s == '"' || *s == '\\') result += '\\';
+		if ((unsigned char)*s >= 0x20) result += *s;
+	}
+	return result;
+}
+
+std::string Profiler::getChromeTrace()
+{
+	const double secondsPerTick = getSecondsPerTick();
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+
+	std::stringstream out;
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << std::endl;
+	for (size_t t = 0; t < state.threads.size(); t++) {
+		const ProfilerThread& thread = *state.threads[t];
+		const UINT tid = thread.getThreadIndex();
+		out << (t == 0 ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+
+		const size_t eventCount = thread.getEventCount();
+		for (size_t i = 0; i < eventCount; i++) {
+			const ProfilerThread::Event& e = thread.getEvent(i);
+			//timestamps in microseconds since the profiler was first used
+			const double begin = (double)(INT64)(e.beginTicks - state.startTicks) * secondsPerTick * 1e6;
+			const double duration = (double)(e.endTicks - e.beginTicks) * secondsPerTick * 1e6;
+			out << ",\n{\"name\":\"" << escapeJSON(state.zones[e.zone]->getName()) << "\",\"cat\":\"mLib\",\"ph\":\"X\",\"ts\":" << begin
+				<< ",\"dur\":" << duration << ",\"pid\":0,\"tid\":" << tid << "}";
+		}
+	}
+	out << std::endl << "]}" << std::endl;
+	return out.str();
+}
+
+void Profiler::saveChromeTrace(const std::string& filename)
+{
+	std::ofstream file(filename);
+	if (!file.is_open()) throw MLIB_EXCEPTION("could not open file " + filename);
+	file << getChromeTrace();
+}
+
+void Profiler::reset()
+{
+	ProfilerState& state = getProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	for (const auto& thread : state.threads) {
+		thread->reset();
+	}
+}
+
+} // namespace ml
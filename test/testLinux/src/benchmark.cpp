@@ -0,0 +1,295 @@
+
+#include "mLibCore.h"
+
+using namespace ml;
+using namespace std;
+
+//
+// benchmarks of mLib hot paths on deterministic synthetic inputs; every benchmark is repeated and reported with its median
+// time and throughput, as a table on the console and as JSON (--json file) for tracking over time.
+//
+// usage: mLibBenchmark [--json file] [--filter substring] [--repetitions n] [--scale s]
+//
+
+struct BenchmarkResult
+{
+	string name;
+	string unit;			//what the items are (triangles, rays, ...)
+	double items;			//processed per run
+	vector<double> seconds;	//one per repetition
+
+	double median() const {
+		vector<double> s = seconds;
+		sort(s.begin(), s.end());
+		return s.size() % 2 == 1 ? s[s.size() / 2] : 0.5 * (s[s.size() / 2 - 1] + s[s.size() / 2]);
+	}
+	double minimum() const {
+		return *min_element(seconds.begin(), seconds.end());
+	}
+	double maximum() const {
+		return *max_element(seconds.begin(), seconds.end());
+	}
+};
+
+class BenchmarkSuite
+{
+public:
+	BenchmarkSuite(const string& filter, UINT repetitions) : m_filter(filter), m_repetitions(repetitions) {}
+
+	//! times run (after an untimed warm-up run); setup is called before every run and not timed
+	void add(const string& name, const string& unit, double items, const function<void()>& setup, const function<void()>& run) {
+		if (!m_filter.empty() && name.find(m_filter) == string::npos) return;
+
+		BenchmarkResult result;
+		result.name = name;
+		result.unit = unit;
+		result.items = items;
+		for (UINT repetition = 0; repetition <= m_repetitions; repetition++) {
+			setup();
+			Timer timer;
+			run();
+			const double seconds = timer.getElapsedTime();
+			if (repetition > 0) result.seconds.push_back(seconds);
+		}
+		cout << left << setw(36) << name << right << fixed << setprecision(3) << setw(12) << result.median() * 1e3 << " ms"
+			<< setw(16) << setprecision(0) << result.items / result.median() << " " << unit << "/s" << endl;
+		m_results.push_back(result);
+	}
+
+	void add(const string& name, const string& unit, double items, const function<void()>& run) {
+		add(name, unit, items, []() {}, run);
+	}
+
+	void saveJSON(const string& filename, double scale) const {
+		ofstream out(filename);
+		if (!out.is_open()) throw MLIB_EXCEPTION("could not open file " + filename);
+		out << setprecision(9);
+		out << "{" << endl;
+		out << "  \"suite\": \"mLib\"," << endl;
+		out << "  \"timestamp\": " << (UINT64)time(nullptr) << "," << endl;
+		out << "  \"compiler\": \"" << __VERSION__ << "\"," << endl;
+		out << "  \"threads\": " << thread::hardware_concurrency() << "," << endl;
+		out << "  \"scale\": " << scale << "," << endl;
+		out << "  \"repetitions\": " << m_repetitions << "," << endl;
+		out << "  \"benchmarks\": [" << endl;
+		for (size_t i = 0; i < m_results.size(); i++) {
+			const BenchmarkResult& r = m_results[i];
+			out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", \"items\": " << r.items
+				<< ", \"median_seconds\": " << r.median() << ", \"min_seconds\": " << r.minimum() << ", \"max_seconds\": " << r.maximum()
+				<< ", \"items_per_second\": " << r.items / r.median() << "}" << (i + 1 < m_results.size() ? "," : "") << endl;
+		}
+		out << "  ]" << endl;
+		out << "}" << endl;
+	}
+
+private:
+	string m_filter;
+	UINT m_repetitions;
+	vector<BenchmarkResult> m_results;
+};
+
+//! keeps results alive, so the compiler cannot remove the benchmarked work
+static volatile double g_sink = 0.0;
+
+//! random symmetric, diagonally dominant (thus positive definite) system with about 7 entries per row
+static SparseMatrixd randomSystem(UINT n, RNG& rng)
+{
+	SparseMatrixd A(n);
+	vector<double> diagonal(n, 1.0);
+	for (UINT row = 0; row < n; row++) {
+		const UINT offsets[] = { 1, 37, (UINT)rng.uniform(2u, n / 2) };
+		for (UINT offset : offsets) {
+			const UINT col = (row + offset) % n;
+			if (col == row || A(row, col) != 0.0) continue;
+			const double value = -rng.uniform(0.1, 1.0);
+			A(row, col) = value;
+			A(col, row) = value;
+			diagonal[row] -= value;
+			diagonal[col] -= value;
+		}
+	}
+	for (UINT row = 0; row < n; row++) A(row, row) = diagonal[row];
+	return A;
+}
+
+//! mean of the 6-neighborhood of the interior cells (as in the relaxation of DistanceField3::improveDF)
+template<class Layout>
+static void smoothGrid(const Grid3<float, Layout>& src, Grid3<float, Layout>& dst, const vec3ul& min, const vec3ul& max)
+{
+	for (size_t z = std::max(min.z, (size_t)1); z < std::min(max.z, src.getDimZ() - 1); z++) {
+		for (size_t y = std::max(min.y, (size_t)1); y < std::min(max.y, src.getDimY() - 1); y++) {
+			for (size_t x = std::max(min.x, (size_t)1); x < std::min(max.x, src.getDimX() - 1); x++) {
+				dst(x, y, z) = (src(x - 1, y, z) + src(x + 1, y, z) + src(x, y - 1, z) + src(x, y + 1, z) + src(x, y, z - 1) + src(x, y, z + 1)) * (1.0f / 6.0f);
+			}
+		}
+	}
+}
+
+//! 7-point stencil over a grid of the given layout, once in scanline order and once block by block
+template<class Layout>
+static void addGridStencilBenchmarks(BenchmarkSuite& suite, const string& layoutName, size_t dim)
+{
+	Grid3<float, Layout> src(dim, dim, dim, [](size_t x, size_t y, size_t z) { return (float)((x * 7 + y * 13 + z * 29) % 101); });
+	Grid3<float, Layout> dst(dim, dim, dim, 0.0f);
+	suite.add("grid stencil scanline (" + layoutName + ")", "voxels", (double)(dim * dim * dim), [&]() {
+		smoothGrid(src, dst, vec3ul(0, 0, 0), src.getDimensions());
+		g_sink += dst(dim / 2, dim / 2, dim / 2);
+	});
+	suite.add("grid stencil blocks (" + layoutName + ")", "voxels", (double)(dim * dim * dim), [&]() {
+		for (const auto& block : src.getBlocks()) {
+			smoothGrid(src, dst, block.min, block.max);
+		}
+		g_sink += dst(dim / 2, dim / 2, dim / 2);
+	});
+}
+
+int main(int argc, char** argv)
+{
+	string jsonFile, filter;
+	UINT repetitions = 5;
+	double scale = 1.0;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const string option = argv[i];
+		if (option == "--json") jsonFile = argv[i + 1];
+		else if (option == "--filter") filter = argv[i + 1];
+		else if (option == "--repetitions") repetitions = max(1u, util::convertTo<UINT>(argv[i + 1]));
+		else if (option == "--scale") scale = util::convertTo<double>(argv[i + 1]);
+		else {
+			cout << "usage: mLibBenchmark [--json file] [--filter substring] [--repetitions n] [--scale s]" << endl;
+			return 1;
+		}
+	}
+	auto scaled = [scale](double n) { return max((size_t)1, (size_t)(n * scale)); };
+	BenchmarkSuite suite(filter, repetitions);
+
+	//meshes
+	const UINT sphereResolution = (UINT)scaled(400);
+	TriMeshf sphere = Shapesf::sphere(1.0f, vec3f::origin, sphereResolution, sphereResolution);
+	TriMeshf torus = Shapesf::torus(vec3f::origin, 1.0f, 0.3f, (UINT)scaled(400), (UINT)scaled(200));
+	MeshDataf torusData = torus.computeMeshData();
+
+	suite.add("bvh build sah (sphere)", "triangles", (double)sphere.getIndices().size(), [&]() {
+		TriMeshAcceleratorBVHf bvh(sphere, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		g_sink += bvh.intersect(Rayf(vec3f(0.0f, 0.0f, 3.0f), vec3f(0.0f, 0.0f, -1.0f))).t;
+	});
+	suite.add("bvh build median (torus)", "triangles", (double)torus.getIndices().size(), [&]() {
+		TriMeshAcceleratorBVHf bvh(torus, false, TriMeshAcceleratorBVHf::BUILD_MEDIAN);
+		g_sink += bvh.intersect(Rayf(vec3f(0.0f, 0.0f, 3.0f), vec3f(0.0f, 0.0f, -1.0f))).t;
+	});
+
+	{
+		TriMeshAcceleratorBVHf bvh(torus, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		RNG rng(1);
+		vector<Rayf> rays(scaled(200000));
+		for (Rayf& r : rays) {
+			const vec3f origin(rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 2.0f), 3.0f);
+			const vec3f target(rng.uniform(-1.5f, 1.5f), rng.uniform(-1.5f, 1.5f), rng.uniform(-0.3f, 0.3f));
+			r = Rayf(origin, (target - origin).getNormalized());
+		}
+		suite.add("bvh ray query (torus)", "rays", (double)rays.size(), [&]() {
+			size_t hits = 0;
+			for (const Rayf& r : rays) {
+				TriMeshRayAcceleratorf::Intersection intersection;
+				if (bvh.intersect(r, intersection)) hits++;
+			}
+			g_sink += (double)hits;
+		});
+	}
+
+	const string meshFile = "benchmark_mesh.ply";
+	suite.add("mesh save ply (torus)", "vertices", (double)torusData.m_Vertices.size(), [&]() {
+		MeshIOf::saveToFile(meshFile, torusData);
+	});
+	suite.add("mesh load ply (torus)", "vertices", (double)torusData.m_Vertices.size(), [&]() {
+		MeshDataf loaded = MeshIOf::loadFromFile(meshFile);
+		g_sink += (double)loaded.m_Vertices.size();
+	});
+	remove(meshFile.c_str());
+
+	{
+		MeshDataf merged;
+		suite.add("mergeCloseVertices (torus)", "vertices", (double)torusData.m_Vertices.size(), [&]() { merged = torusData; }, [&]() {
+			g_sink += merged.mergeCloseVertices(0.001f);
+		});
+	}
+
+	{
+		TriMeshAcceleratorBVHf bvh(torus, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		const size_t dim = scaled(64);
+		const mat4f worldToVoxel = mat4f::translation(0.5f * (float)(dim - 1), 0.5f * (float)(dim - 1), 0.5f * (float)(dim - 1)) * mat4f::scale((float)(dim - 1) / 2.8f);
+		DistanceField3f field(dim, dim, dim);
+		suite.add("distance field from mesh (torus)", "voxels", (double)(dim * dim * dim), [&]() {
+			field.generateFromMesh(bvh, worldToVoxel, 4.0f);
+			g_sink += field(0, 0, 0);
+		});
+
+		auto voxels = torus.voxelize(2.8f / (float)dim, BoundingBox3f(vec3f(-1.4f, -1.4f, -1.4f), vec3f(1.4f, 1.4f, 1.4f)));
+		suite.add("distance field from grid (torus)", "voxels", (double)voxels.first.getNumElements(), [&]() {
+			DistanceField3f fromGrid(voxels.first, 4.0f);
+			g_sink += fromGrid(0, 0, 0);
+		});
+	}
+
+	{
+		RNG rng(2);
+		vector<vec3f> points(scaled(20000));
+		for (vec3f& p : points) p = vec3f(rng.uniform(0.0f, 1.0f), rng.uniform(0.0f, 1.0f), rng.uniform(0.0f, 1.0f));
+		vector<const float*> pointPointers;
+		for (const vec3f& p : points) pointPointers.push_back(&p.x);
+		NearestNeighborSearchBruteForce<float> search;
+		search.init(pointPointers, 3, 8);
+		vector<vec3f> queries(scaled(1000));
+		for (vec3f& q : queries) q = vec3f(rng.uniform(0.0f, 1.0f), rng.uniform(0.0f, 1.0f), rng.uniform(0.0f, 1.0f));
+		suite.add("knn brute force (k = 8)", "queries", (double)queries.size(), [&]() {
+			vector<UINT> result;
+			for (const vec3f& q : queries) {
+				search.kNearest(&q.x, 8, 0.0f, result);
+				g_sink += result[0];
+			}
+		});
+	}
+
+	{
+		RNG rng(3);
+		const UINT n = (UINT)scaled(20000);
+		const SparseMatrixd A = randomSystem(n, rng);
+		MathVector<double> b(n);
+		for (double& v : b) v = rng.uniform(-1.0, 1.0);
+		suite.add("sparse cg solve", "rows", (double)n, [&]() {
+			LinearSolverConjugateGradient<double> solver(1000, 1e-8);
+			const MathVector<double> x = solver.solve(A, b);
+			g_sink += x[0];
+		});
+	}
+
+	{
+		//the same stencil in every memory layout of Grid3
+		const size_t dim = scaled(192);
+		addGridStencilBenchmarks<Grid3LayoutLinear>(suite, "linear", dim);
+		addGridStencilBenchmarks<Grid3LayoutTiled4>(suite, "tiled 4", dim);
+		addGridStencilBenchmarks<Grid3LayoutTiled8>(suite, "tiled 8", dim);
+		addGridStencilBenchmarks<Grid3LayoutMorton>(suite, "morton", dim);
+	}
+
+	{
+		//mip chain by successive halving with BaseImage::getResized
+		const UINT size = (UINT)scaled(2048);
+		ColorImageR32G32B32A32 image(size, size);
+		for (UINT y = 0; y < size; y++) {
+			for (UINT x = 0; x < size; x++) image(x, y) = vec4f((float)(x % 256) / 255.0f, (float)(y % 256) / 255.0f, (float)((x ^ y) % 256) / 255.0f, 1.0f);
+		}
+		suite.add("image mipmaps", "pixels", (double)size * size, [&]() {
+			ColorImageR32G32B32A32 level = image;
+			while (level.getWidth() > 1 || level.getHeight() > 1) {
+				level = level.getResized(max(1u, level.getWidth() / 2), max(1u, level.getHeight() / 2));
+			}
+			g_sink += level(0u, 0u).x;
+		});
+	}
+
+	if (!jsonFile.empty()) {
+		suite.saveJSON(jsonFile, scale);
+		cout << "results saved to " << jsonFile << endl;
+	}
+	return 0;
+}
@@ -12,7 +12,15 @@ class App
 public:
 	void go() {
 		m_grid.run();
+		m_gridLayout.run();
 		m_binaryStream.run();
+		m_bvh.run();
+		m_collision.run();
+		m_multithreading.run();
+		m_profiler.run();
+		m_memoryTracker.run();
+		m_tsdf.run();
+		m_marchingCubes.run();
 
 		//m_box.run();
 		//m_cgal.run();
@@ -27,12 +35,20 @@ public:
 
 private:
 	TestGrid m_grid;
+	TestGridLayout m_gridLayout;
 	TestBox m_box;
 	TestCGAL m_cgal;	
 	TestUtility m_utility;
 	TestLodePNG m_lodePNG;
 	TestBinaryStream m_binaryStream;
 	TestOpenMesh m_openMesh;
+	TestBVH m_bvh;
+	TestCollision m_collision;
+	TestMultithreading m_multithreading;
+	TestProfiler m_profiler;
+	TestMemoryTracker m_memoryTracker;
+	TestTSDF m_tsdf;
+	TestMarchingCubes m_marchingCubes;
 };
 
 int main()
@@ -9,5 +9,13 @@
 #include "testLodePNG.h"
 #include "testBinaryStream.h"
 #include "testGrid.h"
+#include "testGridLayout.h"
+#include "testBVH.h"
+#include "testCollision.h"
+#include "testMultithreading.h"
+#include "testProfiler.h"
+#include "testMemoryTracker.h"
+#include "testTSDF.h"
+#include "testMarchingCubes.h"
 #include "testOpenMesh.h"
 #include "testCGAL.h"
\ No newline at end of file
@@ -0,0 +1,503 @@
+
+class TestBVH : public Test
+{
+public:
+	//! compares a ray accelerator against brute force intersection on random rays
+	template<class Accelerator>
+	static void compareToBruteForce(const Accelerator& accel, const TriMeshAcceleratorBruteForcef& bruteForce, unsigned int numRays = 1000)
+	{
+		RNG rng;
+		for (unsigned int i = 0; i < numRays; i++) {
+			vec3f o(rng.uniform(-3.0f, 3.0f), rng.uniform(-3.0f, 3.0f), rng.uniform(-3.0f, 3.0f));
+			vec3f d(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f));
+			Rayf r(o, d);
+
+			TriMeshRayAcceleratorf::Intersection a = accel.intersect(r);
+			TriMeshRayAcceleratorf::Intersection b = bruteForce.intersect(r);
+			MLIB_ASSERT_STR(a.isValid() == b.isValid(), "hit mismatch");
+			if (a.isValid()) {
+				MLIB_ASSERT_STR(math::floatEqual(a.t, b.t), "distance mismatch");
+			}
+
+			//the any-hit query must agree with the closest hit (with a margin around the closest distance)
+			if (a.isValid() && a.t > 0.01f) {
+				MLIB_ASSERT_STR(!accel.occluded(r, 0.0f, a.t * 0.99f), "occlusion before the closest hit");
+				MLIB_ASSERT_STR(accel.occluded(r, 0.0f, a.t * 1.01f), "occlusion mismatch");
+			}
+			else if (!a.isValid()) {
+				MLIB_ASSERT_STR(!accel.occluded(r), "occlusion without hit");
+			}
+		}
+	}
+
+	void test0()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 64, 64);
+		TriMeshf torus = Shapesf::torus(vec3f(0.5f, 0.0f, 0.0f), 1.0f, 0.25f, 64, 32);
+		std::vector<const TriMeshf*> meshes;
+		meshes.push_back(&sphere);
+		meshes.push_back(&torus);
+
+		TriMeshAcceleratorBruteForcef bruteForce;
+		bruteForce.build(meshes);
+
+		TriMeshAcceleratorBVHf median(TriMeshAcceleratorBVHf::BUILD_MEDIAN);
+		median.build(meshes);
+		compareToBruteForce(median, bruteForce);
+
+		TriMeshAcceleratorBVHf midpoint(TriMeshAcceleratorBVHf::BUILD_MIDPOINT);
+		midpoint.build(meshes);
+		compareToBruteForce(midpoint, bruteForce);
+
+		TriMeshAcceleratorBVHf sah(TriMeshAcceleratorBVHf::BUILD_SAH);
+		sah.build(meshes);
+		compareToBruteForce(sah, bruteForce);
+
+		MLIB_ASSERT_STR(sah.computeSAHCost() < median.computeSAHCost(), "SAH build should have a lower expected cost");
+
+		//a planar mesh (zero extent along z) with the triangles in random order: the midpoint split must choose x or y
+		std::vector<vec3f> planeVertices;
+		std::vector<unsigned int> planeIndices;
+		const unsigned int planeSize = 64;
+		for (unsigned int y = 0; y <= planeSize; y++) {
+			for (unsigned int x = 0; x <= planeSize; x++) {
+				planeVertices.push_back(vec3f((float)x / planeSize * 4.0f - 2.0f, (float)y / planeSize * 4.0f - 2.0f, 0.0f));
+			}
+		}
+		std::vector<vec3ui> planeTriangles;
+		for (unsigned int y = 0; y < planeSize; y++) {
+			for (unsigned int x = 0; x < planeSize; x++) {
+				const unsigned int i = y * (planeSize + 1) + x;
+				planeTriangles.push_back(vec3ui(i, i + 1, i + planeSize + 2));
+				planeTriangles.push_back(vec3ui(i, i + planeSize + 2, i + planeSize + 1));
+			}
+		}
+		std::mt19937 shuffleEngine(9);
+		std::shuffle(planeTriangles.begin(), planeTriangles.end(), shuffleEngine);
+		for (const vec3ui& t : planeTriangles) {
+			planeIndices.push_back(t.x);
+			planeIndices.push_back(t.y);
+			planeIndices.push_back(t.z);
+		}
+		TriMeshf plane(planeVertices, planeIndices);
+		TriMeshAcceleratorBruteForcef planeBruteForce(plane);
+		TriMeshAcceleratorBVHf planeMidpoint(plane, false, TriMeshAcceleratorBVHf::BUILD_MIDPOINT);
+		TriMeshAcceleratorBVHf planeSAH(plane, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		compareToBruteForce(planeMidpoint, planeBruteForce);
+		MLIB_ASSERT_STR(planeMidpoint.computeSAHCost() < 2.0f * planeSAH.computeSAHCost(), "midpoint split of a planar mesh is not spatial");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test1()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 64, 64);
+		TriMeshf box = Shapesf::box(BoundingBox3f(vec3f(-0.25f, -0.25f, 0.5f), vec3f(0.25f, 0.25f, 1.5f)));
+		std::vector<const TriMeshf*> meshes;
+		meshes.push_back(&sphere);
+		meshes.push_back(&box);
+
+		TriMeshAcceleratorBruteForcef bruteForce;
+		bruteForce.build(meshes);
+
+		TriMeshAcceleratorLinearBVHf linear;
+		linear.build(meshes);
+		compareToBruteForce(linear, bruteForce);
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test2()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 64, 64);
+		TriMeshAcceleratorLinearBVHf linear(sphere);
+
+		//pinhole camera rays (coherent packets) followed by random rays (diverging packets)
+		std::vector<Rayf> rays;
+		const int width = 64, height = 48;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				rays.push_back(Rayf(vec3f(0.0f, 0.0f, -4.0f), vec3f((float)(x - width / 2) / 32.0f, (float)(y - height / 2) / 32.0f, 1.0f)));
+			}
+		}
+		RNG rng;
+		for (unsigned int i = 0; i < 1001; i++) {
+			rays.push_back(Rayf(vec3f(rng.uniform(-3.0f, 3.0f), rng.uniform(-3.0f, 3.0f), rng.uniform(-3.0f, 3.0f)), vec3f(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f))));
+		}
+
+		std::vector<TriMeshRayAcceleratorf::Intersection> results = linear.intersect(rays);
+		MLIB_ASSERT_STR(results.size() == rays.size(), "batch size mismatch");
+		for (size_t i = 0; i < rays.size(); i++) {
+			TriMeshRayAcceleratorf::Intersection single = linear.intersect(rays[i]);
+			MLIB_ASSERT_STR(single.isValid() == results[i].isValid(), "batch hit mismatch");
+			if (single.isValid()) {
+				MLIB_ASSERT_STR(math::floatEqual(single.t, results[i].t), "batch distance mismatch");
+			}
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test3()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 32, 32);
+		TriMeshf box = Shapesf::box(BoundingBox3f(vec3f(-0.25f, -0.25f, 1.5f), vec3f(0.25f, 0.25f, 2.5f)));
+		std::vector<const TriMeshf*> meshes;
+		meshes.push_back(&sphere);
+		meshes.push_back(&box);
+
+		TriMeshAcceleratorBVHf bvh(TriMeshAcceleratorBVHf::BUILD_SAH);
+		bvh.build(meshes);
+
+		RNG rng;
+		std::vector<vec3f> points;
+		for (unsigned int i = 0; i < 500; i++) {
+			points.push_back(vec3f(rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 3.0f)));
+		}
+		std::vector<TriMeshAcceleratorBVHf::ClosestPoint> results;
+		bvh.closestPoints(points, results, true);
+
+		for (size_t i = 0; i < points.size(); i++) {
+			const vec3f& p = points[i];
+			float distSq = std::numeric_limits<float>::max();
+			for (const TriMeshf* mesh : meshes) {
+				for (const vec3ui& tri : mesh->getIndices()) {
+					distSq = std::min(distSq, math::trianglePointDistSq(mesh->getVertices()[tri.x].position, mesh->getVertices()[tri.y].position, mesh->getVertices()[tri.z].position, p));
+				}
+			}
+			MLIB_ASSERT_STR(results[i].isValid() && math::floatEqual(std::abs(results[i].distance), std::sqrt(distSq)), "closest point distance mismatch");
+			MLIB_ASSERT_STR(vec3f::dist(results[i].position, results[i].triangle->getSurfacePosition(results[i].u, results[i].v)) < 1e-4f, "barycentric mismatch");
+
+			const bool inside = p.length() < 1.0f || (std::abs(p.x) < 0.25f && std::abs(p.y) < 0.25f && p.z > 1.5f && p.z < 2.5f);
+			if (std::abs(results[i].distance) > 0.05f) {
+				MLIB_ASSERT_STR((results[i].distance < 0.0f) == inside, "wrong distance sign");
+			}
+		}
+
+		//distance field of the sphere in voxel units (10 voxels per unit)
+		DistanceField3f df(40, 40, 40);
+		df.generateFromMesh(TriMeshAcceleratorBVHf(sphere, false, TriMeshAcceleratorBVHf::BUILD_SAH), mat4f::scale(10.0f) * mat4f::translation(vec3f(2.0f, 2.0f, 2.0f)), 5.0f, true);
+		for (size_t z = 0; z < df.getDimZ(); z += 3) {
+			for (size_t y = 0; y < df.getDimY(); y += 3) {
+				for (size_t x = 0; x < df.getDimX(); x += 3) {
+					const float expected = math::clamp((vec3f((float)x, (float)y, (float)z) / 10.0f - 2.0f).length() * 10.0f - 10.0f, -5.0f, 5.0f);
+					MLIB_ASSERT_STR(std::abs(df(x, y, z) - expected) < 0.1f, "distance field mismatch");
+				}
+			}
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test4()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 32, 32);
+		TriMeshAcceleratorBVHf direct(sphere, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorBVHf local(sphere, true, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorLinearBVHf linear(sphere);
+
+		//deform the mesh in place and refit
+		for (auto& v : sphere.getVertices()) {
+			v.position = v.position * (1.0f + 0.5f * std::sin(3.0f * v.position.x)) + vec3f(v.position.y * v.position.y, 0.0f, 0.0f);
+		}
+		direct.refit();
+		local.refit(sphere);
+		linear.refit();
+
+		TriMeshAcceleratorBruteForcef bruteForce(sphere);
+		compareToBruteForce(direct, bruteForce);
+		compareToBruteForce(local, bruteForce);
+		compareToBruteForce(linear, bruteForce);
+
+		MLIB_ASSERT_STR(direct.computeSAHCostRatio() > 1.0f, "refitted tree should be worse than a fresh build");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test5()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 16, 16);
+		TriMeshf torus = Shapesf::torus(vec3f(0.0f, 0.0f, 0.0f), 1.0f, 0.25f, 16, 8);
+		TriMeshAcceleratorBVHf sphereBVH(sphere, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorBVHf torusBVH(torus, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+
+		//random instances with non-uniform scaling; the reference is a single BVH over all transformed meshes
+		RNG rng;
+		TriMeshInstanceAcceleratorf instances;
+		std::vector<std::pair<const TriMeshf*, mat4f>> worldMeshes;
+		std::vector<std::pair<const TriMeshAcceleratorBVHf*, mat4f>> invTransformed;
+		for (unsigned int i = 0; i < 50; i++) {
+			const mat4f objectToWorld = mat4f::translation(vec3f(rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f), rng.uniform(-5.0f, 5.0f))) * mat4f::rotationY(rng.uniform(0.0f, 360.0f)) * mat4f::scale(vec3f(rng.uniform(0.3f, 2.0f), rng.uniform(0.3f, 2.0f), rng.uniform(0.3f, 2.0f)));
+			const TriMeshAcceleratorBVHf* accel = (i % 2 == 0) ? &sphereBVH : &torusBVH;
+			instances.addInstance(accel, objectToWorld);
+			worldMeshes.push_back(std::make_pair((i % 2 == 0) ? &sphere : &torus, objectToWorld));
+			invTransformed.push_back(std::make_pair(accel, objectToWorld.getInverse()));
+		}
+		instances.build();
+		TriMeshAcceleratorBVHf reference(TriMeshAcceleratorBVHf::BUILD_SAH);
+		reference.build(worldMeshes);
+
+		for (unsigned int i = 0; i < 1000; i++) {
+			Rayf r(vec3f(rng.uniform(-8.0f, 8.0f), rng.uniform(-8.0f, 8.0f), -10.0f), vec3f(rng.uniform(-0.5f, 0.5f), rng.uniform(-0.5f, 0.5f), 1.0f));
+			TriMeshRayAcceleratorf::Intersection expected = reference.intersect(r);
+			TriMeshInstanceAcceleratorf::Intersection a = instances.intersect(r);
+			UINT objectIndex;
+			TriMeshRayAcceleratorf::Intersection b = TriMeshRayAcceleratorf::getFirstIntersectionTransform(r, invTransformed, objectIndex);
+			MLIB_ASSERT_STR(a.isValid() == expected.isValid() && b.isValid() == expected.isValid(), "instance hit mismatch");
+			MLIB_ASSERT_STR(instances.occluded(r) == expected.isValid(), "instance occlusion mismatch");
+			if (expected.isValid()) {
+				MLIB_ASSERT_STR(std::abs(a.t - expected.t) < 1e-3f * expected.t && std::abs(b.t - expected.t) < 1e-3f * expected.t, "world space distance mismatch");
+				MLIB_ASSERT_STR(a.getInstanceIndex() == expected.getMeshIndex() && objectIndex == expected.getMeshIndex(), "instance index mismatch");
+			}
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test6()
+	{
+		//large enough for the data-parallel partitioning of the upper levels
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 256, 256);
+		TriMeshf torus = Shapesf::torus(vec3f(0.5f, 0.0f, 0.0f), 1.0f, 0.25f, 64, 32);
+		std::vector<const TriMeshf*> meshes;
+		meshes.push_back(&sphere);
+		meshes.push_back(&torus);
+
+		//the parallel partitioning orders ties differently than the serial one, so only the SAH build (which does not depend on the order) has to give the same tree;
+		//all builds must be deterministic and find the same hits
+		const TriMeshAcceleratorBVHf::BuildMode modes[] = { TriMeshAcceleratorBVHf::BUILD_MEDIAN, TriMeshAcceleratorBVHf::BUILD_MIDPOINT, TriMeshAcceleratorBVHf::BUILD_SAH };
+		for (auto mode : modes) {
+			TriMeshAcceleratorBVHf serial(mode);
+			serial.setNumBuildThreads(1);
+			serial.build(meshes);
+			TriMeshAcceleratorBVHf parallel(mode);
+			parallel.setNumBuildThreads(4);
+			parallel.build(meshes);
+			TriMeshAcceleratorBVHf parallel2(mode);
+			parallel2.setNumBuildThreads(4);
+			parallel2.build(meshes);
+			MLIB_ASSERT_STR(parallel.computeSAHCost() == parallel2.computeSAHCost(), "parallel build is not deterministic");
+			if (mode == TriMeshAcceleratorBVHf::BUILD_SAH) {
+				MLIB_ASSERT_STR(serial.computeSAHCost() == parallel.computeSAHCost(), "parallel build differs from serial build");
+			}
+
+			RNG rng;
+			for (unsigned int i = 0; i < 1000; i++) {
+				Rayf r(vec3f(rng.uniform(-3.0f, 3.0f), rng.uniform(-3.0f, 3.0f), -3.0f), vec3f(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), 1.0f));
+				TriMeshRayAcceleratorf::Intersection a = serial.intersect(r);
+				TriMeshRayAcceleratorf::Intersection b = parallel.intersect(r);
+				MLIB_ASSERT_STR(a.isValid() == b.isValid() && (!a.isValid() || math::floatEqual(a.t, b.t)), "parallel build intersection mismatch");
+			}
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test7()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 64, 64);
+		TriMeshf torus = Shapesf::torus(vec3f(0.5f, 0.0f, 0.0f), 1.0f, 0.25f, 64, 32);
+		std::vector<const TriMeshf*> meshes;
+		meshes.push_back(&sphere);
+		meshes.push_back(&torus);
+
+		TriMeshAcceleratorBruteForcef bruteForce;
+		bruteForce.build(meshes);
+		TriMeshAcceleratorBVHf bvh(TriMeshAcceleratorBVHf::BUILD_SAH);
+		bvh.build(meshes);
+
+		//in-memory image
+		std::vector<BYTE> image;
+		bvh.saveCache(image);
+		TriMeshAcceleratorBVHf loaded;
+		MLIB_ASSERT_STR(loaded.loadCache(image.data(), image.size(), meshes), "valid cache rejected");
+		MLIB_ASSERT_STR(loaded.getBuildMode() == TriMeshAcceleratorBVHf::BUILD_SAH && loaded.computeSAHCost() == bvh.computeSAHCost(), "cache does not restore the tree");
+		MLIB_ASSERT_STR(std::abs(loaded.computeSAHCostRatio() - 1.0f) < 1e-5f, "cache does not restore the build cost");
+		compareToBruteForce(loaded, bruteForce);
+
+		//stale or incompatible images are rejected
+		TriMeshf moved = torus;
+		moved.getVertices()[0].position.x += 0.01f;
+		std::vector<const TriMeshf*> movedMeshes;
+		movedMeshes.push_back(&sphere);
+		movedMeshes.push_back(&moved);
+		MLIB_ASSERT_STR(!loaded.loadCache(image.data(), image.size(), movedMeshes), "cache of different meshes accepted");
+		MLIB_ASSERT_STR(!loaded.intersect(Rayf(vec3f(0.0f, 0.0f, -3.0f), vec3f(0.0f, 0.0f, 1.0f))).isValid(), "rejected cache must leave the accelerator empty");
+		std::vector<BYTE> otherVersion = image;
+		otherVersion[8]++;
+		MLIB_ASSERT_STR(!loaded.loadCache(otherVersion.data(), otherVersion.size(), meshes), "cache of another version accepted");
+		MLIB_ASSERT_STR(!loaded.loadCache(image.data(), image.size() / 2, meshes), "truncated cache accepted");
+		//child offsets must point into the image and behind their parent (header, then nodes of two corners and four UINT32 each)
+		const size_t headerSize = 48, nodeSize = 2 * sizeof(vec3f) + 4 * sizeof(UINT32), lChildOffset = 2 * sizeof(vec3f);
+		UINT64 numNodes;
+		UINT32 rootChild;
+		std::memcpy(&numNodes, image.data() + 32, sizeof(UINT64));
+		std::memcpy(&rootChild, image.data() + headerSize + lChildOffset, sizeof(UINT32));
+		std::vector<BYTE> badChild = image;
+		const UINT32 outOfRange = (UINT32)numNodes - 1;
+		std::memcpy(badChild.data() + headerSize + lChildOffset, &outOfRange, sizeof(UINT32));
+		MLIB_ASSERT_STR(!loaded.loadCache(badChild.data(), badChild.size(), meshes), "cache with a child out of range accepted");
+		badChild = image;
+		std::memcpy(badChild.data() + headerSize + rootChild * nodeSize + lChildOffset, &rootChild, sizeof(UINT32));
+		MLIB_ASSERT_STR(!loaded.loadCache(badChild.data(), badChild.size(), meshes), "cache with a cycle accepted");
+		MLIB_ASSERT_STR(loaded.loadCache(image.data(), image.size(), meshes) && loaded.computeSAHCost() == bvh.computeSAHCost(), "valid cache rejected after invalid ones");
+
+		//cache file
+		const std::string filename = "bvhCache.bin";
+		util::deleteFile(filename);
+		TriMeshAcceleratorBVHf cached(TriMeshAcceleratorBVHf::BUILD_SAH);
+		MLIB_ASSERT_STR(!cached.buildCached(filename, meshes), "missing cache file used");
+		MLIB_ASSERT_STR(cached.buildCached(filename, meshes), "cache file not used");
+		compareToBruteForce(cached, bruteForce);
+		MLIB_ASSERT_STR(!cached.buildCached(filename, movedMeshes), "stale cache file used");
+		MLIB_ASSERT_STR(cached.buildCached(filename, movedMeshes), "rewritten cache file not used");
+		util::deleteFile(filename);
+
+		//self-contained stream serialization
+		BinaryDataStreamVector stream;
+		stream << bvh;
+		TriMeshAcceleratorBVHf streamed;
+		stream >> streamed;
+		MLIB_ASSERT_STR(streamed.triangleCount() == bvh.triangleCount() && streamed.computeSAHCost() == bvh.computeSAHCost(), "stream does not restore the tree");
+		compareToBruteForce(streamed, bruteForce);
+		TriMeshRayAcceleratorf::Intersection i = streamed.intersect(Rayf(vec3f(0.0f, 0.0f, -3.0f), vec3f(0.0f, 0.0f, 1.0f)));
+		MLIB_ASSERT_STR(i.isValid() && i.getMeshIndex() == bruteForce.intersect(Rayf(vec3f(0.0f, 0.0f, -3.0f), vec3f(0.0f, 0.0f, 1.0f))).getMeshIndex(), "stream does not keep the mesh indices");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	//! all intersecting triangle pairs (index in a, index in b) by brute force, with b placed by transform and the triangles of a as the first argument
+	static std::set<std::pair<unsigned int, unsigned int>> bruteForceCollisionPairs(const TriMeshf& a, const TriMeshf& b, const mat4f& transform = mat4f::identity())
+	{
+		std::set<std::pair<unsigned int, unsigned int>> pairs;
+		for (size_t i = 0; i < a.getIndices().size(); i++) {
+			const vec3ui& ta = a.getIndices()[i];
+			for (size_t j = 0; j < b.getIndices().size(); j++) {
+				const vec3ui& tb = b.getIndices()[j];
+				if (intersection::intersectTriangleTriangle(
+					a.getVertices()[ta.x].position, a.getVertices()[ta.y].position, a.getVertices()[ta.z].position,
+					transform * b.getVertices()[tb.x].position, transform * b.getVertices()[tb.y].position, transform * b.getVertices()[tb.z].position)) {
+					pairs.insert(std::make_pair((unsigned int)i, (unsigned int)j));
+				}
+			}
+		}
+		return pairs;
+	}
+
+	static std::set<std::pair<unsigned int, unsigned int>> collisionPairIndices(const TriMeshAcceleratorBVHf& a, const TriMeshAcceleratorBVHf& b)
+	{
+		return collisionPairIndices(a.collisionPairs(b));
+	}
+
+	static std::set<std::pair<unsigned int, unsigned int>> collisionPairIndices(const TriMeshAcceleratorBVHf& a, const TriMeshAcceleratorBVHf& b, const mat4f& transform)
+	{
+		return collisionPairIndices(a.collisionPairs(b, transform));
+	}
+
+	static std::set<std::pair<unsigned int, unsigned int>> collisionPairIndices(const std::vector<TriMeshAcceleratorBVHf::TrianglePair>& pairs)
+	{
+		std::set<std::pair<unsigned int, unsigned int>> indices;
+		for (const auto& p : pairs) {
+			indices.insert(std::make_pair(p.first->getIndex(), p.second->getIndex()));
+		}
+		MLIB_ASSERT_STR(indices.size() == pairs.size(), "duplicate collision pairs");
+		return indices;
+	}
+
+	void test8()
+	{
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 32, 32);
+		TriMeshf torus = Shapesf::torus(vec3f(0.5f, 0.0f, 0.0f), 1.0f, 0.25f, 32, 16);
+
+		//the triangle test is not exactly symmetric, so both argument orders are compared against their own brute force
+		const std::set<std::pair<unsigned int, unsigned int>> expectedSphereTorus = bruteForceCollisionPairs(sphere, torus);
+		const std::set<std::pair<unsigned int, unsigned int>> expectedTorusSphere = bruteForceCollisionPairs(torus, sphere);
+		MLIB_ASSERT_STR(!expectedSphereTorus.empty() && !expectedTorusSphere.empty(), "test meshes do not intersect");
+
+		const TriMeshAcceleratorBVHf::BuildMode modes[] = { TriMeshAcceleratorBVHf::BUILD_MEDIAN, TriMeshAcceleratorBVHf::BUILD_SAH };
+		for (TriMeshAcceleratorBVHf::BuildMode sphereMode : modes) {
+			for (TriMeshAcceleratorBVHf::BuildMode torusMode : modes) {
+				TriMeshAcceleratorBVHf bvhSphere(sphere, false, sphereMode);
+				TriMeshAcceleratorBVHf bvhTorus(torus, false, torusMode);
+
+				MLIB_ASSERT_STR(collisionPairIndices(bvhSphere, bvhTorus) == expectedSphereTorus, "collision pairs differ from brute force");
+				MLIB_ASSERT_STR(collisionPairIndices(bvhTorus, bvhSphere) == expectedTorusSphere, "collision pairs differ from brute force");
+				MLIB_ASSERT_STR(bvhSphere.collisionCount(bvhTorus) == expectedSphereTorus.size(), "collision count mismatch");
+				MLIB_ASSERT_STR(bvhTorus.collisionCount(bvhSphere) == expectedTorusSphere.size(), "collision count mismatch");
+				MLIB_ASSERT_STR(bvhSphere.collision(bvhTorus) && bvhTorus.collision(bvhSphere), "collision not detected");
+			}
+		}
+
+		//separated meshes
+		TriMeshf farSphere = Shapesf::sphere(1.0f, vec3f(5.0f, 0.0f, 0.0f), 32, 32);
+		TriMeshAcceleratorBVHf bvhFarSphere(farSphere, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorBVHf bvhTorus(torus, false, TriMeshAcceleratorBVHf::BUILD_MEDIAN);
+		MLIB_ASSERT_STR(!bvhFarSphere.collision(bvhTorus) && bvhFarSphere.collisionPairs(bvhTorus).empty(), "collision of separated meshes");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test9()
+	{
+		RNG rng;
+
+		//the separating axis test of transformed boxes must agree with the general OBB test
+		for (unsigned int i = 0; i < 10000; i++) {
+			const vec3f minA(rng.uniform(-1.0f, 0.0f), rng.uniform(-1.0f, 0.0f), rng.uniform(-1.0f, 0.0f));
+			const vec3f minB(rng.uniform(-1.0f, 0.0f), rng.uniform(-1.0f, 0.0f), rng.uniform(-1.0f, 0.0f));
+			const bbox3f a(minA, minA + vec3f(rng.uniform(0.1f, 1.0f), rng.uniform(0.1f, 1.0f), rng.uniform(0.1f, 1.0f)));
+			const bbox3f b(minB, minB + vec3f(rng.uniform(0.1f, 1.0f), rng.uniform(0.1f, 1.0f), rng.uniform(0.1f, 1.0f)));
+			const mat4f transform = mat4f::translation(rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 2.0f), rng.uniform(-2.0f, 2.0f)) *
+				mat4f::rotation(vec3f(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)), rng.uniform(0.0f, 360.0f)) * mat4f::scale(rng.uniform(0.5f, 2.0f));
+
+			OrientedBoundingBox3f obbB(b);
+			obbB *= transform;
+			const TriangleBVHNode<float>::TransformedBoxTest test(transform);
+			MLIB_ASSERT_STR(test.overlaps(a, b) == OrientedBoundingBox3f(a).intersects(obbB), "transformed box test differs from OBB test");
+		}
+
+		//transformed collisions must agree with brute force
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 16, 16);
+		TriMeshf torus = Shapesf::torus(vec3f(0.0f, 0.0f, 0.0f), 1.0f, 0.25f, 24, 12);
+		TriMeshAcceleratorBVHf bvhSphere(sphere, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorBVHf bvhTorus(torus, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorBruteForcef bruteSphere(sphere);
+		TriMeshAcceleratorBruteForcef bruteTorus(torus);
+		unsigned int numCollisions = 0;
+		for (unsigned int i = 0; i < 200; i++) {
+			const mat4f transform = mat4f::translation(rng.uniform(-1.5f, 1.5f), rng.uniform(-1.5f, 1.5f), rng.uniform(-1.5f, 1.5f)) *
+				mat4f::rotation(vec3f(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)), rng.uniform(0.0f, 360.0f));
+
+			const bool expected = bruteSphere.collision(bruteTorus, transform);
+			MLIB_ASSERT_STR(bvhSphere.collision(bvhTorus, transform) == expected, "transformed collision differs from brute force");
+			MLIB_ASSERT_STR(!expected || bvhSphere.collisionBBoxOnly(bvhTorus, transform), "box-only collision misses a collision");
+			if (expected) numCollisions++;
+
+			const std::set<std::pair<unsigned int, unsigned int>> expectedPairs = bruteForceCollisionPairs(sphere, torus, transform);
+			MLIB_ASSERT_STR(collisionPairIndices(bvhSphere, bvhTorus, transform) == expectedPairs && bvhSphere.collisionCount(bvhTorus, transform) == expectedPairs.size(), "transformed collision pairs differ from brute force");
+		}
+		MLIB_ASSERT_STR(numCollisions > 0 && numCollisions < 200, "test transforms do not cover both cases");
+
+		//finer meshes in both orders, where a non-conservative triangle cull in the leaves misses contacts
+		TriMeshf fineSphere = Shapesf::sphere(1.0f, vec3f(0.0f, 0.0f, 0.0f), 32, 32);
+		TriMeshf fineTorus = Shapesf::torus(vec3f(0.5f, 0.0f, 0.0f), 1.0f, 0.25f, 32, 16);
+		TriMeshAcceleratorBVHf bvhFineSphere(fineSphere, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorBVHf bvhFineTorus(fineTorus, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		for (unsigned int i = 0; i < 4; i++) {
+			const mat4f transform = mat4f::rotation(vec3f(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)), i * 30.0f);
+			const mat4f inverse = transform.getInverse();
+			const std::set<std::pair<unsigned int, unsigned int>> expectedSphereTorus = bruteForceCollisionPairs(fineSphere, fineTorus, transform);
+			const std::set<std::pair<unsigned int, unsigned int>> expectedTorusSphere = bruteForceCollisionPairs(fineTorus, fineSphere, inverse);
+			MLIB_ASSERT_STR(!expectedSphereTorus.empty() && !expectedTorusSphere.empty(), "test meshes do not intersect");
+			MLIB_ASSERT_STR(collisionPairIndices(bvhFineSphere, bvhFineTorus, transform) == expectedSphereTorus, "transformed collision pairs differ from brute force");
+			MLIB_ASSERT_STR(collisionPairIndices(bvhFineTorus, bvhFineSphere, inverse) == expectedTorusSphere, "transformed collision pairs differ from brute force");
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "BVH";
+	}
+};
@@ -0,0 +1,115 @@
+
+class TestCollision : public Test
+{
+public:
+	//! candidate and colliding pairs by testing all pairs of objects
+	static void bruteForcePairs(const TriMeshCollisionBroadPhasef& broadPhase, std::vector<std::pair<unsigned int, unsigned int>>& candidates, std::vector<std::pair<unsigned int, unsigned int>>& collisions)
+	{
+		candidates.clear();
+		collisions.clear();
+		for (unsigned int i = 0; i < broadPhase.getNumObjects(); i++) {
+			if (!broadPhase.getObject(i).active) continue;
+			for (unsigned int j = i + 1; j < broadPhase.getNumObjects(); j++) {
+				if (!broadPhase.getObject(j).active) continue;
+				if (broadPhase.getObject(i).worldBoundingBox.intersects(broadPhase.getObject(j).worldBoundingBox)) {
+					candidates.push_back(std::make_pair(i, j));
+				}
+				if (broadPhase.collision(i, j)) {
+					collisions.push_back(std::make_pair(i, j));
+				}
+			}
+		}
+	}
+
+	static mat4f randomPlacement(RNG& rng, float sceneSize)
+	{
+		return mat4f::translation(rng.uniform(0.0f, sceneSize), rng.uniform(0.0f, 0.2f * sceneSize), rng.uniform(0.0f, sceneSize)) *
+			mat4f::rotation(vec3f(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f)), rng.uniform(0.0f, 360.0f));
+	}
+
+	void test0()
+	{
+		TriMeshf sphere = Shapesf::sphere(0.5f, vec3f(0.0f, 0.0f, 0.0f), 16, 16);
+		TriMeshf torus = Shapesf::torus(vec3f(0.0f, 0.0f, 0.0f), 0.5f, 0.1f, 24, 12);
+		TriMeshAcceleratorBVHf bvhSphere(sphere, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+		TriMeshAcceleratorBVHf bvhTorus(torus, false, TriMeshAcceleratorBVHf::BUILD_SAH);
+
+		RNG rng;
+		const float sceneSize = 10.0f;
+		TriMeshCollisionBroadPhasef broadPhase;
+		for (unsigned int i = 0; i < 300; i++) {
+			broadPhase.addObject(i % 2 ? &bvhSphere : &bvhTorus, randomPlacement(rng, sceneSize));
+		}
+
+		std::vector<std::pair<unsigned int, unsigned int>> candidates, collisions, expectedCandidates, expectedCollisions;
+		for (unsigned int round = 0; round < 5; round++) {
+			broadPhase.computeCandidatePairs(candidates);
+			broadPhase.computeCollisions(collisions);
+			bruteForcePairs(broadPhase, expectedCandidates, expectedCollisions);
+			MLIB_ASSERT_STR(candidates == expectedCandidates, "broad phase candidates differ from brute force");
+			MLIB_ASSERT_STR(collisions == expectedCollisions, "broad phase collisions differ from brute force");
+			MLIB_ASSERT_STR(!collisions.empty() && collisions.size() < candidates.size(), "test scene does not cover both cases");
+
+			//small motions of some objects, removal and re-insertion
+			for (unsigned int i = 0; i < broadPhase.getNumObjects(); i += 3) {
+				if (!broadPhase.getObject(i).active) continue;
+				broadPhase.updateObject(i, mat4f::translation(rng.uniform(-0.2f, 0.2f), rng.uniform(-0.2f, 0.2f), rng.uniform(-0.2f, 0.2f)) * broadPhase.getObject(i).objectToWorld);
+			}
+			for (unsigned int i = round; i < broadPhase.getNumObjects(); i += 7) {
+				if (broadPhase.getObject(i).active) broadPhase.removeObject(i);
+			}
+			for (unsigned int i = 0; i < 20; i++) {
+				broadPhase.addObject(&bvhSphere, randomPlacement(rng, sceneSize));
+			}
+		}
+
+		//a scene spread along z switches the sweep axis
+		TriMeshCollisionBroadPhasef line;
+		for (unsigned int i = 0; i < 50; i++) {
+			line.addObject(&bvhSphere, mat4f::translation(0.0f, 0.0f, 0.9f * i));
+		}
+		MLIB_ASSERT_STR(line.computeCollisions().size() == 49, "collisions of neighboring spheres not found");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test1()
+	{
+		TriMeshf box = Shapesf::box(1.0f, 1.0f, 1.0f);
+		TriMeshAcceleratorBVHf bvhBox(box, false);
+
+		//motions by more than the object's extent, in both directions
+		TriMeshCollisionBroadPhasef broadPhase;
+		const unsigned int a = broadPhase.addObject(&bvhBox, mat4f::translation(0.0f, 0.0f, 0.0f));
+		const unsigned int b = broadPhase.addObject(&bvhBox, mat4f::translation(2.0f, 0.0f, 0.0f));
+		broadPhase.updateObject(a, mat4f::translation(5.0f, 0.0f, 0.0f));
+		const unsigned int f = broadPhase.addObject(&bvhBox, mat4f::translation(0.0f, 0.0f, 0.0f));
+		broadPhase.updateObject(f, mat4f::translation(2.5f, 0.0f, 0.0f));
+		std::vector<std::pair<unsigned int, unsigned int>> candidates = broadPhase.computeCandidatePairs();
+		MLIB_ASSERT_STR(candidates.size() == 1 && candidates[0] == std::make_pair(std::min(b, f), std::max(b, f)), "overlap after a large motion not found");
+		MLIB_ASSERT_STR(broadPhase.collision(b, f), "collision after a large motion not found");
+
+		RNG rng;
+		std::vector<std::pair<unsigned int, unsigned int>> collisions, expectedCandidates, expectedCollisions;
+		for (unsigned int i = 0; i < 50; i++) {
+			broadPhase.addObject(&bvhBox, mat4f::translation(rng.uniform(0.0f, 20.0f), rng.uniform(0.0f, 2.0f), rng.uniform(0.0f, 2.0f)));
+		}
+		for (unsigned int round = 0; round < 10; round++) {
+			for (unsigned int i = round % 2; i < broadPhase.getNumObjects(); i += 2) {
+				broadPhase.updateObject(i, mat4f::translation(rng.uniform(-5.0f, 5.0f), 0.0f, 0.0f) * broadPhase.getObject(i).objectToWorld);
+			}
+			broadPhase.computeCandidatePairs(candidates);
+			broadPhase.computeCollisions(collisions);
+			bruteForcePairs(broadPhase, expectedCandidates, expectedCollisions);
+			MLIB_ASSERT_STR(candidates == expectedCandidates, "broad phase candidates differ from brute force after large motions");
+			MLIB_ASSERT_STR(collisions == expectedCollisions, "broad phase collisions differ from brute force after large motions");
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "Collision";
+	}
+};
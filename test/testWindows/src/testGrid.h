@@ -216,6 +216,86 @@ public:
 		std::cout << __FUNCTION__ << " passed" << std::endl;
 	}
 
+	void test8()
+	{
+		//exact distance transform against brute force
+		BinaryGrid3 grid(13, 9, 7);
+		std::vector<vec3i> setVoxels;
+		RNG rng(21);
+		for (size_t i = 0; i < 6; i++) {
+			const vec3i v((int)rng.uniform(0u, 13u), (int)rng.uniform(0u, 9u), (int)rng.uniform(0u, 7u));
+			grid.setVoxel(v.x, v.y, v.z);
+			setVoxels.push_back(v);
+		}
+		const float trunc = 4.5f;
+		DistanceField3f df(grid, trunc);
+		for (size_t z = 0; z < grid.getDimZ(); z++) {
+			for (size_t y = 0; y < grid.getDimY(); y++) {
+				for (size_t x = 0; x < grid.getDimX(); x++) {
+					float expected = std::numeric_limits<float>::infinity();
+					for (const vec3i& v : setVoxels) {
+						expected = std::min(expected, vec3f((float)x - v.x, (float)y - v.y, (float)z - v.z).length());
+					}
+					if (expected > trunc) expected = std::numeric_limits<float>::infinity();
+					MLIB_ASSERT_STR(df(x, y, z) == expected || std::abs(df(x, y, z) - expected) < 1e-5f, "distance transform is not exact");
+				}
+			}
+		}
+
+		//signed distances of a solid box: zero halfway between the inside and outside voxel centers
+		BinaryGrid3 solid(12, 12, 12);
+		for (size_t z = 3; z < 9; z++) {
+			for (size_t y = 3; y < 9; y++) {
+				for (size_t x = 3; x < 9; x++) {
+					solid.setVoxel(x, y, z);
+				}
+			}
+		}
+		DistanceField3f sdf;
+		sdf.generateFromBinaryGrid(solid, 2.0f, true);
+		MLIB_ASSERT_STR(sdf(2, 5, 5) == 0.5f && sdf(3, 5, 5) == -0.5f && sdf(4, 5, 5) == -1.5f && sdf(5, 5, 5) == -std::numeric_limits<float>::infinity(), "wrong signed distances");
+		MLIB_ASSERT_STR(sdf(1, 5, 5) == 1.5f && sdf(0, 0, 0) == std::numeric_limits<float>::infinity(), "wrong signed truncation");
+		MLIB_ASSERT_STR(std::abs(sdf(2, 2, 5) - (std::sqrt(2.0f) - 0.5f)) < 1e-5f, "wrong signed distances");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test9()
+	{
+		//narrow-band sparse distance field against the dense one
+		TriMeshf sphere = Shapesf::sphere(1.0f, vec3f(0, 0, 0), 64, 64);
+		std::pair<BinaryGrid3, mat4f> grid = sphere.voxelize(0.02f);
+		const float trunc = 2.0f;
+		DistanceField3f dense(grid.first, trunc);
+		dense.setTruncation(trunc);
+
+		SparseDistanceField3f sparse(dense);
+		const vec3i brickDim = sparse.getBrickDimensions();
+		MLIB_ASSERT_STR(sparse.getNumBricks() > 0 && sparse.getNumBricks() < (size_t)(brickDim.x * brickDim.y * brickDim.z), "no sparsity");
+		MLIB_ASSERT_STR(sparse.memoryFootprint() < dense.memoryFootprint(), "sparse field is larger than the dense one");
+
+		RNG rng(22);
+		for (size_t i = 0; i < 1000; i++) {
+			const vec3f p(rng.uniform(0.0f, (float)dense.getDimX()), rng.uniform(0.0f, (float)dense.getDimY()), rng.uniform(0.0f, (float)dense.getDimZ()));
+			MLIB_ASSERT_STR(std::abs(sparse.trilinearInterpolationSimpleFastFast(p) - dense.trilinearInterpolationSimpleFastFast(p)) < 1e-4f, "sparse sampling mismatch");
+		}
+
+		DistanceField3f roundTrip = sparse.toDense();
+		MLIB_ASSERT_STR(roundTrip.getDimensions() == dense.getDimensions(), "wrong dimensions");
+		for (size_t z = 0; z < dense.getDimZ(); z++) {
+			for (size_t y = 0; y < dense.getDimY(); y++) {
+				for (size_t x = 0; x < dense.getDimX(); x++) {
+					MLIB_ASSERT_STR(roundTrip(x, y, z) == dense(x, y, z), "sparse round trip mismatch");
+				}
+			}
+		}
+
+		sparse.setVoxel(0, 0, 0, 0.5f);
+		MLIB_ASSERT_STR(sparse.isBrickAllocated(0, 0, 0) && sparse(0, 0, 0) == 0.5f && sparse(1, 0, 0) == trunc, "sparse set voxel failed");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
 	std::string getName() {
 		return "grid";
 	}
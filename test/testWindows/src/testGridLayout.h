@@ -0,0 +1,118 @@
+
+class TestGridLayout : public Test
+{
+public:
+	void test0()
+	{
+		checkLayout<Grid3LayoutTiled4>("tiled 4");
+		checkLayout<Grid3LayoutTiled8>("tiled 8");
+		checkLayout<Grid3LayoutMorton>("morton");
+		checkLayout<Grid3LayoutLinear>("linear");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test1()
+	{
+		//a 7-point stencil gives the same result in every layout
+		const vec3ul dim(21, 14, 9);
+		Grid3<float> reference = smooth(makeGrid<Grid3LayoutLinear>(dim));
+		MLIB_ASSERT_STR(equals(smooth(makeGrid<Grid3LayoutTiled4>(dim)), reference), "tiled stencil differs");
+		MLIB_ASSERT_STR(equals(smooth(makeGrid<Grid3LayoutMorton>(dim)), reference), "morton stencil differs");
+
+		//files do not depend on the layout
+		BinaryDataStreamFile out("tmp.bin", true);
+		out << makeGrid<Grid3LayoutMorton>(dim);
+		out.close();
+		BinaryDataStreamFile in("tmp.bin", false);
+		Grid3<float, Grid3LayoutTiled8> re;
+		in >> re;
+		in.close();
+		MLIB_ASSERT_STR(equals(re, makeGrid<Grid3LayoutLinear>(dim)), "binary stream of a morton grid and re don't match");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "grid layout";
+	}
+
+private:
+	template<class Layout>
+	static Grid3<float, Layout> makeGrid(const vec3ul& dim)
+	{
+		return Grid3<float, Layout>(dim.x, dim.y, dim.z, [](size_t x, size_t y, size_t z) { return (float)(x + 100 * y + 10000 * z); });
+	}
+
+	template<class LayoutA, class LayoutB>
+	static bool equals(const Grid3<float, LayoutA>& a, const Grid3<float, LayoutB>& b)
+	{
+		if (a.getDimensions() != b.getDimensions()) return false;
+		for (const auto& cell : a) {
+			if (cell.value != b(cell.x, cell.y, cell.z)) return false;
+		}
+		return true;
+	}
+
+	//! mean of the 6-neighborhood, traversed block by block
+	template<class Layout>
+	static Grid3<float> smooth(const Grid3<float, Layout>& grid)
+	{
+		Grid3<float> result(grid.getDimensions(), 0.0f);
+		for (const auto& block : grid.getBlocks()) {
+			for (size_t z = std::max(block.min.z, (size_t)1); z < std::min(block.max.z, grid.getDimZ() - 1); z++)
+				for (size_t y = std::max(block.min.y, (size_t)1); y < std::min(block.max.y, grid.getDimY() - 1); y++)
+					for (size_t x = std::max(block.min.x, (size_t)1); x < std::min(block.max.x, grid.getDimX() - 1); x++)
+						result(x, y, z) = (grid(x - 1, y, z) + grid(x + 1, y, z) + grid(x, y - 1, z) + grid(x, y + 1, z) + grid(x, y, z - 1) + grid(x, y, z + 1)) / 6.0f;
+		}
+		return result;
+	}
+
+	template<class Layout>
+	static void checkLayout(const std::string& name)
+	{
+		//dimensions that are no multiples of the tile size or powers of two
+		const vec3ul dim(13, 7, 21);
+		Grid3<float, Layout> grid = makeGrid<Layout>(dim);
+		MLIB_ASSERT_STR(grid.getNumStorageElements() >= grid.getNumElements(), name + ": storage too small");
+
+		//every cell has its own storage element
+		std::vector<bool> used(grid.getNumStorageElements(), false);
+		for (size_t z = 0; z < dim.z; z++)
+			for (size_t y = 0; y < dim.y; y++)
+				for (size_t x = 0; x < dim.x; x++) {
+					const size_t index = &grid(x, y, z) - grid.getData();
+					MLIB_ASSERT_STR(index < used.size() && !used[index], name + ": cells share storage");
+					used[index] = true;
+					MLIB_ASSERT_STR(grid(x, y, z) == (float)(x + 100 * y + 10000 * z), name + ": wrong value");
+				}
+
+		//the blocks cover every cell once, and the cells of a block are contiguous (up to padding)
+		Grid3<UINT, Layout> covered(dim.x, dim.y, dim.z, 0);
+		for (const auto& block : grid.getBlocks()) {
+			const vec3ul blockDim = grid.getLayout().getBlockDimensions();
+			size_t first = grid.getNumStorageElements(), last = 0;
+			for (size_t z = block.min.z; z < block.max.z; z++)
+				for (size_t y = block.min.y; y < block.max.y; y++)
+					for (size_t x = block.min.x; x < block.max.x; x++) {
+						covered(x, y, z)++;
+						const size_t index = &grid(x, y, z) - grid.getData();
+						first = std::min(first, index);
+						last = std::max(last, index);
+					}
+			MLIB_ASSERT_STR(last - first < blockDim.x * blockDim.y * blockDim.z, name + ": block not contiguous");
+		}
+		for (const auto& cell : covered) {
+			MLIB_ASSERT_STR(cell.value == 1, name + ": blocks do not cover the grid");
+		}
+
+		//copies, comparison and element-wise operations
+		Grid3<float, Layout> copy = grid;
+		MLIB_ASSERT_STR(copy == grid, name + ": copy differs");
+		copy(12, 6, 20) += 1.0f;
+		MLIB_ASSERT_STR(copy != grid, name + ": modified copy equals the grid");
+		copy *= 2.0f;
+		MLIB_ASSERT_STR(copy(3, 4, 5) == 2.0f * grid(3, 4, 5) && copy.getMaxIndex() == vec3ul(12, 6, 20), name + ": wrong element-wise operation");
+	}
+};
@@ -0,0 +1,98 @@
+
+class TestMarchingCubes : public Test
+{
+public:
+	void test0()
+	{
+		//sphere distance field over several slabs, with colors that are linear in x
+		const size_t dim = 40;
+		const vec3f center(19.3f, 20.1f, 19.7f);
+		const float radius = 12.3f;
+		Grid3<float> values(dim, dim, dim);
+		Grid3<vec4f> colors(dim, dim, dim);
+		for (size_t z = 0; z < dim; z++) {
+			for (size_t y = 0; y < dim; y++) {
+				for (size_t x = 0; x < dim; x++) {
+					values(x, y, z) = (vec3f((float)x, (float)y, (float)z) - center).length() - radius;
+					colors(x, y, z) = vec4f((float)x / dim, 0.5f, 0.0f, 1.0f);
+				}
+			}
+		}
+
+		const float voxelSize = 0.1f;
+		const TriMeshf mesh = MarchingCubesf::extract(values, colors, 0.0f, mat4f::scale(voxelSize));
+		MLIB_ASSERT_STR(mesh.getVertices().size() > 1000 && mesh.hasColors(), "no surface extracted");
+		checkClosed(mesh);
+		for (const TriMeshf::Vertex& v : mesh.getVertices()) {
+			const vec3f p = v.position / voxelSize;
+			MLIB_ASSERT_STR(std::abs((p - center).length() - radius) < 0.05f, "vertex not on the sphere");
+			MLIB_ASSERT_STR((v.normal | (p - center).getNormalized()) > 0.9f, "normal not pointing out of the sphere");
+			MLIB_ASSERT_STR(std::abs(v.color.x - p.x / dim) < 1e-4f && v.color.y == 0.5f, "wrong vertex color");
+		}
+
+		//every grid edge has at most one vertex
+		std::vector<vec3f> positions;
+		for (const TriMeshf::Vertex& v : mesh.getVertices()) positions.push_back(v.position);
+		std::sort(positions.begin(), positions.end(), [](const vec3f& a, const vec3f& b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); });
+		MLIB_ASSERT_STR(std::adjacent_find(positions.begin(), positions.end()) == positions.end(), "duplicate vertices");
+
+		//the result does not depend on the thread schedule
+		const TriMeshf again = MarchingCubesf::extract(values, colors, 0.0f, mat4f::scale(voxelSize));
+		MLIB_ASSERT_STR(again.getIndices() == mesh.getIndices() && again.getVertices().size() == mesh.getVertices().size(), "extraction not deterministic");
+		for (size_t i = 0; i < mesh.getVertices().size(); i++) {
+			MLIB_ASSERT_STR(again.getVertices()[i].position == mesh.getVertices()[i].position, "extraction not deterministic");
+		}
+
+		//iso value: a larger sphere
+		const TriMeshf larger = MarchingCubesf::extract(values, 2.0f);
+		for (const TriMeshf::Vertex& v : larger.getVertices()) {
+			MLIB_ASSERT_STR(std::abs((v.position - center).length() - radius - 2.0f) < 0.05f, "wrong iso value");
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test1()
+	{
+		//truncated signed distance field of a voxelized box: infinite values beyond the band are skipped
+		BinaryGrid3 solid(24, 20, 30);
+		for (UINT z = 5; z < 25; z++) {
+			for (UINT y = 4; y < 15; y++) {
+				for (UINT x = 3; x < 19; x++) solid.setVoxel(x, y, z);
+			}
+		}
+		DistanceField3f sdf(solid.getDimensions());
+		sdf.generateFromBinaryGrid(solid, 3.0f, true);
+		const TriMeshf mesh = MarchingCubesf::extract(sdf);
+		MLIB_ASSERT_STR(!mesh.getVertices().empty() && !mesh.hasColors(), "no surface extracted");
+		checkClosed(mesh);
+		for (const TriMeshf::Vertex& v : mesh.getVertices()) {
+			const vec3f& p = v.position;
+			MLIB_ASSERT_STR(p.x >= 2.5f && p.x <= 18.5f && p.y >= 3.5f && p.y <= 14.5f && p.z >= 4.5f && p.z <= 24.5f, "vertex not on the box");
+		}
+
+		//values that are all above or below the iso value give no triangles
+		MLIB_ASSERT_STR(MarchingCubesf::extract(sdf, 100.0f).getIndices().empty(), "surface beyond the truncation");
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "marching cubes";
+	}
+
+private:
+	//! every edge is shared by exactly two triangles with opposite orientation
+	static void checkClosed(const TriMeshf& mesh)
+	{
+		std::map<std::pair<UINT, UINT>, UINT> edges;
+		for (const vec3ui& t : mesh.getIndices()) {
+			MLIB_ASSERT_STR(t.x != t.y && t.y != t.z && t.z != t.x, "degenerate triangle");
+			for (int i = 0; i < 3; i++) edges[std::make_pair(t[i], t[(i + 1) % 3])]++;
+		}
+		for (const auto& e : edges) {
+			MLIB_ASSERT_STR(e.second == 1, "edge used twice in the same direction");
+			MLIB_ASSERT_STR(edges.count(std::make_pair(e.first.second, e.first.first)) == 1, "surface not closed");
+		}
+	}
+};
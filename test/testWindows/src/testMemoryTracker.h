@@ -0,0 +1,95 @@
+
+class TestMemoryTracker : public Test
+{
+public:
+	void test0()
+	{
+		MemoryTracker::resetPeaks();
+		const size_t before = MemoryTracker::getCurrentBytes(MEMORY_MESH);
+		{
+			std::vector<vec3f, TrackingAllocator<vec3f, MEMORY_MESH>> vertices;
+			vertices.reserve(1000);
+			MLIB_ASSERT_STR(MemoryTracker::getCurrentBytes(MEMORY_MESH) == before + 1000 * sizeof(vec3f), "allocation not recorded");
+
+			//a larger reserve moves the data; the peak holds both buffers
+			vertices.reserve(3000);
+			MLIB_ASSERT_STR(MemoryTracker::getCurrentBytes(MEMORY_MESH) == before + 3000 * sizeof(vec3f), "reallocation not recorded");
+			MLIB_ASSERT_STR(MemoryTracker::getPeakBytes(MEMORY_MESH) >= before + 4000 * sizeof(vec3f), "wrong peak");
+		}
+		MLIB_ASSERT_STR(MemoryTracker::getCurrentBytes(MEMORY_MESH) == before, "free not recorded");
+
+		//allocations beyond the budget fail without being charged
+		MemoryTracker::setBudget(MEMORY_IMAGE, MemoryTracker::getCurrentBytes(MEMORY_IMAGE) + (1 << 20));
+		MLIB_ASSERT_STR(MemoryTracker::fitsBudget(MEMORY_IMAGE, 1 << 19) && !MemoryTracker::fitsBudget(MEMORY_IMAGE, 1 << 21), "wrong budget check");
+		const size_t imageBytes = MemoryTracker::getCurrentBytes(MEMORY_IMAGE);
+		bool thrown = false;
+		try {
+			std::vector<float, TrackingAllocator<float, MEMORY_IMAGE>> pixels(1 << 20);
+		} catch (const std::bad_alloc&) {
+			thrown = true;
+		}
+		MLIB_ASSERT_STR(thrown && MemoryTracker::getCurrentBytes(MEMORY_IMAGE) == imageBytes, "budget not enforced");
+		MemoryTracker::setBudget(MEMORY_IMAGE, 0);
+
+		const std::string summary = MemoryTracker::getSummary();
+		MLIB_ASSERT_STR(summary.find("accelerator") != std::string::npos && summary.find("sensor data") != std::string::npos, "subsystems missing in summary");
+
+		//with MLIB_TRACK_MEMORY, mLib's containers charge their subsystems
+		if (MemoryTracker::isTrackingAllAllocations()) {
+			const size_t gridBefore = MemoryTracker::getCurrentBytes(MEMORY_GRID);
+			{
+				Grid3f grid(64, 64, 64);
+				MLIB_ASSERT_STR(MemoryTracker::getCurrentBytes(MEMORY_GRID) >= gridBefore + grid.getNumElements() * sizeof(float), "grid not charged");
+			}
+			MLIB_ASSERT_STR(MemoryTracker::getCurrentBytes(MEMORY_GRID) == gridBefore, "grid not released");
+
+			const size_t acceleratorBefore = MemoryTracker::getCurrentBytes(MEMORY_ACCELERATOR);
+			TriMeshf mesh = Shapesf::sphere(1.0f, vec3f::origin, 20, 20);
+			TriMeshAcceleratorBVHf bvh(mesh);
+			MLIB_ASSERT_STR(MemoryTracker::getCurrentBytes(MEMORY_ACCELERATOR) > acceleratorBefore, "accelerator not charged");
+		}
+
+		std::cout << MemoryTracker::getSummary();
+		std::cout << "test0 passed" << std::endl;
+	}
+
+	void test1()
+	{
+		Grid3f grid(32, 16, 8);
+		MLIB_ASSERT_STR(grid.memoryFootprint() == sizeof(grid) + 32 * 16 * 8 * sizeof(float), "wrong grid footprint");
+
+		ColorImageR8G8B8A8 image(100, 50);
+		MLIB_ASSERT_STR(image.memoryFootprint() == sizeof(image) + 100 * 50 * sizeof(vec4uc), "wrong image footprint");
+
+		SparseGrid3<float> sparse;
+		const size_t emptyFootprint = sparse.memoryFootprint();
+		for (int i = 0; i < 1000; i++) sparse(i, 0, 0) = (float)i;
+		MLIB_ASSERT_STR(sparse.memoryFootprint() >= emptyFootprint + 1000 * (sizeof(vec3i) + sizeof(float)), "wrong sparse grid footprint");
+
+		TriMeshf mesh = Shapesf::torus(vec3f::origin, 1.0f, 0.3f, 40, 20);
+		MLIB_ASSERT_STR(mesh.memoryFootprint() >= mesh.getVertices().size() * sizeof(TriMeshf::Vertex) + mesh.getIndices().size() * sizeof(vec3ui), "wrong mesh footprint");
+
+		const MeshDataf meshData = mesh.computeMeshData();
+		MLIB_ASSERT_STR(meshData.memoryFootprint() >= meshData.m_Vertices.size() * sizeof(vec3f) + meshData.m_FaceIndicesVertices.size() * 3 * sizeof(unsigned int), "wrong mesh data footprint");
+
+		//accelerators: a local copy adds the vertices; the BVH adds its nodes
+		TriMeshAcceleratorBruteForcef bruteForce(mesh);
+		TriMeshAcceleratorBruteForcef bruteForceCopy(mesh, true);
+		TriMeshAcceleratorBVHf bvh(mesh);
+		const TriMeshAccelerator<float>& accelerator = bvh;
+		MLIB_ASSERT_STR(bruteForceCopy.memoryFootprint() >= bruteForce.memoryFootprint() + mesh.getVertices().size() * sizeof(TriMeshf::Vertex), "local copy not included");
+		MLIB_ASSERT_STR(bvh.memoryFootprint() > bruteForce.memoryFootprint() && accelerator.memoryFootprint() == bvh.memoryFootprint(), "wrong accelerator footprint");
+
+		//strings on the heap, including those only a little longer than the inline buffer
+		const std::string shortString("mLib");
+		const std::string longString(20, 'x');
+		MLIB_ASSERT_STR(util::memoryFootprint(shortString) == 0 && util::memoryFootprint(longString) == longString.capacity() + 1, "wrong string footprint");
+
+		std::cout << "test1 passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "MemoryTracker";
+	}
+};
@@ -0,0 +1,471 @@
+
+class TestMultithreading : public Test
+{
+public:
+	struct CounterStorage : public ThreadLocalStorage
+	{
+		UINT threadIndex;
+		size_t numTasks;
+	};
+
+	struct CountTask : public WorkerThreadTask
+	{
+		CountTask(std::atomic<size_t>* _numDeleted) : numDeleted(_numDeleted) {}
+		~CountTask() {
+			(*numDeleted)++;
+		}
+		void run(UINT threadIndex, ThreadLocalStorage* threadLocalStorage) {
+			CounterStorage* storage = (CounterStorage*)threadLocalStorage;
+			MLIB_ASSERT_STR(storage->threadIndex == threadIndex, "task runs with the storage of another thread");
+			storage->numTasks++;
+		}
+		std::atomic<size_t>* numDeleted;
+	};
+
+	//runs numTasks through push (retried until it succeeds) and pop (returns the number of claimed tasks, at most 16); returns the time in ms
+	template<class Push, class Pop>
+	double benchmarkQueue(unsigned int numThreads, size_t numTasks, const Push& push, const Pop& pop)
+	{
+		const unsigned int numProducers = std::max(1u, numThreads / 2);
+		const unsigned int numConsumers = std::max(1u, numThreads - numProducers);
+		std::atomic<size_t> numPopped(0), checksum(0);
+		auto produce = [&](unsigned int producer) {
+			for (size_t task = producer; task < numTasks; task += numProducers) {
+				while (!push(task)) std::this_thread::yield();
+			}
+		};
+		auto consume = [&]() {
+			size_t tasks[16], sum = 0;
+			while (numPopped < numTasks) {
+				const size_t count = pop(tasks);
+				for (size_t i = 0; i < count; i++) sum += tasks[i];
+				if (count > 0) numPopped += count;
+				else std::this_thread::yield();
+			}
+			checksum += sum;
+		};
+
+		Timer timer;
+		if (numThreads == 1) {
+			//a single thread alternates, so a bounded queue cannot fill up
+			for (size_t task = 0; task < numTasks; task++) {
+				push(task);
+				size_t tasks[16];
+				pop(tasks);
+				checksum += tasks[0];
+			}
+		} else {
+			std::vector<std::thread> threads;
+			for (unsigned int p = 0; p < numProducers; p++) threads.push_back(std::thread(produce, p));
+			for (unsigned int c = 0; c < numConsumers; c++) threads.push_back(std::thread(consume));
+			for (auto& t : threads) t.join();
+		}
+		const double time = timer.getElapsedTimeMS();
+		MLIB_ASSERT_STR(checksum == numTasks * (numTasks - 1) / 2, "tasks lost or duplicated");
+		return time;
+	}
+
+	struct ArenaTask : public WorkerThreadTask
+	{
+		ArenaTask(std::atomic<size_t>* _numDeleted, std::atomic<size_t>* _numWithArena) : numDeleted(_numDeleted), numWithArena(_numWithArena) {}
+		~ArenaTask() {
+			(*numDeleted)++;
+		}
+		void run(UINT threadIndex, ThreadLocalStorage* threadLocalStorage) {
+			MemoryArena* arena = threadLocalStorage->getArena();
+			if (arena == nullptr) return;
+			size_t* data = arena->allocateArray<size_t>(1000);
+			for (size_t i = 0; i < 1000; i++) data[i] = i + threadIndex;
+			(*numWithArena)++;
+		}
+		std::atomic<size_t>* numDeleted;
+		std::atomic<size_t>* numWithArena;
+	};
+
+	struct SlabStorage : public ThreadLocalStorage
+	{
+		SlabStorage() : slab(nullptr) {}
+		float* slab;
+	};
+
+	//sweeps the given slab, or the running worker's slab in its arena (copied from initialSlab on first use)
+	struct SweepTask : public WorkerThreadTask
+	{
+		SweepTask(float* _slab, const float* _initialSlab, size_t _dimX, size_t _slabSize, size_t _numSweeps) :
+			slab(_slab), initialSlab(_initialSlab), dimX(_dimX), slabSize(_slabSize), numSweeps(_numSweeps) {}
+		void run(UINT threadIndex, ThreadLocalStorage* threadLocalStorage) {
+			float* data = slab;
+			if (data == nullptr) {
+				SlabStorage* storage = (SlabStorage*)threadLocalStorage;
+				if (storage->slab == nullptr) {
+					storage->slab = storage->getArena()->allocateArray<float>(slabSize);
+					std::copy(initialSlab, initialSlab + slabSize, storage->slab);
+				}
+				data = storage->slab;
+			}
+			for (size_t sweep = 0; sweep < numSweeps; sweep++) {
+				for (size_t row = 0; row < slabSize; row += dimX) {
+					float* r = data + row;
+					for (size_t x = 1; x < dimX; x++) r[x] = std::min(r[x], r[x - 1] + 1.0f);
+					for (size_t x = dimX - 1; x > 0; x--) r[x - 1] = std::min(r[x - 1], r[x] + 1.0f);
+				}
+			}
+		}
+		float* slab;
+		const float* initialSlab;
+		size_t dimX, slabSize, numSweeps;
+	};
+
+	void test0()
+	{
+		ThreadPool pool(4);
+		MLIB_ASSERT_STR(pool.getThreadCount() == 4, "wrong thread count");
+
+		//futures
+		std::vector<std::future<size_t>> results;
+		for (size_t i = 0; i < 1000; i++) {
+			results.push_back(pool.submit([i]() { return i * i; }));
+		}
+		for (size_t i = 0; i < results.size(); i++) {
+			MLIB_ASSERT_STR(results[i].get() == i * i, "wrong future result");
+		}
+		std::future<int> failing = pool.submit([]() -> int { throw MLIB_EXCEPTION("expected"); });
+		bool thrown = false;
+		try {
+			failing.get();
+		}
+		catch (const MLibException&) {
+			thrown = true;
+		}
+		MLIB_ASSERT_STR(thrown, "exception not passed through the future");
+
+		//every index exactly once, including nested loops and ranges that do not divide into the grain
+		const size_t n = 10007;
+		std::vector<std::atomic<unsigned int>> visits(n);
+		for (auto& v : visits) v = 0;
+		const size_t grains[] = { 1, 7, 64, 100000 };
+		for (size_t grain : grains) {
+			pool.parallelFor(0, n, grain, [&](size_t i) { visits[i]++; });
+		}
+		pool.parallelFor(0, 100, 1, [&](size_t i) {
+			pool.parallelFor(i * 100, std::min(n, i * 100 + 100), 8, [&](size_t j) { visits[j]++; });
+		});
+		for (size_t i = 0; i < n; i++) {
+			MLIB_ASSERT_STR(visits[i] == (i < 10000 ? 5u : 4u), "parallelFor visits an index more or less than once");
+		}
+		pool.parallelFor(5, 5, 1, [&](size_t) { MLIB_ASSERT_STR(false, "empty range visited"); });
+
+		//an exception thrown on any thread stops the loop and is rethrown on the caller; the pool stays usable
+		for (size_t throwAt : { (size_t)0, (size_t)5000, n - 1 }) {
+			std::atomic<size_t> numVisited(0);
+			thrown = false;
+			try {
+				pool.parallelFor(0, n, 16, [&](size_t i) {
+					numVisited++;
+					if (i == throwAt) throw std::runtime_error("parallelFor");
+				});
+			} catch (const std::runtime_error&) {
+				thrown = true;
+			}
+			MLIB_ASSERT_STR(thrown && numVisited <= n, "exception not passed through parallelFor");
+		}
+		std::atomic<size_t> numVisited(0);
+		pool.parallelFor(0, n, 16, [&](size_t) { numVisited++; });
+		MLIB_ASSERT_STR(numVisited == n, "pool unusable after an exception");
+
+		//task lists with thread local storage; tasks are deleted after running
+		std::vector<CounterStorage> storage(3);
+		std::vector<ThreadLocalStorage*> storagePointers;
+		for (UINT i = 0; i < storage.size(); i++) {
+			storage[i].threadIndex = i;
+			storage[i].numTasks = 0;
+			storagePointers.push_back(&storage[i]);
+		}
+		pool.init((UINT)storage.size(), storagePointers);
+		std::atomic<size_t> numDeleted(0);
+		TaskList<WorkerThreadTask*> tasks;
+		for (size_t i = 0; i < 500; i++) {
+			tasks.insert(new CountTask(&numDeleted));
+		}
+		pool.runTasks(tasks, false);
+		MLIB_ASSERT_STR(numDeleted == 500 && storage[0].numTasks + storage[1].numTasks + storage[2].numTasks == 500, "not all tasks ran");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test1()
+	{
+		//single-threaded semantics: rounded capacity, fifo order, full and empty
+		LockFreeQueue<int> queue(100);
+		MLIB_ASSERT_STR(queue.capacity() == 128 && queue.empty(), "wrong capacity");
+		int value;
+		MLIB_ASSERT_STR(!queue.tryPop(value), "pop from an empty queue");
+		for (int i = 0; i < 128; i++) {
+			MLIB_ASSERT_STR(queue.tryPush(i), "push to a non-full queue failed");
+		}
+		MLIB_ASSERT_STR(!queue.tryPush(128) && queue.sizeApprox() == 128, "push to a full queue");
+		int batch[50];
+		MLIB_ASSERT_STR(queue.tryPopBatch(batch, 50) == 50 && batch[0] == 0 && batch[49] == 49, "wrong batch");
+		const int values[] = { 128, 129, 130 };
+		MLIB_ASSERT_STR(queue.tryPushBatch(values, 3) == 3, "batch push failed");
+		MLIB_ASSERT_STR(queue.tryPushBatch(values, 0) == 0 && queue.tryPopBatch(batch, 0) == 0 && queue.sizeApprox() == 81, "empty batch on a partially filled queue");
+		size_t popped = 0;
+		int expected = 50;
+		size_t count;
+		while ((count = queue.tryPopBatch(batch, 50)) > 0) {
+			for (size_t i = 0; i < count; i++) {
+				MLIB_ASSERT_STR(batch[i] == expected++, "queue is not fifo");
+			}
+			popped += count;
+		}
+		MLIB_ASSERT_STR(popped == 81 && queue.empty(), "wrong number of values");
+
+		//every value is popped exactly once with concurrent producers and (batch) consumers
+		const unsigned int numProducers = 4, numConsumers = 4, valuesPerProducer = 100000;
+		LockFreeQueue<unsigned int> shared(256);
+		std::vector<std::atomic<unsigned char>> seen(numProducers * valuesPerProducer);
+		for (auto& s : seen) s = 0;
+		std::atomic<unsigned int> numPopped(0);
+		std::vector<std::thread> threads;
+		for (unsigned int p = 0; p < numProducers; p++) {
+			threads.push_back(std::thread([&, p]() {
+				for (unsigned int i = 0; i < valuesPerProducer; i++) {
+					while (!shared.tryPush(p * valuesPerProducer + i)) std::this_thread::yield();
+				}
+			}));
+		}
+		for (unsigned int c = 0; c < numConsumers; c++) {
+			threads.push_back(std::thread([&, c]() {
+				unsigned int values[16];
+				while (numPopped < numProducers * valuesPerProducer) {
+					const size_t count = shared.tryPopBatch(values, c + 1);
+					for (size_t i = 0; i < count; i++) seen[values[i]]++;
+					numPopped += (unsigned int)count;
+					if (count == 0) std::this_thread::yield();
+				}
+			}));
+		}
+		for (auto& t : threads) t.join();
+		for (size_t i = 0; i < seen.size(); i++) {
+			MLIB_ASSERT_STR(seen[i] == 1, "value popped more or less than once");
+		}
+
+		//batches from a task list
+		TaskList<int> tasks;
+		for (int i = 0; i < 10; i++) tasks.insert(i);
+		std::vector<int> claimed;
+		MLIB_ASSERT_STR(tasks.getNextTasks(claimed, 4) && claimed.size() == 4 && tasks.tasksLeft() == 6, "wrong task batch");
+		MLIB_ASSERT_STR(tasks.getNextTasks(claimed, 100) && claimed.size() == 6 && tasks.done(), "wrong task batch");
+		MLIB_ASSERT_STR(!tasks.getNextTasks(claimed, 4) && claimed.empty(), "batch from an empty task list");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	//microbenchmark: half the threads produce, half consume (1 thread does both) the same number of tasks through a TaskList,
+	//a LockFreeQueue and a LockFreeQueue with batches of 16
+	void test2()
+	{
+		const size_t numTasks = 1 << 18;
+		std::cout << "threads\tTaskList\tLockFreeQueue\tbatched (ms)" << std::endl;
+		for (unsigned int numThreads = 1; numThreads <= 64; numThreads *= 2) {
+			TaskList<size_t> taskList;
+			const double taskListTime = benchmarkQueue(numThreads, numTasks,
+				[&](size_t task) { taskList.insert(task); return true; },
+				[&](size_t* tasks) { return taskList.getNextTask(tasks[0]) ? (size_t)1 : (size_t)0; });
+			LockFreeQueue<size_t> queue(4096);
+			const double queueTime = benchmarkQueue(numThreads, numTasks,
+				[&](size_t task) { return queue.tryPush(task); },
+				[&](size_t* tasks) { return queue.tryPop(tasks[0]) ? (size_t)1 : (size_t)0; });
+			const double batchTime = benchmarkQueue(numThreads, numTasks,
+				[&](size_t task) { return queue.tryPush(task); },
+				[&](size_t* tasks) { return queue.tryPopBatch(tasks, 16); });
+			std::cout << numThreads << "\t" << taskListTime << "\t" << queueTime << "\t" << batchTime << std::endl;
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	//compares a radix sort of random keys with std::stable_sort (as bits, so -0/+0 are distinguished)
+	template<class K>
+	void checkRadixSort(const std::vector<K>& keys, ThreadPool& pool)
+	{
+		std::vector<K> sorted = keys;
+		std::vector<UINT> order(keys.size());
+		for (UINT i = 0; i < order.size(); i++) order[i] = i;
+		parallel::radixSort(sorted, order, pool);
+
+		std::vector<UINT> expectedOrder = order;
+		for (UINT i = 0; i < expectedOrder.size(); i++) expectedOrder[i] = i;
+		std::stable_sort(expectedOrder.begin(), expectedOrder.end(), [&](UINT a, UINT b) {
+			return parallel::RadixKey<K>::toBits(keys[a]) < parallel::RadixKey<K>::toBits(keys[b]);
+		});
+		MLIB_ASSERT_STR(order == expectedOrder, "radix sort is not a stable sort");
+		for (size_t i = 0; i < keys.size(); i++) {
+			MLIB_ASSERT_STR(memcmp(&sorted[i], &keys[order[i]], sizeof(K)) == 0, "keys and values do not match");
+		}
+	}
+
+	void test3()
+	{
+		RNG rng(1234);
+		const size_t n = 100003;
+		std::vector<double> values(n);
+		std::vector<int> ints(n);
+		for (size_t i = 0; i < n; i++) {
+			values[i] = rng.uniform(-1.0, 1.0) * std::pow(10.0, rng.uniform(-5.0, 5.0));
+			ints[i] = rng.uniform(-1000, 1001);
+		}
+		values[7] = 0.0;
+		values[8] = -0.0;
+
+		//identical results for every thread count
+		ThreadPool pools[3];
+		pools[0].init(1);
+		pools[1].init(3);
+		pools[2].init(8);
+		const double sum = parallel::reduce(values, 0.0, pools[0]);
+		std::vector<double> scan;
+		const double scanTotal = parallel::exclusiveScan(values, scan, 0.0, pools[0]);
+		for (ThreadPool& pool : pools) {
+			MLIB_ASSERT_STR(parallel::reduce(values, 0.0, pool) == sum, "reduction depends on the thread count");
+			std::vector<double> otherScan;
+			MLIB_ASSERT_STR(parallel::exclusiveScan(values, otherScan, 0.0, pool) == scanTotal && otherScan == scan, "scan depends on the thread count");
+		}
+		double serialSum = 0.0;
+		for (double v : values) serialSum += std::abs(v);
+		MLIB_ASSERT_STR(std::abs(sum - std::accumulate(values.begin(), values.end(), 0.0)) < 1e-9 * serialSum, "wrong sum");
+		MLIB_ASSERT_STR(scanTotal == sum && scan[0] == 0.0 && std::abs(scan[n - 1] + values[n - 1] - sum) < 1e-9 * serialSum, "wrong scan");
+
+		//integer scan in place, reduce with another operator
+		std::vector<int> prefix = ints;
+		const int total = parallel::exclusiveScan(prefix.data(), prefix.data(), n, 5, pools[1]);
+		int running = 5;
+		for (size_t i = 0; i < n; i++) {
+			MLIB_ASSERT_STR(prefix[i] == running, "wrong in place scan");
+			running += ints[i];
+		}
+		MLIB_ASSERT_STR(total == running, "wrong scan total");
+		MLIB_ASSERT_STR(parallel::reduce(ints, -100000, [](int a, int b) { return std::max(a, b); }, pools[2]) == *std::max_element(ints.begin(), ints.end()), "wrong maximum");
+		MLIB_ASSERT_STR(parallel::reduce(std::vector<int>(), 42, pools[2]) == 42, "wrong empty reduction");
+
+		//stable partition
+		std::vector<int> partitioned = ints;
+		auto isEven = [](int v) { return v % 2 == 0; };
+		const size_t numEven = parallel::partition(partitioned, isEven, pools[2]);
+		std::vector<int> expected = ints;
+		std::stable_partition(expected.begin(), expected.end(), isEven);
+		MLIB_ASSERT_STR(partitioned == expected && numEven == (size_t)std::count_if(ints.begin(), ints.end(), isEven), "wrong partition");
+
+		//histogram
+		const std::vector<size_t> bins = parallel::histogram(ints, 2001, [](int v) { return v + 1000; }, pools[1]);
+		std::vector<size_t> expectedBins(2001, 0);
+		for (int v : ints) expectedBins[v + 1000]++;
+		MLIB_ASSERT_STR(bins == expectedBins, "wrong histogram");
+
+		//radix sort for the supported key types, with duplicates to check stability
+		std::vector<float> floats(n);
+		std::vector<INT64> longs(n);
+		std::vector<unsigned int> uints(n);
+		for (size_t i = 0; i < n; i++) {
+			floats[i] = (float)values[i / 3];
+			longs[i] = (INT64)ints[i] * 1000000007ll;
+			uints[i] = rng.uniform(0u, 1000u);
+		}
+		for (ThreadPool& pool : pools) {
+			checkRadixSort(ints, pool);
+			checkRadixSort(values, pool);
+			checkRadixSort(floats, pool);
+			checkRadixSort(longs, pool);
+			checkRadixSort(uints, pool);
+		}
+		std::vector<float> sortedFloats = floats;
+		parallel::radixSort(sortedFloats);
+		MLIB_ASSERT_STR(std::is_sorted(sortedFloats.begin(), sortedFloats.end()), "floats not sorted");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test4()
+	{
+		const CpuTopology& topology = CpuTopology::get();
+		MLIB_ASSERT_STR(topology.getNodeCount() > 0 && topology.getProcessorCount() > 0, "no processors");
+		for (UINT node = 0; node < topology.getNodeCount(); node++) {
+			MLIB_ASSERT_STR(!topology.getNodeProcessors(node).empty(), "empty node");
+		}
+		MLIB_ASSERT_STR(topology.getThreadProcessors(0, PLACEMENT_FREE).empty(), "free threads are pinned");
+		MLIB_ASSERT_STR(topology.getThreadProcessors(topology.getNodeCount(), PLACEMENT_CORE).size() == 1, "core placement uses several processors");
+
+		//arena: alignment, large allocations, reuse after reset
+		MemoryArena arena(-1, 4096);
+		char* a = (char*)arena.allocate(3, 1);
+		double* b = arena.allocateArray<double>(100);
+		MLIB_ASSERT_STR((size_t)b % 16 == 0 && (char*)b >= a + 3, "wrong arena alignment");
+		float* large = arena.allocateArray<float>(10000);
+		large[9999] = 1.0f;
+		const size_t capacity = arena.getCapacity();
+		arena.reset();
+		MLIB_ASSERT_STR(arena.allocate(3, 1) == a && arena.getCapacity() == capacity, "arena blocks are not reused");
+		arena.release();
+		MLIB_ASSERT_STR(arena.getCapacity() == 0, "arena not released");
+
+		//every worker has an arena on its node, also without user storage
+		const ThreadPlacement placements[] = { PLACEMENT_FREE, PLACEMENT_NODE, PLACEMENT_CORE };
+		for (ThreadPlacement placement : placements) {
+			ThreadPool pool(4, placement);
+			MLIB_ASSERT_STR(pool.getPlacement() == placement, "wrong placement");
+			for (UINT thread = 0; thread < pool.getThreadCount(); thread++) {
+				MLIB_ASSERT_STR(pool.getThreadNode(thread) == (placement == PLACEMENT_FREE ? -1 : (int)(thread % topology.getNodeCount())), "wrong node");
+			}
+			TaskList<WorkerThreadTask*> tasks;
+			std::atomic<size_t> numDeleted(0), numWithArena(0);
+			for (size_t i = 0; i < 100; i++) {
+				tasks.insert(new ArenaTask(&numDeleted, &numWithArena));
+			}
+			pool.runTasks(tasks, false);
+			MLIB_ASSERT_STR(numWithArena == 100, "tasks without arena");
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	//benchmark: forward and backward sweeps along x (as in distance field computations) over z slabs of a Grid3, one task per slab.
+	//Free threads sweep the slabs of a grid allocated by the main thread; placed threads sweep their own slab in their arena.
+	void test5()
+	{
+		const UINT numThreads = std::max(1u, std::thread::hardware_concurrency());
+		const size_t dim = 128, slabDepth = 16, numSweeps = 8;
+		const size_t slabSize = dim * dim * slabDepth;
+		Grid3<float> grid(dim, dim, numThreads * slabDepth, [](size_t x, size_t y, size_t z) { return (float)((x * 7 + y * 13 + z * 29) % 100); });
+
+		std::cout << "CPU topology: " << CpuTopology::get().getNodeCount() << " nodes, " << CpuTopology::get().getProcessorCount() << " processors" << std::endl;
+		const ThreadPlacement placements[] = { PLACEMENT_FREE, PLACEMENT_NODE, PLACEMENT_CORE };
+		const char* names[] = { "free threads, shared grid", "node placement, arena slabs", "core placement, arena slabs" };
+		for (size_t p = 0; p < 3; p++) {
+			std::vector<SlabStorage> storage(numThreads);
+			std::vector<ThreadLocalStorage*> storagePointers;
+			for (SlabStorage& s : storage) storagePointers.push_back(&s);
+			ThreadPool pool;
+			pool.init(numThreads, storagePointers, placements[p]);
+
+			//the first round allocates (and first touches) the arena slabs
+			double time = 0.0;
+			for (size_t round = 0; round < 2; round++) {
+				TaskList<WorkerThreadTask*> tasks;
+				for (UINT slab = 0; slab < numThreads; slab++) {
+					tasks.insert(new SweepTask(placements[p] == PLACEMENT_FREE ? grid.getData() + slab * slabSize : nullptr, grid.getData() + slab * slabSize, dim, slabSize, numSweeps));
+				}
+				Timer timer;
+				pool.runTasks(tasks, false);
+				time = timer.getElapsedTimeMS();
+			}
+			std::cout << names[p] << ": " << time << " ms" << std::endl;
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "Multithreading";
+	}
+};
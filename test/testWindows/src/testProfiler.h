@@ -0,0 +1,143 @@
+
+class TestProfiler : public Test
+{
+public:
+	static void leafZone(std::atomic<size_t>& sink)
+	{
+		MLIB_PROFILE_ZONE("leaf");
+		sink++;
+	}
+
+	static void innerZone(std::atomic<size_t>& sink)
+	{
+		MLIB_PROFILE_ZONE("inner");
+		for (int i = 0; i < 3; i++) leafZone(sink);
+	}
+
+	static const ProfilerZoneStatistics* findZone(const std::vector<ProfilerZoneStatistics>& statistics, const std::string& name)
+	{
+		for (const ProfilerZoneStatistics& s : statistics) {
+			if (s.name == name) return &s;
+		}
+		return nullptr;
+	}
+
+	void test0()
+	{
+		Profiler::reset();
+		Profiler::setMaxEventsPerThread(1 << 16);
+		std::atomic<size_t> sink(0);
+
+		//nothing is recorded while disabled
+		Profiler::setEnabled(false);
+		innerZone(sink);
+		MLIB_ASSERT_STR(findZone(Profiler::getZoneStatistics(), "inner") == nullptr, "zone recorded while disabled");
+
+		Profiler::setEnabled(true);
+		{
+			MLIB_PROFILE_ZONE("outer");
+			for (int i = 0; i < 10; i++) innerZone(sink);
+			leafZone(sink);
+		}
+
+		//the same zones on the threads of a pool
+		ThreadPool pool(3);
+		pool.parallelFor(0, 100, 1, [&](size_t) { innerZone(sink); });
+		Profiler::setEnabled(false);
+
+		const std::vector<ProfilerZoneStatistics> statistics = Profiler::getZoneStatistics();
+		const ProfilerZoneStatistics* outer = findZone(statistics, "outer");
+		const ProfilerZoneStatistics* inner = findZone(statistics, "inner");
+		const ProfilerZoneStatistics* leaf = findZone(statistics, "leaf");
+		MLIB_ASSERT_STR(outer && inner && leaf, "zones missing");
+		MLIB_ASSERT_STR(outer->count == 1 && inner->count == 110 && leaf->count == 331, "wrong zone counts");
+		MLIB_ASSERT_STR(leaf->minSeconds <= leaf->getMeanSeconds() && leaf->getMeanSeconds() <= leaf->maxSeconds, "wrong min/mean/max");
+		MLIB_ASSERT_STR(outer->totalSeconds >= inner->totalSeconds * 10.0 / 110.0 * 0.99, "outer zone shorter than the nested ones");
+
+		//call tree of this thread: outer -> inner -> leaf and outer -> leaf
+		const std::string summary = Profiler::getSummary();
+		MLIB_ASSERT_STR(summary.find("\n  inner") != std::string::npos && summary.find("\n    leaf") != std::string::npos && summary.find("\n  leaf") != std::string::npos, "wrong call tree");
+
+		const std::string trace = Profiler::getChromeTrace();
+		size_t numEvents = 0;
+		for (size_t pos = trace.find("\"ph\":\"X\""); pos != std::string::npos; pos = trace.find("\"ph\":\"X\"", pos + 1)) numEvents++;
+		MLIB_ASSERT_STR(numEvents == 1 + 110 + 331, "wrong number of trace events");
+		MLIB_ASSERT_STR(std::count(trace.begin(), trace.end(), '{') == std::count(trace.begin(), trace.end(), '}'), "unbalanced trace");
+
+		Profiler::reset();
+		MLIB_ASSERT_STR(Profiler::getZoneStatistics().empty(), "statistics not reset");
+		Profiler::setMaxEventsPerThread(0);
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	//overhead per zone (enter and leave), disabled and enabled
+	void test1()
+	{
+		const size_t n = 1000000;
+		std::atomic<size_t> sink(0);
+		for (int enabled = 0; enabled < 2; enabled++) {
+			Profiler::setEnabled(enabled == 1);
+			Timer timer;
+			for (size_t i = 0; i < n; i++) leafZone(sink);
+			const double zoneTime = timer.getElapsedTime();
+			timer.start();
+			for (size_t i = 0; i < n; i++) sink++;
+			const double baseTime = timer.getElapsedTime();
+			std::cout << (enabled ? "enabled" : "disabled") << " zone: " << (zoneTime - baseTime) / n * 1e9 << " ns" << std::endl;
+		}
+		Profiler::setEnabled(false);
+		Profiler::reset();
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	//short-lived threads reuse the data of exited ones
+	void test2()
+	{
+		Profiler::reset();
+		std::atomic<size_t> sink(0);
+		Profiler::setEnabled(true);
+		std::thread first([&]() { leafZone(sink); });
+		first.join();
+		const std::string summary = Profiler::getSummary();
+		for (int i = 0; i < 50; i++) {
+			std::thread thread([&]() { leafZone(sink); });
+			thread.join();
+		}
+		Profiler::setEnabled(false);
+
+		const ProfilerZoneStatistics* leaf = findZone(Profiler::getZoneStatistics(), "leaf");
+		MLIB_ASSERT_STR(leaf && leaf->count == 51, "data of exited threads lost");
+		const std::string summaryAfter = Profiler::getSummary();
+		MLIB_ASSERT_STR(std::count(summaryAfter.begin(), summaryAfter.end(), '\n') == std::count(summary.begin(), summary.end(), '\n'), "slots of exited threads not reused");
+		Profiler::reset();
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	//event buffers that end inside a chunk, and their reuse after a reset
+	void test3()
+	{
+		const size_t maxEvents = ProfilerThread::EventChunkSize + 10;
+		ProfilerThread thread(0, maxEvents);
+		for (UINT64 i = 0; i < maxEvents + 10; i++) {
+			thread.enter(0, i);
+			thread.leave(i + 1);
+		}
+		MLIB_ASSERT_STR(thread.getEventCount() == maxEvents && thread.getDroppedEventCount() == 10, "wrong event limit");
+		MLIB_ASSERT_STR(thread.getEvent(maxEvents - 1).beginTicks == maxEvents - 1 && thread.getEvent(ProfilerThread::EventChunkSize).endTicks == ProfilerThread::EventChunkSize + 1, "wrong events");
+
+		thread.reset();
+		thread.enter(0, 100);
+		thread.leave(105);
+		MLIB_ASSERT_STR(thread.getEventCount() == 1 && thread.getDroppedEventCount() == 0 && thread.getEvent(0).beginTicks == 100, "events not reset");
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "Profiler";
+	}
+};
@@ -0,0 +1,135 @@
+
+class TestTSDF : public Test
+{
+public:
+	void test0()
+	{
+		//a sphere seen from six sides is fused and raycast from the first view
+		TSDFVolume volume(vec3ul(96, 96, 96), 0.0125f, vec3f(-0.6f, -0.6f, 1.4f), 0.05f);
+		for (UINT view = 0; view < 6; view++) {
+			const mat4f cameraToWorld = getCameraToWorld(view);
+			ColorImageR8G8B8 color(Width, Height, vec3uc(200, 100, 50));
+			volume.integrate(renderDepth(cameraToWorld), getIntrinsic(), cameraToWorld, &color, getIntrinsic());
+		}
+
+		DepthImage32 depth;
+		PointImage normals;
+		volume.raycast(getIntrinsic(), getCameraToWorld(0), Width, Height, depth, normals);
+		const DepthImage32 expected = renderDepth(getCameraToWorld(0));
+		UINT hits = 0, falseHits = 0;
+		for (UINT y = 0; y < Height; y++) {
+			for (UINT x = 0; x < Width; x++) {
+				if (!depth.isValid(x, y)) continue;
+				if (!expected.isValid(x, y)) {
+					falseHits++;	//at the silhouette, where the truncation band reaches beyond the sphere
+					continue;
+				}
+				hits++;
+				MLIB_ASSERT_STR(std::abs(depth(x, y) - expected(x, y)) < 1.5f * volume.getVoxelSize(), "wrong raycast depth");
+
+				//the outward normal of the sphere in camera space (camera 0 is at the world origin); grazing views are left out, and
+				//projective distances of the other views at 45 to 90 degrees tilt the fused surface slightly
+				const vec3f p = vec3f(((float)x - Cx) / F, ((float)y - Cy) / F, 1.0f) * expected(x, y);
+				const vec3f n = (p - SphereCenter).getNormalized();
+				MLIB_ASSERT_STR(n.z > -0.5f || (normals(x, y) | n) > 0.85f, "wrong raycast normal");
+			}
+		}
+		const UINT expectedHits = expected.getNumPixelsNotEqualTo(expected.getInvalidValue());
+		MLIB_ASSERT_STR(hits > 0.9f * expectedHits && falseHits < 0.05f * expectedHits, "wrong surface hits");
+
+		const vec3ul center = math::round((SphereCenter - volume.getOrigin()) / volume.getVoxelSize());
+		MLIB_ASSERT_STR(volume.getWeights()(center + vec3ul(40, 0, 0)) > 0.0f && volume.getTSDF()(center.x + 40, center.y, center.z) == volume.getTruncation(), "free space not observed");
+		const vec3ul surface = math::round((SphereCenter - vec3f(SphereRadius, 0.0f, 0.0f) - volume.getOrigin()) / volume.getVoxelSize());
+		MLIB_ASSERT_STR(volume.getColors()(surface) == vec3uc(200, 100, 50), "wrong surface color");
+
+		const TriMeshf mesh = volume.extractMesh();
+		MLIB_ASSERT_STR(mesh.getVertices().size() > 1000 && mesh.hasColors(), "no mesh extracted");
+		for (const TriMeshf::Vertex& v : mesh.getVertices()) {
+			MLIB_ASSERT_STR(std::abs((v.position - SphereCenter).length() - SphereRadius) < 1.5f * volume.getVoxelSize(), "mesh vertex not on the sphere");
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	void test1()
+	{
+		//fusing SensorData frames gives the same volume as fusing the (millimeter quantized) images
+		SensorData sensorData;
+		sensorData.initDefault(Width, Height, Width, Height, SensorData::CalibrationData(getIntrinsic()), SensorData::CalibrationData(getIntrinsic()),
+			SensorData::TYPE_RAW, SensorData::TYPE_RAW_USHORT, 1000.0f);
+		TSDFVolume reference(vec3ul(48, 48, 48), 0.025f, vec3f(-0.6f, -0.6f, 1.4f), 0.1f, false);
+		for (UINT view = 0; view < 4; view++) {
+			const mat4f cameraToWorld = getCameraToWorld(view);
+			DepthImage32 depth = renderDepth(cameraToWorld);
+			std::vector<unsigned short> depthShort(Width * Height);
+			std::vector<vec3uc> color(Width * Height, vec3uc(0, 0, 0));
+			for (UINT i = 0; i < Width * Height; i++) {
+				float& d = depth.getData()[i];
+				if (!depth.isValidValue(d)) continue;
+				depthShort[i] = (unsigned short)math::round(d * 1000.0f);
+				d = (float)depthShort[i] / 1000.0f;
+			}
+			sensorData.addFrame(color.data(), depthShort.data(), cameraToWorld);
+			reference.integrate(depth, getIntrinsic(), cameraToWorld);
+		}
+
+		TSDFVolume volume(vec3ul(48, 48, 48), 0.025f, vec3f(-0.6f, -0.6f, 1.4f), 0.1f, false);
+		volume.integrate(sensorData);
+		for (size_t i = 0; i < volume.getTSDF().getNumElements(); i++) {
+			MLIB_ASSERT_STR(volume.getWeights().getData()[i] == reference.getWeights().getData()[i], "wrong sensor data weights");
+			MLIB_ASSERT_STR(volume.getTSDF().getData()[i] == reference.getTSDF().getData()[i], "wrong sensor data distances");
+		}
+
+		std::cout << __FUNCTION__ << " passed" << std::endl;
+	}
+
+	std::string getName()
+	{
+		return "tsdf";
+	}
+
+private:
+	static const UINT Width = 80;
+	static const UINT Height = 60;
+	static const float F;
+	static const float Cx;
+	static const float Cy;
+	static const float SphereRadius;
+	static const vec3f SphereCenter;
+
+	static mat4f getIntrinsic()
+	{
+		return SensorData::CalibrationData::makeIntrinsicMatrix(F, F, Cx, Cy);
+	}
+
+	//! cameras around the sphere (four on a horizontal circle, one above and one below), looking at its center
+	static mat4f getCameraToWorld(UINT view)
+	{
+		const mat4f rotation = view < 4 ? mat4f::rotationY(90.0f * view) : mat4f::rotationX(view == 4 ? 90.0f : -90.0f);
+		return mat4f::translation(SphereCenter) * rotation * mat4f::translation(-SphereCenter);
+	}
+
+	//! ray traced depth of the sphere (invalid where it is missed)
+	static DepthImage32 renderDepth(const mat4f& cameraToWorld)
+	{
+		DepthImage32 depth(Width, Height);
+		const vec3f eye = cameraToWorld.getTranslation();
+		for (UINT y = 0; y < Height; y++) {
+			for (UINT x = 0; x < Width; x++) {
+				//depth t along dir (camera space z = 1): |eye + t * dir - center|^2 = r^2
+				const vec3f dir = cameraToWorld.getMatrix3x3() * vec3f(((float)x - Cx) / F, ((float)y - Cy) / F, 1.0f);
+				const vec3f o = eye - SphereCenter;
+				const float a = dir | dir, b = 2.0f * (o | dir), c = (o | o) - SphereRadius * SphereRadius;
+				const float discriminant = b * b - 4.0f * a * c;
+				depth(x, y) = discriminant >= 0.0f ? (-b - std::sqrt(discriminant)) / (2.0f * a) : depth.getInvalidValue();
+			}
+		}
+		return depth;
+	}
+};
+
+const float TestTSDF::F = 70.0f;
+const float TestTSDF::Cx = 39.5f;
+const float TestTSDF::Cy = 29.5f;
+const float TestTSDF::SphereRadius = 0.4f;
+const vec3f TestTSDF::SphereCenter(0.0f, 0.0f, 2.0f);